@@ -6,367 +6,76 @@
  */
 
 #include <stdio.h>
-#include <limits.h>
-#include <stdint.h>
 #include <stdlib.h>
-#include <time.h>
+#include <string.h>
 #include <stdbool.h>
-
-/*
- * Define structures
- */
-
-// Represents a transaction
-struct Transaction {
-    int *items;
-    int numItems;
-};
-
-// Represents an itemset
-struct Itemset {
-    uint32_t *items;
-    uint32_t support;
-    size_t size;
-};
-
-// Represents a collection of frequent itemsets of a certain size.
-struct FrequentItemset {
-    size_t size;
-    size_t numberOfItemsets;
-    struct Itemset *itemsets;
-};
-
-// Represents an internal or external node of a hash tree.
-struct Node {
-    bool isLeaf;
-    struct Node **hashtable;
-    struct Itemset **itemsets;
-    size_t numItemsets;
-    struct Node *nextLeaf;
-    struct Node *prevLeaf;
+#include <getopt.h>
+#include "libapriori.h"
+#include "stats.h"
+#include "writer.h"
+
+// The values of the options that only have a long name.
+enum LongOption {
+    OPTION_ITEM_ORDER = 256,
+    OPTION_HYBRID,
+    OPTION_FANOUT,
+    OPTION_LEAF_SIZE,
+    OPTION_MEMORY_BUDGET,
+    OPTION_STATS,
+    OPTION_STREAM,
+    OPTION_PARTITIONS,
+    OPTION_PARTITION_DIR,
+    OPTION_SAVE_STATE,
+    OPTION_UPDATE,
+    OPTION_HISTORY,
+    OPTION_FORMAT,
+    OPTION_ITEMSETS,
+    OPTION_TOP_RULES,
+    OPTION_RANK,
+    OPTION_SAMPLE,
+    OPTION_APPROXIMATE,
+    OPTION_SEED
 };
 
-// Represents a hash tree data structure.
-struct HashTree {
-    struct Node *root;
-    struct Node *firstLeaf;
-    size_t maxListSize;
-};
-
-/*
- * Define helper functions that are used by the algorithm
- */
-
-/**
- * Creates a hash tree for use with the Apriori algorithm.
- * The internal nodes will have hash tables that are the given size.
- * @param size - The size of the hash tables to create in the internal nodes.
- * @return a pointer to a hash tree of the given size.
- */
-struct HashTree *createHashTree(size_t size) {
-    struct Node *rootNode = malloc(sizeof(struct Node));
-    rootNode->isLeaf = true;
-    rootNode->hashtable = NULL;
-    rootNode->itemsets = calloc(size, sizeof(struct Itemset *));
-    rootNode->numItemsets = 0;
-    rootNode->nextLeaf = NULL;
-    rootNode->prevLeaf = NULL;
-    struct HashTree *tree = malloc(sizeof(struct HashTree));
-    tree->root = rootNode;
-    tree->firstLeaf = rootNode;
-    tree->maxListSize = size;
-    return tree;
-}
-
-/**
- * Inserts an itemset into the given hash tree.
- * @param tree - The hash tree to intern the itemset into.
- * @param node - The current node of the hash tree (call with root at the start).
- * @param d  - The current depth of the call to insert in the hash tree (call with 1 at the start).
- * @param itemset - The itemset to insert.
- */
-void insert(struct HashTree *tree, struct Node *node, uint32_t d, struct Itemset *itemset) {
-    if (node->isLeaf) {
-        // If the current node has less itemsets than the maximum, insert the itemset.
-        if (node->numItemsets < tree->maxListSize) {
-            node->itemsets[node->numItemsets] = itemset;
-            node->numItemsets += 1;
-        } else {
-            // Otherwise we split interior node
-            node->isLeaf = false;
-            node->hashtable = calloc(tree->maxListSize, sizeof(struct Node *));
-            // Initialize the children nodes
-            struct Node *prevNode = node->prevLeaf;
-            for (int i = 0; i < tree->maxListSize; i++) {
-                struct Node *currNode = malloc(sizeof(struct Node));;
-                node->hashtable[i] = currNode;
-                currNode->numItemsets = 0;
-                currNode->hashtable = NULL;
-                currNode->isLeaf = true;
-                currNode->nextLeaf = NULL;
-                currNode->itemsets = calloc(tree->maxListSize, sizeof(struct Itemset *));
-                currNode->prevLeaf = prevNode;
-                if (prevNode != NULL) {
-                    prevNode->nextLeaf = currNode;
-                } else {
-                    tree->firstLeaf = currNode;
-                }
-                prevNode = currNode;
-            }
-            prevNode->nextLeaf = node->nextLeaf;
-            if (prevNode->nextLeaf != NULL) {
-                prevNode->nextLeaf->prevLeaf = prevNode;
-            }
-
-            // Insert the itemsets from the current node into the lists of the children.
-            for (int i = 0; i < node->numItemsets; i++) {
-                insert(tree, node->hashtable[node->itemsets[i]->items[d - 1]], d + 1, node->itemsets[i]);
-            }
-            insert(tree, node->hashtable[itemset->items[d - 1]], d + 1, itemset);
-            node->itemsets = NULL;
-            node->nextLeaf = NULL;
-            node->numItemsets = 0;
-        }
-    } else {
-        insert(tree, node->hashtable[itemset->items[d - 1]], d + 1, itemset);
-    }
-}
-
-/**
- * Counts the number occurences of the itemsets contained in the given transaction.
- * @param tree - The hash tree storing the itemsets.
- * @param node - The current node of the count (call with root at the start).
- * @param transaction - The transaction to count.
- * @param i - The index of the current item in the transaction.
- * @param k - The size of the itemsets to be counted.
- * @param d - The current depth in the hash tree (call with 1 at the start).
- */
-void count(struct HashTree *tree, struct Node *node, struct Transaction *transaction, int i, size_t k, int d) {
-    if (node->isLeaf) {
-        // For each candidate itemset in the node.
-        for (int c = 0; c < node->numItemsets; c++) {
-            if (node->itemsets != NULL) {
-                int j = d - 1;
-                int u = i;
-                // Compare the current itemset to the transaction.
-                while (j < k && u < transaction->numItems) {
-                    if (node->itemsets[c]->items[j] == transaction->items[u]) {
-                        j++;
-                    }
-                    u++;
-                }
-                // If a match was found, increment its support.
-                if (j == k) {
-                    node->itemsets[c]->support += 1;
-                }
-            }
-        }
-    } else {
-        // Recursively call count on subsets of the current transaction at the next level of the hash tree.
-        while (i <= transaction->numItems - k) {
-            count(tree, node->hashtable[transaction->items[i]], transaction, i + 1, k, d + 1);
-            i++;
-        }
-    }
-}
-
-/**
- * Gets the support for the given itemset.
- * @param tree - The hash tree containing the itemsets and support counts.
- * @param node - The current node of the tree.
- * @param itemset - The itemset to get the support for.
- * @param d - The current depth of the tree.
- * @param k - The size of the itemset.
- * @return The support count for the given item.
- */
-uint32_t getSupport(struct HashTree *tree, struct Node *node, struct Itemset *itemset, int d, size_t k) {
-    // If the node is a leaf...
-    if (node->numItemsets > 0) {
-        // For each candidate itemset in the node.
-        for (int c = 0; c < node->numItemsets; c++) {
-            if (node->itemsets != NULL) {
-                int j = d - 1;
-                // Compare the candidate itemsets to the given itemset.
-                while (j < itemset->size) {
-                    if (node->itemsets[c]->items[j] == itemset->items[j]) {
-                        j++;
-                    } else {
-                        break;
-                    }
-                }
-                // If a match was found.
-                if (j == k) {
-                    return node->itemsets[c]->support;
-                }
-            }
-        }
-        return 0; // The itemset was not found.
-    } else {
-        // Otherwise, hash to the next level.
-        if (node->hashtable != NULL) {
-            return getSupport(tree, node->hashtable[itemset->items[d - 1]], itemset, d + 1, k);
-        } else {
-            return 0; // The itemset was not found.
-        }
-    }
-}
-
-/**
- * Generates the strong association rules from the given itemset with the given confidence.
- * @param C - The hash trees containing the support counts for itemsets of size k > 1
- * @param C1 - The array containing the support counts for itemset of size k = 1
- * @param itemset - The itemset for which to generate rules.
- * @param minConfidence - The minimum confidence of the generated rules.
- * @param numTransactions - The total number of transactions in the dataset.
- * @param print - true if the generated rules should be printed to the screen, false otherwise.
- * @return The number of strong rules generated.
- */
-uint32_t generateStrongRules(struct HashTree **C, struct Itemset *C1, struct Itemset *itemset, double minConfidence,
-                             size_t numTransactions, bool print) {
-    uint32_t numRules = 0;
-    size_t numSubsets = (size_t) ((1 << itemset->size) - 1); // The number of possible subsets of the given itemset.
-    struct Itemset *antecedent;
-    struct Itemset *consequence;
-
-    // For each of the subsets...
-    for (uint32_t i = 1; i < numSubsets; i++) {
-        antecedent = malloc(sizeof(struct Itemset));
-        consequence = malloc(sizeof(struct Itemset));
-        antecedent->items = calloc(itemset->size, sizeof(uint32_t));
-        consequence->items = calloc(itemset->size, sizeof(uint32_t));
-        antecedent->size = 0;
-        consequence->size = 0;
-        uint32_t a = i;
-        uint32_t k = 0;
-
-        // Generate potential antecedents and consequences.
-        while (k < itemset->size) {
-            if (a & 1) {
-                antecedent->items[antecedent->size] = itemset->items[k];
-                antecedent->size++;
-            } else {
-                consequence->items[consequence->size] = itemset->items[k];
-                consequence->size++;
-            }
-            a = a >> 1;
-            k++;
-        }
-
-        // Get the confidence of the generated rule.
-        double confidence;
-        if (antecedent->size == 1) {
-            confidence = (double) getSupport(C[itemset->size], C[itemset->size]->root, itemset, 1, itemset->size)
-                         / (double) C1[antecedent->items[0]].support;
-        } else {
-            confidence = (double) getSupport(C[itemset->size], C[itemset->size]->root, itemset, 1, itemset->size)
-                         / (double) getSupport(C[antecedent->size], C[antecedent->size]->root, antecedent, 1,
-                                               antecedent->size);
-        }
-
-        if (confidence >= minConfidence) {
-            numRules++;
-            if (print) {
-                // Print the rule, along with its support and confidence.
-                int n;
-                for (n = 0; n < antecedent->size - 1; n++) {
-                    printf("%d, ", antecedent->items[n]);
-                }
-                printf("%d ", antecedent->items[n]);
-                printf("-> ");
-                for (n = 0; n < consequence->size - 1; n++) {
-                    printf("%d, ", consequence->items[n]);
-                }
-                printf("%d ", consequence->items[n]);
-                printf("(%.2lf,%.2lf)\n", (double) itemset->support / (double) numTransactions, confidence);
-            }
-        }
-    }
-    return numRules;
-}
-
 /*
  * Define some functions to handle printing
  */
 
-/**
- * Prints the given list of frequent itemsets.
- * @param frequentItemsets - The list of frequent itemsets.
- * @param numTransactions - The total number of transaction in the dataset (for computing the percentage support).
- */
-void printFrequentItemsets(struct FrequentItemset *frequentItemsets, size_t numTransactions) {
-    int k = 0;
-    while (frequentItemsets[k].numberOfItemsets > 0) {
-        for (int i = 0; i < frequentItemsets[k].numberOfItemsets; i++) {
-            for (int j = 0; j <= k; j++) {
-                printf("%d", frequentItemsets[k].itemsets[i].items[j]);
-                if (j < k) {
-                    printf(" ");
-                }
-            }
-            printf(" (%.2lf)\n", (double) frequentItemsets[k].itemsets[i].support / (double) numTransactions);
-//            Uncomment  the following line to print the absolute support, instead of a percentage.
-//            printf(" (%d)\n", frequentItemsets[k].itemsets[i].support);
-        }
-        k++;
-    }
-}
-
 /**
  * Prints the counts for the number of frequent k_itemsets.
- * @param frequentItemsets - The list of freqent itemsents.
+ * @param result - The frequent itemsets.
  */
-void printFrequentItemsetCounts(struct FrequentItemset *frequentItemsets) {
-    int k = 0;
-    if (frequentItemsets[0].numberOfItemsets == 0) {
+void printFrequentItemsetCounts(const struct AprioriResult *result) {
+    if (aprioriMaxItemsetSize(result) == 0) {
         printf("There are no frequent itemsets with the given support.\n");
     }
-    int count = 0;
-    while (frequentItemsets[k].numberOfItemsets > 0) {
-        count += frequentItemsets[k].numberOfItemsets;
-        printf("Number of frequent %d_itemsets: %zu\n", k + 1, frequentItemsets[k].numberOfItemsets);
-        k++;
-    }
-}
-
-/**
- * Prints the list of strong association rules for the given list of freqent itemsests.
- * @param frequentItemsets - The list of frequent itemsets.
- * @param C - The hash trees containing the support counts for itemsets of size k > 1
- * @param C1 - The array containing the support counts for itemset of size k = 1
- * @param minConfidence - The minimum confidence level.
- * @param numTransactions - The total number of transaction in the database.
- */
-void printStrongAssociationRules(struct FrequentItemset *frequentItemsets, struct HashTree **C, struct Itemset *C1,
-                                 double minConfidence, size_t numTransactions) {
-    int k = 1;
-    while (frequentItemsets[k].numberOfItemsets > 0) {
-        for (int i = 0; i < frequentItemsets[k].numberOfItemsets; i++) {
-            generateStrongRules(C, C1, &frequentItemsets[k].itemsets[i], minConfidence, numTransactions, true);
+    // Closed and maximal runs may find no itemset of some sizes below the largest.
+    for (size_t k = 1; k <= aprioriMaxItemsetSize(result); k++) {
+        if (aprioriNumItemsets(result, k) > 0) {
+            printf("Number of frequent %zu_itemsets: %zu\n", k, aprioriNumItemsets(result, k));
         }
-        k++;
     }
 }
 
 /**
- * Prints the total number of strong association rules for the given list of frequent itemsests.
- * @param frequentItemsets - The list of frequent itemsets.
- * @param C - The hash trees containing the support counts for itemsets of size k > 1
- * @param C1 - The array containing the support counts for itemset of size k = 1
- * @param minConfidence - The minimum confidence level.
- * @param numTransactions - The total number of transaction in the database.
+ * Parses the value of a size option.
+ * @param text - The value of the option.
+ * @param allowAuto - true if the value may be 'auto'.
+ * @param value - Set to the size, or to 0 for 'auto'.
+ * @return true if the value is a positive number, or 'auto' when allowed.
  */
-void printStrongAssociationRuleCount(struct FrequentItemset *frequentItemsets, struct HashTree **C, struct Itemset *C1,
-                                     double minConfidence, size_t numTransactions) {
-    int k = 1;
-    uint32_t ruleCount = 0;
-    while (frequentItemsets[k].numberOfItemsets > 0) {
-        for (int i = 0; i < frequentItemsets[k].numberOfItemsets; i++) {
-            ruleCount += generateStrongRules(C, C1, &frequentItemsets[k].itemsets[i], minConfidence, numTransactions,
-                                             false);
-        }
-        k++;
+bool parseSize(const char *text, bool allowAuto, size_t *value) {
+    if (allowAuto && strcmp(text, "auto") == 0) {
+        *value = 0;
+        return true;
+    }
+    char *end;
+    long number = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || number < 1) {
+        return false;
     }
-    printf("Number of association rules: %d\n", ruleCount);
+    *value = (size_t) number;
+    return true;
 }
 
 /*
@@ -384,13 +93,272 @@ void printStrongAssociationRuleCount(struct FrequentItemset *frequentItemsets, s
  * 'a' prints all the frequent itemsets and strong association rules; when this option is absent only the number of
  * frequent itemsets of different sizes and the number of strong rules are displayed.
  *
+ * The arguments may be preceded by the following options:
+ *   -j N, --threads=N   count the support of the candidate itemsets and generate the rules with N threads
+ *                       (default 1).
+ *   -e NAME, --engine=NAME
+ *                       the algorithm used to find the frequent itemsets: 'hashtree' (default) counts candidates with
+ *                       a hash tree, 'trie' counts them with a prefix trie walked once per transaction for every
+ *                       shared prefix, 'bitset' intersects vertical transaction id bitsets and 'fpgrowth' grows the
+ *                       itemsets from an FP-tree without generating candidates.
+ *   -v, --verbose       print the time taken by the loading of the transactions and the number of item occurrences
+ *                       kept after the infrequent items are dropped to the standard error.
+ *   --item-order=ORDER  the order of the codes the frequent items are renumbered with after the first pass: 'id'
+ *                       (default) keeps the order of the item numbers, 'frequency' numbers them from the least to the
+ *                       most frequent, which may shrink the candidate sets. The itemsets and rules are printed in
+ *                       increasing item numbers either way.
+ *   --fanout=N          the number of children of the internal nodes of the hash trees; the items are hashed modulo
+ *                       N. The default, 'auto', picks it for every level from the number of candidates.
+ *   --leaf-size=N       the number of candidates a leaf of the hash trees holds before it is split; 'auto'
+ *                       (default) starts from 16 and grows it to fit the memory budget.
+ *   --memory-budget=MB  the memory the hash tree of one level should fit in when its shape is picked (default 256).
+ *   --hybrid            with the hash tree and trie engines, count the candidates of the late levels as in AprioriTid,
+ *                       from the lists of the frequent itemsets each transaction contains, once these lists are
+ *                       smaller than the transactions themselves.
+ *   --stream            do not load the transactions in memory: the file is read again in every pass, by a thread that
+ *                       decodes it ahead of the counting, so the memory used depends on the candidates only. Only
+ *                       with the hash tree and trie engines; the transactions are then not reduced between passes.
+ *   --partitions=N      split the transactions into N partitions mined with the selected engine by worker processes,
+ *                       at most as many at a time as threads, then count the union of their locally frequent itemsets
+ *                       in a single pass (Savasere et al., 1995). Every partition must keep a local minimum support
+ *                       of at least 2, which bounds N; 'auto' picks N from the size of the transactions and the memory
+ *                       budget, and the number of threads, within that bound. Not with --stream.
+ *   --partition-dir=DIR where to create the private directory the workers hand their itemsets over in (default
+ *                       /tmp).
+ *   --save-state=FILE   write the supports of the frequent itemsets and of their negative border to FILE, to mine
+ *                       transactions appended later incrementally. Only with the hash tree and trie engines.
+ *   --update=FILE       read the state written by --save-state, and mine the old transactions and the ones in the
+ *                       file given as argument, which are the only ones appended since (Cheung et al., 1996).
+ *   --history=FILE      the old transactions of the state, read only if some candidates missing from the state
+ *                       have to be counted in them; required by --update.
+ *   -o FILE, --output=FILE
+ *                       write the itemsets and rules to FILE instead of the standard output. Only with 'f', 'r'
+ *                       or 'a', as are the other formats below: the counts are refused.
+ *   --format=FORMAT     the format of the itemsets and rules: 'text' (default) is the one described above, 'csv' and
+ *                       'tsv' write one record per line under a header (kind, items, consequence, count, support,
+ *                       confidence), and 'binary' writes a header followed by a fixed record per itemset or rule, each
+ *                       followed by its items (see writer.c).
+ *   --itemsets=KIND     the frequent itemsets to find: 'all' (default), 'closed', those none of whose supersets has
+ *                       the same support, from which the support of every frequent itemset follows, or 'maximal',
+ *                       those none of whose supersets is frequent. With 'closed', the rules are only generated between
+ *                       closed itemsets, a basis the other strong rules can be derived from. Only with the FP-Growth
+ *                       engine, without --stream, --partitions or incremental mining.
+ *   --top-rules=K       only keep the K best strong rules, and print them best first. The rules found so far bound the
+ *                       ones worth generating; ranked by support, they also raise the minimum support of the next
+ *                       levels of the hash tree and trie engines, so a low minimum support can be given without
+ *                       tuning it. The frequent itemsets are then neither counted nor printed: 'f' and 'a' are
+ *                       refused.
+ *   --rank=MEASURE      the measure the best rules are ranked by: 'confidence' (default), 'lift' or 'support'.
+ *   --sample=FRACTION   mine a random sample of FRACTION of the transactions at a lowered minimum support, then count
+ *                       the itemsets found and their negative border in one pass over all of them (Toivonen, 1996).
+ *                       The results are exact: if a border itemset turns out frequent, the missed levels are completed
+ *                       with further passes. Not with --stream, --partitions, --itemsets or incremental mining.
+ *   --approximate       with --sample, skip the pass over all the transactions: the itemsets frequent in the sample,
+ *                       at the minimum support, are printed with their supports in it and the margins of error of
+ *                       those, at a confidence of 95% (the CSV and TSV formats gain a margin column).
+ *   --seed=N            the seed of the random sample (default 1).
+ *   --stats[=FILE]      write statistics of the run as a JSON document to FILE, or to the standard error: the wall
+ *                       and CPU time of every phase, and for every level the candidates generated and pruned, the
+ *                       shape of the hash tree, the nodes visited and items compared while counting, the number of
+ *                       frequent itemsets, the time of every step and the bytes allocated.
+ *
  * @param argc - The number of arguments.
  * @param argv - 1: the file containing the transactions, 2: the minimum support,
  *                  3: the minimum confidence, 4: optional modifier ('r', 'f', or 'a')
  * @return 0 if exits successfully, 1 otherwise.
  */
 int main(int argc, char *argv[]) {
-    clock_t time1 = clock();
+    struct AprioriOptions options;
+    aprioriInitOptions(&options);
+    bool writeStatistics = false;
+    const char *statsFileName = NULL;
+    struct Stats stats = {0};
+    struct Stopwatch stopwatch;
+    const char *outputFileName = NULL;
+    enum OutputFormat format = OUTPUT_TEXT;
+    bool formatGiven = false;
+
+    static struct option longOptions[] = {
+            {"threads", required_argument, NULL, 'j'},
+            {"engine",  required_argument, NULL, 'e'},
+            {"verbose", no_argument,       NULL, 'v'},
+            {"item-order", required_argument, NULL, OPTION_ITEM_ORDER},
+            {"hybrid",  no_argument,       NULL, OPTION_HYBRID},
+            {"fanout",  required_argument, NULL, OPTION_FANOUT},
+            {"leaf-size", required_argument, NULL, OPTION_LEAF_SIZE},
+            {"memory-budget", required_argument, NULL, OPTION_MEMORY_BUDGET},
+            {"stats",   optional_argument, NULL, OPTION_STATS},
+            {"stream",  no_argument,       NULL, OPTION_STREAM},
+            {"partitions", required_argument, NULL, OPTION_PARTITIONS},
+            {"partition-dir", required_argument, NULL, OPTION_PARTITION_DIR},
+            {"save-state", required_argument, NULL, OPTION_SAVE_STATE},
+            {"update",  required_argument, NULL, OPTION_UPDATE},
+            {"history", required_argument, NULL, OPTION_HISTORY},
+            {"output",  required_argument, NULL, 'o'},
+            {"format",  required_argument, NULL, OPTION_FORMAT},
+            {"itemsets", required_argument, NULL, OPTION_ITEMSETS},
+            {"top-rules", required_argument, NULL, OPTION_TOP_RULES},
+            {"rank",    required_argument, NULL, OPTION_RANK},
+            {"sample",  required_argument, NULL, OPTION_SAMPLE},
+            {"approximate", no_argument,   NULL, OPTION_APPROXIMATE},
+            {"seed",    required_argument, NULL, OPTION_SEED},
+            {NULL, 0, NULL, 0}
+    };
+    int option;
+    while ((option = getopt_long(argc, argv, "j:e:vo:", longOptions, NULL)) != -1) {
+        switch (option) {
+            case 'j':
+                options.numThreads = atoi(optarg);
+                if (options.numThreads < 1) {
+                    printf("The number of threads must be at least 1.");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'e':
+                if (strcmp(optarg, "hashtree") == 0) {
+                    options.engine = APRIORI_ENGINE_HASH_TREE;
+                } else if (strcmp(optarg, "bitset") == 0) {
+                    options.engine = APRIORI_ENGINE_BITSET;
+                } else if (strcmp(optarg, "fpgrowth") == 0) {
+                    options.engine = APRIORI_ENGINE_FP_GROWTH;
+                } else if (strcmp(optarg, "trie") == 0) {
+                    options.engine = APRIORI_ENGINE_TRIE;
+                } else {
+                    printf("Unrecognized engine: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'v':
+                options.verbose = true;
+                break;
+            case 'o':
+                outputFileName = optarg;
+                break;
+            case OPTION_FORMAT:
+                formatGiven = true;
+                if (strcmp(optarg, "text") == 0) {
+                    format = OUTPUT_TEXT;
+                } else if (strcmp(optarg, "csv") == 0) {
+                    format = OUTPUT_CSV;
+                } else if (strcmp(optarg, "tsv") == 0) {
+                    format = OUTPUT_TSV;
+                } else if (strcmp(optarg, "binary") == 0) {
+                    format = OUTPUT_BINARY;
+                } else {
+                    printf("Unrecognized format: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case OPTION_ITEMSETS:
+                if (strcmp(optarg, "all") == 0) {
+                    options.filter = APRIORI_ITEMSETS_ALL;
+                } else if (strcmp(optarg, "closed") == 0) {
+                    options.filter = APRIORI_ITEMSETS_CLOSED;
+                } else if (strcmp(optarg, "maximal") == 0) {
+                    options.filter = APRIORI_ITEMSETS_MAXIMAL;
+                } else {
+                    printf("Unrecognized itemsets: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case OPTION_TOP_RULES:
+                if (!parseSize(optarg, false, &options.topRules)) {
+                    printf("The number of rules must be at least 1.");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case OPTION_RANK:
+                if (strcmp(optarg, "confidence") == 0) {
+                    options.ranking = APRIORI_RANK_CONFIDENCE;
+                } else if (strcmp(optarg, "lift") == 0) {
+                    options.ranking = APRIORI_RANK_LIFT;
+                } else if (strcmp(optarg, "support") == 0) {
+                    options.ranking = APRIORI_RANK_SUPPORT;
+                } else {
+                    printf("Unrecognized ranking: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case OPTION_SAMPLE:
+                options.sampleFraction = strtod(optarg, NULL);
+                if (options.sampleFraction <= 0 || options.sampleFraction > 1) {
+                    printf("The sample must be a fraction of the transactions between 0 and 1.");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case OPTION_APPROXIMATE:
+                options.approximate = true;
+                break;
+            case OPTION_SEED:
+                options.seed = strtoull(optarg, NULL, 10);
+                break;
+            case OPTION_HYBRID:
+                options.hybrid = true;
+                break;
+            case OPTION_FANOUT:
+                if (!parseSize(optarg, true, &options.fanout) || options.fanout == 1) {
+                    printf("The fanout must be 'auto' or at least 2.");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case OPTION_LEAF_SIZE:
+                if (!parseSize(optarg, true, &options.leafSize)) {
+                    printf("The leaf size must be 'auto' or at least 1.");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case OPTION_MEMORY_BUDGET:
+                if (!parseSize(optarg, false, &options.memoryBudget)) {
+                    printf("The memory budget must be a number of megabytes.");
+                    return EXIT_FAILURE;
+                }
+                options.memoryBudget <<= 20;
+                break;
+            case OPTION_STREAM:
+                options.stream = true;
+                break;
+            case OPTION_PARTITIONS:
+                if (strcmp(optarg, "auto") == 0) {
+                    options.numPartitions = APRIORI_AUTO_PARTITIONS;
+                } else if (!parseSize(optarg, false, &options.numPartitions)) {
+                    printf("The number of partitions must be 'auto' or at least 1.");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case OPTION_PARTITION_DIR:
+                options.partitionDirectory = optarg;
+                break;
+            case OPTION_SAVE_STATE:
+                options.saveStateFileName = optarg;
+                break;
+            case OPTION_UPDATE:
+                options.updateFileName = optarg;
+                break;
+            case OPTION_HISTORY:
+                options.historyFileName = optarg;
+                break;
+            case OPTION_STATS:
+                writeStatistics = true;
+                statsFileName = optarg;
+                break;
+            case OPTION_ITEM_ORDER:
+                if (strcmp(optarg, "id") == 0) {
+                    options.itemOrder = APRIORI_ITEM_ORDER_ID;
+                } else if (strcmp(optarg, "frequency") == 0) {
+                    options.itemOrder = APRIORI_ITEM_ORDER_FREQUENCY;
+                } else {
+                    printf("Unrecognized item order: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            default:
+                return EXIT_FAILURE;
+        }
+    }
+    // Only the positional arguments remain.
+    argc -= optind - 1;
+    argv += optind - 1;
+
     if (argc < 4) {
         printf("Not enough arguments.");
         return EXIT_FAILURE;
@@ -398,216 +366,63 @@ int main(int argc, char *argv[]) {
         printf("Too many arguments.");
         return EXIT_FAILURE;
     } else {
-        FILE *fp;
-        double support = strtod(argv[2], NULL);
-        double confidence = strtod(argv[3], NULL);
-
-
-        // Try and open the file.
-        fp = fopen(argv[1], "r");
-        // Check if file was found
-        if (fp == NULL) {
-            printf("File '%s' was not found.", argv[1]);
+        options.minSupport = strtod(argv[2], NULL);
+        options.minConfidence = strtod(argv[3], NULL);
+        options.stats = writeStatistics ? &stats : NULL;
+        if (options.topRules > 0 && argc == 5 && (*argv[4] == 'f' || *argv[4] == 'a')) {
+            printf("The frequent itemsets cannot be printed with --top-rules, which only searches the itemsets that "
+                   "may yield one of the best rules.");
             return EXIT_FAILURE;
         }
-
-        size_t maxItemNumber = 0; // The maximum item number read from the file.
-        int number; // The current number being read in the transaction.
-        char inputBuffer[255];
-        size_t numTransactions = 0;
-        size_t maxItemsOnLine = 0;
-        size_t numItemsOnLine = 0;
-
-        // Read the input file to count the number of transactions, determine the max number of items per tranactions
-        // and the maximum item number.
-        while (fgets(inputBuffer, 255, fp) != NULL) {
-            numTransactions += 1;
-            char *p = inputBuffer;
-            while (sscanf(p, "%d", &number) == 1) {
-                numItemsOnLine += 1;
-                if (number >= 100) {
-                    p += 4;
-                } else if (number >= 10) {
-                    p += 3;
-                } else {
-                    p += 2;
-                }
-                if (number > maxItemNumber) {
-                    maxItemNumber = (size_t) number;
-                }
-            }
-            if (numItemsOnLine > maxItemsOnLine) {
-                maxItemsOnLine = numItemsOnLine;
-            }
-            numItemsOnLine = 0;
-        }
-
-        // Initialize an array to hold the candidate itemsets of size 1.
-        struct Itemset *C1 = calloc(maxItemNumber + 1, sizeof(struct Itemset));
-
-        // Initialize the frequent itemset list.
-        struct FrequentItemset *frequentItemsets = calloc(maxItemsOnLine, sizeof(struct FrequentItemset));
-
-        // Initialize C1
-        for (uint32_t i = 0; i <= maxItemNumber; i++) {
-            C1[i].items = calloc(1, sizeof(uint32_t));
-            C1[i].items[0] = i;
-            C1[i].support = 0;
-        }
-
-        // Turn the support percentage into an integer value
-        int minSupport = (int) (support * numTransactions + 0.5);
-
-        // Initialize the array to hold the transactions.
-        struct Transaction *transactions = calloc(numTransactions, sizeof(struct Transaction));
-        int transactionIndex = 0;
-
-        // Go back to the begining of the file and read it again, this time storing the transactions in memory.
-        rewind(fp);
-        while (fgets(inputBuffer, 255, fp) != NULL) {
-            char *p = inputBuffer;
-            transactions[transactionIndex].items = calloc(maxItemsOnLine, sizeof(int));
-            int itemCount = 0;
-            while (sscanf(p, "%d", &number) == 1) {
-                // Increment the support of the item and add it to the transaction.
-                C1[number].support += 1;
-                transactions[transactionIndex].items[itemCount] = number;
-                itemCount += 1;
-                if (number >= 100) {
-                    p += 4;
-                } else if (number >= 10) {
-                    p += 3;
-                } else {
-                    p += 2;
-                }
-            }
-            transactions[transactionIndex].numItems = itemCount;
-            transactionIndex++;
+        if (argc == 4 && (outputFileName != NULL || formatGiven)) {
+            printf("The counts are only printed to the standard output: -o and --format apply to the itemsets and "
+                   "rules printed with 'f', 'r' or 'a'.");
+            return EXIT_FAILURE;
         }
-        fclose(fp);
 
-        // Count the number of 1 frequent itemsets
-        size_t numFrequent = 0;
-        for (int i = 0; i <= maxItemNumber; i++) {
-            if (C1[i].support >= minSupport) {
-                numFrequent++;
-            }
-        }
-        // Initialize the 1 frequent itemset list.
-        frequentItemsets[0].numberOfItemsets = numFrequent;
-        frequentItemsets[0].size = 1;
-        frequentItemsets[0].itemsets = calloc(numFrequent, sizeof(struct Itemset));
-        // Add the 1 frequent itemsets to the list.
-        int itemsetIndex = 0;
-        for (int i = 0; i <= maxItemNumber; i++) {
-            if (C1[i].support >= minSupport) {
-                frequentItemsets[0].itemsets[itemsetIndex].size = 1;
-                frequentItemsets[0].itemsets[itemsetIndex].items = calloc(1, sizeof(uint32_t));
-                frequentItemsets[0].itemsets[itemsetIndex].items[0] = C1[i].items[0];
-                frequentItemsets[0].itemsets[itemsetIndex].support = C1[i].support;
-                itemsetIndex++;
-            }
+        struct AprioriResult *result = aprioriMineFile(argv[1], &options);
+        if (result == NULL) {
+            return EXIT_FAILURE;
         }
 
-        // Create the list of hash trees to hold candidate itemsets of size > 1
-        struct HashTree **C = calloc(maxItemsOnLine, sizeof(struct HashTree *));
-
-        // Start of the main loop...
-        // Count the number of frequent itemsets of size k > 1.
-        for (size_t k = 0; frequentItemsets[k].numberOfItemsets > 0; k++) {
-            // Inititialize Ck
-            C[k + 2] = createHashTree(maxItemNumber+1);
-
-            // Generate candidate itemsets of size k from the frequent itemsets of size k-1.
-            int c = 0;
-            for (int p = 0; p < frequentItemsets[k].numberOfItemsets; p++) {
-                for (int q = p + 1; q < frequentItemsets[k].numberOfItemsets; q++) {
-                    struct Itemset itemsetP = frequentItemsets[k].itemsets[p];
-                    struct Itemset itemsetQ = frequentItemsets[k].itemsets[q];
-
-                    int i = 0;
-                    while (i < k + 1 && itemsetP.items[i] == itemsetQ.items[i]) {
-                        i++;
-                    }
-                    if (i == k) {
-                        struct Itemset *newItemset = malloc(sizeof(struct Itemset));
-                        newItemset->items = calloc(k + 2, sizeof(uint32_t));
-                        newItemset->support = 0;
-                        int j = 0;
-                        while (j < k + 1) {
-                            newItemset->items[j] = itemsetP.items[j];
-                            j++;
-                        }
-                        newItemset->items[j] = itemsetQ.items[j - 1];
-                        newItemset->size = k + 2;
-                        insert(C[k + 2], C[k + 2]->root, 1, newItemset); // Insert the new itemset into the hash tree.
-                        c++;
-                    }
-                }
+        // Print the results depending on the input arguments.
+        startStopwatch(&stopwatch);
+        bool written = true;
+        if (argc == 4) {
+            if (options.topRules == 0) {
+                printFrequentItemsetCounts(result);
             }
-
-            // Using the list of transactions, count the support for the candidate itemsets.
-            for (int t = 0; t < numTransactions; t++) {
-                if (transactions[t].numItems >= k + 2) {
-                    count(C[k + 2], C[k + 2]->root, &transactions[t], 0, k + 2, 1);
-                }
+            printf("Number of association rules: %zu\n", aprioriForEachRule(result, NULL, NULL));
+        } else if (*argv[4] == 'f' || *argv[4] == 'r' || *argv[4] == 'a') {
+            struct ResultWriter *writer = openResultWriter(outputFileName, format, result);
+            if (writer == NULL) {
+                aprioriFreeResult(result);
+                return EXIT_FAILURE;
             }
-
-            // Count the number of frequent k itemsets.
-            struct Node *currNode = C[k + 2]->firstLeaf;
-            numFrequent = 0;
-            while (currNode != NULL) {
-                for (int i = 0; i < currNode->numItemsets; i++) {
-                    if (currNode->itemsets[i] != NULL && currNode->itemsets[i]->support >= minSupport) {
-                        numFrequent++;
-                    }
-                }
-                currNode = currNode->nextLeaf;
+            if (*argv[4] != 'r') {
+                aprioriForEachItemset(result, writeItemset, writer);
             }
-
-            // Initialize the k frequent itemset list.
-            frequentItemsets[k + 1].numberOfItemsets = numFrequent;
-            frequentItemsets[k + 1].size = k + 2;
-            frequentItemsets[k + 1].itemsets = calloc(numFrequent, sizeof(struct Itemset));
-            itemsetIndex = 0;
-
-            // Add all the k frequent itemsets to the list.
-            currNode = C[k + 2]->firstLeaf;
-            while (currNode != NULL) {
-                for (int i = 0; i < currNode->numItemsets; i++) {
-                    if (currNode->itemsets[i] != NULL && currNode->itemsets[i]->support >= minSupport) {
-                        frequentItemsets[k + 1].itemsets[itemsetIndex].size = k + 2;
-                        frequentItemsets[k + 1].itemsets[itemsetIndex].items = calloc(k + 2, sizeof(uint32_t));
-                        for (int j = 0; j < k + 2; j++) {
-                            frequentItemsets[k + 1].itemsets[itemsetIndex].items[j] = currNode->itemsets[i]->items[j];
-                        }
-                        frequentItemsets[k + 1].itemsets[itemsetIndex].support = currNode->itemsets[i]->support;
-                        itemsetIndex++;
-                    }
-                }
-                currNode = currNode->nextLeaf;
+            if (*argv[4] != 'f') {
+                aprioriForEachRule(result, writeRule, writer);
             }
-        } // End of the main loop.
-
-        // Print the results depending on the input arguments.
-        if (argc == 4) {
-            printFrequentItemsetCounts(frequentItemsets);
-            printStrongAssociationRuleCount(frequentItemsets, C, C1, confidence, numTransactions);
+            written = closeResultWriter(writer);
         } else {
-            if (*argv[4] == 'f') {
-                printFrequentItemsets(frequentItemsets, numTransactions);
-            } else if (*argv[4] == 'r') {
-                printStrongAssociationRules(frequentItemsets, C, C1, confidence, numTransactions);
-            } else if (*argv[4] == 'a') {
-                printFrequentItemsets(frequentItemsets, numTransactions);
-                printStrongAssociationRules(frequentItemsets, C, C1, confidence, numTransactions);
-            } else {
-                printf("Unrecognized parameter: %s\n", argv[4]);
+            printf("Unrecognized parameter: %s\n", argv[4]);
+        }
+        fflush(stdout);
+        stopStopwatch(&stopwatch, &stats.output);
+        aprioriFreeResult(result);
+        if (!written) {
+            return EXIT_FAILURE;
+        }
+
+        if (writeStatistics) {
+            written = writeStats(&stats, statsFileName);
+            freeStats(&stats);
+            if (!written) {
+                return EXIT_FAILURE;
             }
         }
-        clock_t time2 = clock();
-//        Uncomment to print the elapsed time.
-//        printf("Elapsed time: %lf s", (double) (time2 - time1) / CLOCKS_PER_SEC);
         return EXIT_SUCCESS;
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,64 @@
+//
+// Structures shared by the Apriori mining engines.
+//
+
+#ifndef APRIORI_APRIORI_H
+#define APRIORI_APRIORI_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+// The engines, filters, rankings and item orders are part of the interface of the library.
+#include "libapriori.h"
+
+// Represents a transaction, as a view of the items stored in a TransactionDatabase.
+struct Transaction {
+    const uint32_t *items;
+    int numItems;
+};
+
+// Represents the transactions loaded from a file, stored in compressed sparse row form: the items of transaction t
+// are items[offsets[t]] to items[offsets[t + 1] - 1].
+struct TransactionDatabase {
+    uint32_t *items;
+    size_t *offsets;        // The start of each transaction in items, followed by the total number of items.
+    size_t numTransactions;
+    uint32_t *itemSupports; // The number of transactions containing each item, indexed by item number.
+    uint32_t *itemNumbers;  // The item number of each item if the loader numbered sparse items densely, or NULL.
+    size_t maxItemNumber;
+    size_t maxTransactionLength;
+    size_t numBytes;        // The size of the file the transactions were loaded from.
+    double loadSeconds;     // The time taken to load the transactions.
+    void *fileData;         // The binary file the arrays point into, or NULL if they were allocated by the parser.
+    bool fileMapped;        // true if fileData is a memory mapping, false if it was read into an allocated buffer.
+};
+
+// Represents an itemset
+struct Itemset {
+    uint32_t *items;
+    uint32_t support;
+    size_t size;
+    uint32_t id; // The index of the itemset in its level's candidate list.
+};
+
+// Represents a collection of frequent itemsets of a certain size.
+struct FrequentItemset {
+    size_t size;
+    size_t numberOfItemsets;
+    struct Itemset *itemsets;
+};
+
+/**
+ * Gets a transaction of a database.
+ * @param database - The database containing the transaction.
+ * @param t - The index of the transaction.
+ * @return A view of the items of the transaction.
+ */
+static inline struct Transaction getTransaction(const struct TransactionDatabase *database, size_t t) {
+    struct Transaction transaction;
+    transaction.items = &database->items[database->offsets[t]];
+    transaction.numItems = (int) (database->offsets[t + 1] - database->offsets[t]);
+    return transaction;
+}
+
+#endif //APRIORI_APRIORI_H
@@ -0,0 +1,122 @@
+//
+// An arena allocator. Memory is handed out sequentially from large zeroed blocks and is only ever released all at
+// once, when the arena is destroyed.
+//
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "arena.h"
+
+// Every allocation is aligned for any of the structures stored in an arena.
+#define ARENA_ALIGNMENT 16
+
+// Represents a block of memory owned by an arena.
+struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t size;
+    size_t used;
+    _Alignas(ARENA_ALIGNMENT) unsigned char data[];
+};
+
+// Represents an arena.
+struct Arena {
+    struct ArenaBlock *blocks; // The block currently allocated from, followed by the full ones.
+    size_t blockSize;
+    size_t bytesAllocated;     // The total size of the blocks.
+};
+
+/**
+ * Adds a new block to the front of the arena's block list.
+ * @param arena - The arena to add the block to.
+ * @param size - The number of usable bytes in the block.
+ * @return The new block.
+ */
+static struct ArenaBlock *addBlock(struct Arena *arena, size_t size) {
+    // calloc of a large block gets fresh zeroed pages from the system, so allocations never need clearing.
+    struct ArenaBlock *block = calloc(1, sizeof(struct ArenaBlock) + size);
+    if (block == NULL) {
+        abort();
+    }
+    block->size = size;
+    block->used = 0;
+    block->next = arena->blocks;
+    arena->blocks = block;
+    arena->bytesAllocated += size;
+    return block;
+}
+
+/**
+ * Creates an empty arena.
+ * @param blockSize - The size of the blocks the arena allocates from.
+ * @return The new arena.
+ */
+struct Arena *createArena(size_t blockSize) {
+    struct Arena *arena = malloc(sizeof(struct Arena));
+    arena->blocks = NULL;
+    arena->blockSize = blockSize;
+    arena->bytesAllocated = 0;
+    return arena;
+}
+
+/**
+ * Allocates zeroed memory from an arena.
+ * @param arena - The arena to allocate from.
+ * @param size - The number of bytes to allocate.
+ * @return A pointer to the memory, which stays valid until the arena is destroyed.
+ */
+void *arenaAlloc(struct Arena *arena, size_t size) {
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1);
+    struct ArenaBlock *block = arena->blocks;
+    if (block == NULL || block->size - block->used < size) {
+        if (size > arena->blockSize / 4) {
+            // Large allocations get a block of their own, placed behind the current block so it stays in use.
+            struct ArenaBlock *current = arena->blocks;
+            struct ArenaBlock *large = addBlock(arena, size);
+            if (current != NULL) {
+                arena->blocks = current;
+                large->next = current->next;
+                current->next = large;
+            }
+            large->used = size;
+            return large->data;
+        }
+        block = addBlock(arena, arena->blockSize);
+    }
+    void *memory = block->data + block->used;
+    block->used += size;
+    return memory;
+}
+
+/**
+ * Allocates a zeroed array from an arena.
+ * @param arena - The arena to allocate from.
+ * @param count - The number of elements in the array.
+ * @param size - The size of each element.
+ * @return A pointer to the array, which stays valid until the arena is destroyed.
+ */
+void *arenaCalloc(struct Arena *arena, size_t count, size_t size) {
+    return arenaAlloc(arena, count * size);
+}
+
+/**
+ * Gets the number of bytes an arena has taken from the system.
+ * @param arena - The arena.
+ * @return The total size of the arena's blocks.
+ */
+size_t arenaBytesAllocated(struct Arena *arena) {
+    return arena->bytesAllocated;
+}
+
+/**
+ * Releases all the memory allocated from an arena, and the arena itself.
+ * @param arena - The arena to destroy.
+ */
+void destroyArena(struct Arena *arena) {
+    struct ArenaBlock *block = arena->blocks;
+    while (block != NULL) {
+        struct ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    free(arena);
+}
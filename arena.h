@@ -0,0 +1,17 @@
+//
+// Arena allocator, serving many small allocations from large blocks that are all released together.
+//
+
+#ifndef APRIORI_ARENA_H
+#define APRIORI_ARENA_H
+
+#include <stddef.h>
+
+struct Arena;
+
+struct Arena *createArena(size_t blockSize);
+void *arenaAlloc(struct Arena *arena, size_t size);
+void *arenaCalloc(struct Arena *arena, size_t count, size_t size);
+size_t arenaBytesAllocated(struct Arena *arena);
+void destroyArena(struct Arena *arena);
+#endif //APRIORI_ARENA_H
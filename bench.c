@@ -0,0 +1,615 @@
+/*
+ * Benchmark driver for Apriori. Generates synthetic transaction databases in the style of the IBM Quest generator
+ * (Agrawal and Srikant, Fast Algorithms for Mining Association Rules, 1994), then runs Apriori on every combination
+ * of dataset, support threshold and engine, printing one JSON object per run with its wall time, peak resident set
+ * size and the number of frequent itemsets of every size.
+ *
+ * Usage: apriori_bench [options]
+ *   --apriori=PATH      the Apriori executable (default: Apriori next to apriori_bench).
+ *   --datasets=LIST     comma separated dataset specifications (default: T10I4D100KN1000,T20I6D100KN1000).
+ *   --supports=LIST     comma separated minimum supports (default: 0.01,0.005).
+ *   --engines=LIST      comma separated engines (default: hashtree,trie,bitset,fpgrowth).
+ *   --confidence=C      the minimum confidence (default 0.8).
+ *   --threads=N         the number of threads Apriori runs with (default 1).
+ *   --repeat=N          the number of runs of every combination (default 1).
+ *   --dir=PATH          the directory the datasets are written to (default: /tmp).
+ *   --seed=N            the seed of the generator (default 1).
+ *   --generate=SPEC     only write the dataset SPEC to the file given as the single positional argument.
+ *
+ * A dataset specification is T<average transaction length>I<average pattern length>D<number of transactions>
+ * N<number of items>, optionally followed by L<number of patterns> (default 2000); the counts may end with K or M.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+// The number of patterns the transactions are built from, unless given in the specification.
+#define DEFAULT_NUM_PATTERNS 2000
+
+// The largest itemset size whose count is reported.
+#define MAX_LEVELS 64
+
+// Represents the parameters of a synthetic dataset.
+struct DatasetSpec {
+    double transactionLength; // T: the average number of items in a transaction.
+    double patternLength;     // I: the average number of items in a pattern.
+    size_t numTransactions;   // D
+    size_t numItems;          // N
+    size_t numPatterns;       // L
+};
+
+// Represents a potentially frequent itemset the transactions are built from.
+struct Pattern {
+    uint32_t *items;
+    size_t size;
+    double cumulativeWeight; // The probability of picking this pattern or one before it.
+    double corruption;       // The probability of dropping each further item when the pattern is used.
+};
+
+// Represents the result of one run of Apriori.
+struct RunResult {
+    int status;
+    double seconds;
+    long maxRssKb;
+    size_t itemsetCounts[MAX_LEVELS];
+    size_t numLevels;
+    long numRules;
+};
+
+/*
+ * Random numbers
+ */
+
+static uint64_t randomState = 1;
+
+/**
+ * Draws a uniformly distributed 64 bit number (splitmix64).
+ * @return The number.
+ */
+static uint64_t nextRandom() {
+    uint64_t z = (randomState += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Draws a uniformly distributed number in [0, 1).
+ * @return The number.
+ */
+static double uniform() {
+    return (double) (nextRandom() >> 11) / 9007199254740992.0;
+}
+
+/**
+ * Draws an exponentially distributed number.
+ * @param mean - The mean of the distribution.
+ * @return The number.
+ */
+static double exponential(double mean) {
+    return -mean * log(1.0 - uniform());
+}
+
+/**
+ * Draws a normally distributed number (Box-Muller).
+ * @param mean - The mean of the distribution.
+ * @param deviation - The standard deviation of the distribution.
+ * @return The number.
+ */
+static double normal(double mean, double deviation) {
+    double u = 1.0 - uniform();
+    double v = uniform();
+    return mean + deviation * sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+/**
+ * Draws a Poisson distributed number.
+ * @param mean - The mean of the distribution.
+ * @return The number.
+ */
+static size_t poisson(double mean) {
+    if (mean > 30) {
+        double value = normal(mean, sqrt(mean));
+        return value > 0 ? (size_t) (value + 0.5) : 0;
+    }
+    double limit = exp(-mean);
+    double product = uniform();
+    size_t count = 0;
+    while (product > limit) {
+        product *= uniform();
+        count++;
+    }
+    return count;
+}
+
+/*
+ * Dataset generation
+ */
+
+/**
+ * Parses a count, optionally followed by K (thousands) or M (millions).
+ * @param text - The text to parse, advanced past the count.
+ * @param value - Set to the count.
+ * @return true if a count was read.
+ */
+static bool parseCount(const char **text, double *value) {
+    char *end;
+    *value = strtod(*text, &end);
+    if (end == *text) {
+        return false;
+    }
+    if (*end == 'K') {
+        *value *= 1e3;
+        end++;
+    } else if (*end == 'M') {
+        *value *= 1e6;
+        end++;
+    }
+    *text = end;
+    return true;
+}
+
+/**
+ * Parses a dataset specification such as T10I4D100KN1000.
+ * @param text - The specification.
+ * @param spec - The parameters to fill.
+ * @return true if the specification is valid.
+ */
+static bool parseSpec(const char *text, struct DatasetSpec *spec) {
+    bool seen[4] = {false, false, false, false};
+    spec->numPatterns = DEFAULT_NUM_PATTERNS;
+    while (*text != '\0') {
+        char key = *text++;
+        double value;
+        if (!parseCount(&text, &value) || value <= 0) {
+            return false;
+        }
+        switch (key) {
+            case 'T':
+                spec->transactionLength = value;
+                seen[0] = true;
+                break;
+            case 'I':
+                spec->patternLength = value;
+                seen[1] = true;
+                break;
+            case 'D':
+                spec->numTransactions = (size_t) value;
+                seen[2] = true;
+                break;
+            case 'N':
+                spec->numItems = (size_t) value;
+                seen[3] = true;
+                break;
+            case 'L':
+                spec->numPatterns = (size_t) value;
+                break;
+            default:
+                return false;
+        }
+    }
+    return seen[0] && seen[1] && seen[2] && seen[3] && spec->numItems > 1 && spec->numPatterns > 0;
+}
+
+/**
+ * Compares two items, for use with qsort.
+ */
+static int compareItems(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *) a;
+    uint32_t y = *(const uint32_t *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Checks whether a list of items contains an item.
+ * @param items - The items.
+ * @param numItems - The number of items.
+ * @param item - The item to look for.
+ * @return true if the item is in the list.
+ */
+static bool containsItem(const uint32_t *items, size_t numItems, uint32_t item) {
+    for (size_t i = 0; i < numItems; i++) {
+        if (items[i] == item) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Creates the patterns of a dataset. Every pattern takes a fraction of its items from the previous one, so that
+ * patterns overlap, and gets an exponentially distributed weight and a normally distributed corruption level.
+ * @param spec - The parameters of the dataset.
+ * @return The patterns.
+ */
+static struct Pattern *createPatterns(struct DatasetSpec *spec) {
+    struct Pattern *patterns = calloc(spec->numPatterns, sizeof(struct Pattern));
+    double totalWeight = 0;
+    for (size_t p = 0; p < spec->numPatterns; p++) {
+        struct Pattern *pattern = &patterns[p];
+        size_t size = poisson(spec->patternLength - 1) + 1;
+        if (size > spec->numItems) {
+            size = spec->numItems;
+        }
+        pattern->items = malloc(size * sizeof(uint32_t));
+        if (p > 0) {
+            double fraction = exponential(0.5);
+            size_t numShared = (size_t) ((fraction < 1 ? fraction : 1) * (double) size);
+            if (numShared > patterns[p - 1].size) {
+                numShared = patterns[p - 1].size;
+            }
+            for (size_t i = 0; i < numShared; i++) {
+                uint32_t item = patterns[p - 1].items[nextRandom() % patterns[p - 1].size];
+                if (!containsItem(pattern->items, pattern->size, item)) {
+                    pattern->items[pattern->size++] = item;
+                }
+            }
+        }
+        while (pattern->size < size) {
+            uint32_t item = (uint32_t) (nextRandom() % spec->numItems);
+            if (!containsItem(pattern->items, pattern->size, item)) {
+                pattern->items[pattern->size++] = item;
+            }
+        }
+        totalWeight += exponential(1.0);
+        pattern->cumulativeWeight = totalWeight;
+        double corruption = normal(0.5, 0.1);
+        pattern->corruption = corruption < 0 ? 0 : (corruption > 1 ? 1 : corruption);
+    }
+    for (size_t p = 0; p < spec->numPatterns; p++) {
+        patterns[p].cumulativeWeight /= totalWeight;
+    }
+    return patterns;
+}
+
+/**
+ * Picks a pattern according to the weights.
+ * @param patterns - The patterns.
+ * @param numPatterns - The number of patterns.
+ * @return The index of the pattern.
+ */
+static size_t pickPattern(struct Pattern *patterns, size_t numPatterns) {
+    double u = uniform();
+    size_t low = 0;
+    size_t high = numPatterns - 1;
+    while (low < high) {
+        size_t middle = (low + high) / 2;
+        if (patterns[middle].cumulativeWeight < u) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/**
+ * Writes a synthetic dataset, one transaction per line with its items in increasing order.
+ * Every transaction is filled with corrupted copies of weighted patterns until it reaches its Poisson distributed
+ * size. A pattern that does not fit is added anyway half of the time, and otherwise kept for the next transaction.
+ * @param spec - The parameters of the dataset.
+ * @param fileName - The file to write.
+ * @return true if the file was written.
+ */
+static bool generateDataset(struct DatasetSpec *spec, const char *fileName) {
+    FILE *file = fopen(fileName, "w");
+    if (file == NULL) {
+        printf("File '%s' could not be created.\n", fileName);
+        return false;
+    }
+    struct Pattern *patterns = createPatterns(spec);
+    size_t capacity = 64;
+    uint32_t *items = malloc(capacity * sizeof(uint32_t));
+    uint32_t *chosen = malloc(spec->numItems * sizeof(uint32_t));
+    size_t pending = SIZE_MAX; // The pattern that did not fit in the previous transaction.
+
+    for (size_t t = 0; t < spec->numTransactions; t++) {
+        size_t size = poisson(spec->transactionLength - 1) + 1;
+        size_t numItems = 0;
+        while (numItems < size) {
+            size_t p = pending != SIZE_MAX ? pending : pickPattern(patterns, spec->numPatterns);
+            pending = SIZE_MAX;
+            struct Pattern *pattern = &patterns[p];
+
+            // Drop items from the pattern while a uniform number is below its corruption level.
+            size_t numChosen = pattern->size;
+            memcpy(chosen, pattern->items, pattern->size * sizeof(uint32_t));
+            while (numChosen > 0 && uniform() < pattern->corruption) {
+                chosen[nextRandom() % numChosen] = chosen[numChosen - 1];
+                numChosen--;
+            }
+            if (numItems > 0 && numItems + numChosen > size && uniform() < 0.5) {
+                pending = p;
+                break;
+            }
+            for (size_t i = 0; i < numChosen; i++) {
+                if (!containsItem(items, numItems, chosen[i])) {
+                    if (numItems == capacity) {
+                        capacity *= 2;
+                        items = realloc(items, capacity * sizeof(uint32_t));
+                    }
+                    items[numItems++] = chosen[i];
+                }
+            }
+            if (numChosen == 0 && numItems == 0) {
+                // A fully corrupted pattern; make sure the transaction is not empty.
+                items[numItems++] = (uint32_t) (nextRandom() % spec->numItems);
+            }
+        }
+        qsort(items, numItems, sizeof(uint32_t), compareItems);
+        for (size_t i = 0; i < numItems; i++) {
+            fprintf(file, i + 1 < numItems ? "%u " : "%u\n", items[i]);
+        }
+    }
+
+    for (size_t p = 0; p < spec->numPatterns; p++) {
+        free(patterns[p].items);
+    }
+    free(patterns);
+    free(items);
+    free(chosen);
+    if (fclose(file) != 0) {
+        printf("File '%s' could not be written.\n", fileName);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Running Apriori
+ */
+
+/**
+ * Gets the current value of the monotonic clock.
+ * @return The time in seconds.
+ */
+static double now() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double) time.tv_sec + (double) time.tv_nsec / 1e9;
+}
+
+/**
+ * Runs Apriori in counting mode and reads the number of frequent itemsets and rules it prints.
+ * @param apriori - The Apriori executable.
+ * @param engine - The engine to run.
+ * @param threads - The number of threads.
+ * @param fileName - The dataset.
+ * @param support - The minimum support.
+ * @param confidence - The minimum confidence.
+ * @param result - The result to fill.
+ */
+static void runApriori(const char *apriori, const char *engine, int threads, const char *fileName, double support,
+                       double confidence, struct RunResult *result) {
+    memset(result, 0, sizeof(struct RunResult));
+    result->status = -1;
+    result->numRules = -1;
+    char engineOption[64];
+    char threadOption[32];
+    char supportText[32];
+    char confidenceText[32];
+    snprintf(engineOption, sizeof(engineOption), "--engine=%s", engine);
+    snprintf(threadOption, sizeof(threadOption), "--threads=%d", threads);
+    snprintf(supportText, sizeof(supportText), "%.17g", support);
+    snprintf(confidenceText, sizeof(confidenceText), "%.17g", confidence);
+
+    int pipeFds[2];
+    if (pipe(pipeFds) != 0) {
+        return;
+    }
+    double startTime = now();
+    pid_t child = fork();
+    if (child < 0) {
+        close(pipeFds[0]);
+        close(pipeFds[1]);
+        return;
+    }
+    if (child == 0) {
+        dup2(pipeFds[1], STDOUT_FILENO);
+        close(pipeFds[0]);
+        close(pipeFds[1]);
+        execl(apriori, apriori, engineOption, threadOption, fileName, supportText, confidenceText, (char *) NULL);
+        _exit(127);
+    }
+    close(pipeFds[1]);
+
+    FILE *output = fdopen(pipeFds[0], "r");
+    char line[256];
+    while (fgets(line, sizeof(line), output) != NULL) {
+        size_t level;
+        size_t numItemsets;
+        long numRules;
+        if (sscanf(line, "Number of frequent %zu_itemsets: %zu", &level, &numItemsets) == 2) {
+            if (level >= 1 && level <= MAX_LEVELS) {
+                result->itemsetCounts[level - 1] = numItemsets;
+                if (level > result->numLevels) {
+                    result->numLevels = level;
+                }
+            }
+        } else if (sscanf(line, "Number of association rules: %ld", &numRules) == 1) {
+            result->numRules = numRules;
+        }
+    }
+    fclose(output);
+
+    int status;
+    struct rusage usage;
+    if (wait4(child, &status, 0, &usage) == child) {
+        result->seconds = now() - startTime;
+        result->maxRssKb = usage.ru_maxrss;
+        result->status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    }
+}
+
+/**
+ * Prints the result of a run as a JSON object on one line.
+ */
+static void printResult(const char *dataset, double support, const char *engine, int threads, int run,
+                        struct RunResult *result) {
+    printf("{\"dataset\": \"%s\", \"support\": %g, \"engine\": \"%s\", \"threads\": %d, \"run\": %d, "
+           "\"status\": %d, \"seconds\": %.6f, \"maxRssKb\": %ld, \"itemsets\": [", dataset, support, engine, threads,
+           run, result->status, result->seconds, result->maxRssKb);
+    for (size_t k = 0; k < result->numLevels; k++) {
+        printf(k > 0 ? ", %zu" : "%zu", result->itemsetCounts[k]);
+    }
+    printf("], \"rules\": %ld}\n", result->numRules);
+    fflush(stdout);
+}
+
+/**
+ * Splits a comma separated list in place.
+ * @param list - The list, whose commas are replaced by null characters.
+ * @param numElements - Set to the number of elements.
+ * @return The elements.
+ */
+static char **splitList(char *list, size_t *numElements) {
+    size_t capacity = 1;
+    for (char *c = list; *c != '\0'; c++) {
+        capacity += *c == ',';
+    }
+    char **elements = malloc(capacity * sizeof(char *));
+    *numElements = 0;
+    for (char *element = strtok(list, ","); element != NULL; element = strtok(NULL, ",")) {
+        elements[(*numElements)++] = element;
+    }
+    return elements;
+}
+
+/**
+ * Generates the datasets and runs the benchmark matrix.
+ * @param argc - The number of arguments.
+ * @param argv - The options described at the top of this file.
+ * @return 0 if every run succeeded, 1 otherwise.
+ */
+int main(int argc, char *argv[]) {
+    char defaultApriori[4096];
+    const char *apriori = defaultApriori;
+    char datasetList[1024] = "T10I4D100KN1000,T20I6D100KN1000";
+    char supportList[1024] = "0.01,0.005";
+    char engineList[1024] = "hashtree,trie,bitset,fpgrowth";
+    const char *directory = "/tmp";
+    const char *generate = NULL;
+    double confidence = 0.8;
+    int threads = 1;
+    int repeat = 1;
+
+    // Look for Apriori next to this executable by default.
+    const char *slash = strrchr(argv[0], '/');
+    snprintf(defaultApriori, sizeof(defaultApriori), "%.*sApriori", slash != NULL ? (int) (slash - argv[0] + 1) : 0,
+             argv[0]);
+
+    static struct option longOptions[] = {
+            {"apriori",    required_argument, NULL, 'a'},
+            {"datasets",   required_argument, NULL, 'd'},
+            {"supports",   required_argument, NULL, 's'},
+            {"engines",    required_argument, NULL, 'e'},
+            {"confidence", required_argument, NULL, 'c'},
+            {"threads",    required_argument, NULL, 'j'},
+            {"repeat",     required_argument, NULL, 'r'},
+            {"dir",        required_argument, NULL, 'o'},
+            {"seed",       required_argument, NULL, 'S'},
+            {"generate",   required_argument, NULL, 'g'},
+            {NULL, 0, NULL, 0}
+    };
+    int option;
+    while ((option = getopt_long(argc, argv, "a:d:s:e:c:j:r:o:S:g:", longOptions, NULL)) != -1) {
+        switch (option) {
+            case 'a':
+                apriori = optarg;
+                break;
+            case 'd':
+                snprintf(datasetList, sizeof(datasetList), "%s", optarg);
+                break;
+            case 's':
+                snprintf(supportList, sizeof(supportList), "%s", optarg);
+                break;
+            case 'e':
+                snprintf(engineList, sizeof(engineList), "%s", optarg);
+                break;
+            case 'c':
+                confidence = strtod(optarg, NULL);
+                break;
+            case 'j':
+                threads = atoi(optarg);
+                break;
+            case 'r':
+                repeat = atoi(optarg);
+                break;
+            case 'o':
+                directory = optarg;
+                break;
+            case 'S':
+                randomState = strtoull(optarg, NULL, 10);
+                break;
+            case 'g':
+                generate = optarg;
+                break;
+            default:
+                return EXIT_FAILURE;
+        }
+    }
+    if (threads < 1 || repeat < 1) {
+        printf("The number of threads and of repetitions must be at least 1.\n");
+        return EXIT_FAILURE;
+    }
+
+    struct DatasetSpec spec;
+    if (generate != NULL) {
+        if (optind + 1 != argc) {
+            printf("Usage: %s --generate=SPEC <file>\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        if (!parseSpec(generate, &spec)) {
+            printf("Invalid dataset specification: %s\n", generate);
+            return EXIT_FAILURE;
+        }
+        return generateDataset(&spec, argv[optind]) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    size_t numDatasets;
+    size_t numSupports;
+    size_t numEngines;
+    char **datasets = splitList(datasetList, &numDatasets);
+    char **supports = splitList(supportList, &numSupports);
+    char **engines = splitList(engineList, &numEngines);
+    uint64_t seed = randomState;
+    bool failed = false;
+    for (size_t d = 0; d < numDatasets; d++) {
+        if (!parseSpec(datasets[d], &spec)) {
+            printf("Invalid dataset specification: %s\n", datasets[d]);
+            return EXIT_FAILURE;
+        }
+        // Every dataset is generated from the same seed, so it does not depend on the other datasets of the run.
+        randomState = seed;
+        char fileName[4096];
+        snprintf(fileName, sizeof(fileName), "%s/apriori_bench_%s.txt", directory, datasets[d]);
+        if (!generateDataset(&spec, fileName)) {
+            return EXIT_FAILURE;
+        }
+        for (size_t s = 0; s < numSupports; s++) {
+            double support = strtod(supports[s], NULL);
+            for (size_t e = 0; e < numEngines; e++) {
+                for (int run = 0; run < repeat; run++) {
+                    struct RunResult result;
+                    runApriori(apriori, engines[e], threads, fileName, support, confidence, &result);
+                    printResult(datasets[d], support, engines[e], threads, run, &result);
+                    failed |= result.status != 0;
+                }
+            }
+        }
+        remove(fileName);
+    }
+    free(datasets);
+    free(supports);
+    free(engines);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
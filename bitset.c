@@ -0,0 +1,145 @@
+//
+// A vertical mining engine in the style of Eclat (Zaki, 2000), which stores for every frequent itemset the bitset of
+// the transactions that contain it. The support of a candidate is the number of bits set in the intersection of the
+// bitsets of the two itemsets it was joined from, so the transactions are only read once.
+//
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "bitset.h"
+
+// Compile the word kernels for several instruction sets and pick the widest one the processor supports at load time.
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__ELF__)
+#define BITSET_KERNEL __attribute__((target_clones("arch=icelake-server", "arch=haswell", "popcnt", "default")))
+#else
+#define BITSET_KERNEL
+#endif
+
+// Represents the itemsets found at one level, along with the transaction id bitset of each one.
+struct BitsetLevel {
+    struct Itemset *itemsets;
+    uint64_t *bits;
+    size_t numItemsets;
+    size_t capacity;
+};
+
+/**
+ * Counts the number of transactions in the intersection of two bitsets.
+ * @param a - The first bitset.
+ * @param b - The second bitset.
+ * @param numWords - The number of 64 bit words in each bitset.
+ * @return The number of bits set in both bitsets.
+ */
+BITSET_KERNEL
+static uint32_t intersectionCount(const uint64_t *a, const uint64_t *b, size_t numWords) {
+    uint64_t total = 0;
+    for (size_t w = 0; w < numWords; w++) {
+        total += (uint64_t) __builtin_popcountll(a[w] & b[w]);
+    }
+    return (uint32_t) total;
+}
+
+/**
+ * Stores the intersection of two bitsets.
+ * @param a - The first bitset.
+ * @param b - The second bitset.
+ * @param out - The bitset to write the intersection to.
+ * @param numWords - The number of 64 bit words in each bitset.
+ */
+BITSET_KERNEL
+static void intersect(const uint64_t *a, const uint64_t *b, uint64_t *out, size_t numWords) {
+    for (size_t w = 0; w < numWords; w++) {
+        out[w] = a[w] & b[w];
+    }
+}
+
+/**
+ * Adds an itemset to a level, growing the level if needed.
+ * @param level - The level to add the itemset to.
+ * @param itemset - The itemset to add; its items are now owned by the level.
+ * @param numWords - The number of 64 bit words in each bitset.
+ * @return A pointer to the bitset of the added itemset, to be filled in by the caller.
+ */
+static uint64_t *addItemset(struct BitsetLevel *level, struct Itemset *itemset, size_t numWords) {
+    if (level->numItemsets == level->capacity) {
+        level->capacity = level->capacity == 0 ? 64 : level->capacity * 2;
+        level->itemsets = realloc(level->itemsets, level->capacity * sizeof(struct Itemset));
+        level->bits = realloc(level->bits, level->capacity * numWords * sizeof(uint64_t));
+    }
+    level->itemsets[level->numItemsets] = *itemset;
+    return &level->bits[level->numItemsets++ * numWords];
+}
+
+/**
+ * Finds the frequent itemsets of size k > 1 using vertical transaction id bitsets.
+ * The frequent 1-itemsets must already be in frequentItemsets[0]; the following levels are filled in the same
+ * lexicographic order that the hash tree engine produces.
+ * @param database - The transactions.
+ * @param minSupport - The minimum support count of a frequent itemset.
+ * @param frequentItemsets - The list of frequent itemsets to fill.
+ */
+void mineBitsets(struct TransactionDatabase *database, uint32_t minSupport, struct FrequentItemset *frequentItemsets) {
+    size_t numTransactions = database->numTransactions;
+    size_t maxItemNumber = database->maxItemNumber;
+    size_t numWords = (numTransactions + 63) / 64;
+
+    // Build the bitset of every frequent item with one pass over the transactions.
+    struct BitsetLevel level = {0};
+    int *itemIndex = malloc((maxItemNumber + 1) * sizeof(int));
+    for (size_t i = 0; i <= maxItemNumber; i++) {
+        itemIndex[i] = -1;
+    }
+    for (size_t i = 0; i < frequentItemsets[0].numberOfItemsets; i++) {
+        itemIndex[frequentItemsets[0].itemsets[i].items[0]] = (int) i;
+        memset(addItemset(&level, &frequentItemsets[0].itemsets[i], numWords), 0, numWords * sizeof(uint64_t));
+    }
+    for (size_t t = 0; t < numTransactions; t++) {
+        struct Transaction transaction = getTransaction(database, t);
+        for (int i = 0; i < transaction.numItems; i++) {
+            int index = itemIndex[transaction.items[i]];
+            if (index >= 0) {
+                level.bits[index * numWords + t / 64] |= (uint64_t) 1 << (t % 64);
+            }
+        }
+    }
+    free(itemIndex);
+
+    for (size_t k = 0; level.numItemsets > 0; k++) {
+        struct BitsetLevel next = {0};
+
+        // Join the itemsets that share their first k items; the levels are sorted, so they are adjacent.
+        for (size_t p = 0; p < level.numItemsets; p++) {
+            struct Itemset *itemsetP = &level.itemsets[p];
+            for (size_t q = p + 1; q < level.numItemsets; q++) {
+                struct Itemset *itemsetQ = &level.itemsets[q];
+                if (memcmp(itemsetP->items, itemsetQ->items, k * sizeof(uint32_t)) != 0) {
+                    break;
+                }
+                uint32_t support = intersectionCount(&level.bits[p * numWords], &level.bits[q * numWords], numWords);
+                if (support >= minSupport) {
+                    struct Itemset newItemset;
+                    newItemset.items = calloc(k + 2, sizeof(uint32_t));
+                    memcpy(newItemset.items, itemsetP->items, (k + 1) * sizeof(uint32_t));
+                    newItemset.items[k + 1] = itemsetQ->items[k];
+                    newItemset.size = k + 2;
+                    newItemset.support = support;
+                    newItemset.id = (uint32_t) next.numItemsets;
+                    intersect(&level.bits[p * numWords], &level.bits[q * numWords],
+                              addItemset(&next, &newItemset, numWords), numWords);
+                }
+            }
+        }
+
+        frequentItemsets[k + 1].size = k + 2;
+        frequentItemsets[k + 1].numberOfItemsets = next.numItemsets;
+        frequentItemsets[k + 1].itemsets = next.itemsets;
+
+        // From k = 1 on, the itemsets of the previous level are owned by frequentItemsets.
+        if (k == 0) {
+            free(level.itemsets);
+        }
+        free(level.bits);
+        level = next;
+    }
+}
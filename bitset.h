@@ -0,0 +1,11 @@
+//
+// Vertical (transaction id bitset) mining engine.
+//
+
+#ifndef APRIORI_BITSET_H
+#define APRIORI_BITSET_H
+
+#include "apriori.h"
+
+void mineBitsets(struct TransactionDatabase *database, uint32_t minSupport, struct FrequentItemset *frequentItemsets);
+#endif //APRIORI_BITSET_H
@@ -0,0 +1,31 @@
+/*
+ * Converts a text file of transactions into the binary format, which Apriori maps in place instead of parsing. The
+ * loader sorts the items of every line and drops the repeated ones, so that the binary file is one the binary loader
+ * accepts.
+ * Usage: apriori_convert <transactions.txt> <transactions.bin>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "apriori.h"
+#include "loader.h"
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        printf("Usage: %s <text file> <binary file>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    struct TransactionDatabase database;
+    if (!loadTransactions(argv[1], &database)) {
+        return EXIT_FAILURE;
+    }
+    if (!saveTransactions(argv[2], &database)) {
+        freeTransactions(&database);
+        return EXIT_FAILURE;
+    }
+    printf("Converted %zu transactions (%zu items, largest item number %zu).\n", database.numTransactions,
+           database.offsets[database.numTransactions], database.maxItemNumber);
+    freeTransactions(&database);
+    return EXIT_SUCCESS;
+}
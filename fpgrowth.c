@@ -0,0 +1,580 @@
+//
+// A mining engine based on FP-Growth (Han, Pei and Yin, 2000). The transactions are compressed into a prefix tree of
+// their frequent items, ordered from most to least frequent, and the frequent itemsets are grown recursively from
+// conditional trees without generating any candidates. The closed and maximal itemsets are grown the same way, with
+// the pruning of CLOSET+ (Wang, Han and Pei, 2003) and FPMax (Grahne and Zhu, 2003): the items found in every
+// transaction of a conditional tree are merged into the prefix, and a branch is dropped as soon as it is covered by an
+// itemset already found.
+//
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "fpgrowth.h"
+
+// Represents a node of an FP-tree. Nodes refer to each other by their index in the tree's node array.
+struct FpNode {
+    uint32_t rank;        // The rank of the node's item, 0 being the most frequent item.
+    uint32_t count;       // The number of transactions sharing the path from the root to this node.
+    int32_t parent;
+    int32_t firstChild;
+    int32_t nextSibling;
+    int32_t nextSameItem; // The next node holding the same item.
+};
+
+// Represents an FP-tree along with its header table.
+struct FpTree {
+    struct FpNode *nodes;
+    size_t numNodes;
+    size_t capacity;
+    int32_t *heads;       // The first node holding each item, indexed by rank.
+    uint32_t *supports;   // The support of each item in the tree, indexed by rank.
+};
+
+// Represents a key of a SupersetIndex: an item, and the support of the itemsets listed under it in closed mode.
+struct IndexKey {
+    uint32_t support;
+    uint32_t rank;
+    uint32_t count; // The number of itemsets listed under the key.
+    int32_t head;   // The first entry of the list, or -1 if the slot of the table is free.
+};
+
+// Represents the closed or maximal itemsets found so far, listed under each of their items to find the supersets of
+// an itemset. In closed mode they are also listed by support, since only the supersets of the same support matter.
+struct SupersetIndex {
+    uint32_t *ranks;        // The ranks of the items of every itemset, each in increasing order.
+    size_t numRanks;
+    size_t rankCapacity;
+    size_t *offsets;        // The start of each itemset in ranks, followed by the end of the last one.
+    size_t numItemsets;
+    size_t itemsetCapacity;
+    struct IndexKey *keys;  // An open addressing table of the keys.
+    size_t keyCapacity;     // The number of slots of the table, a power of 2.
+    size_t numKeys;
+    uint32_t *entryItemsets; // The itemset of each entry of the lists.
+    int32_t *entryNext;      // The next entry of the same list, or -1.
+    size_t numEntries;
+    size_t entryCapacity;
+};
+
+// Holds the state shared by every step of the recursion.
+struct FpMiner {
+    size_t numRanks;
+    uint32_t minSupport;
+    uint32_t *rankItems;  // The item number of each rank.
+    uint32_t *prefix;     // The ranks of the items in the itemset being grown.
+    struct FrequentItemset *frequentItemsets;
+    size_t *capacities;   // The number of itemsets allocated at each level of frequentItemsets.
+    size_t maxSize;       // The size of the largest itemset found.
+    enum AprioriItemsetFilter filter;
+    struct SupersetIndex found; // The closed or maximal itemsets found so far.
+    uint32_t *sorted;     // Room for the ranks of an itemset being checked against the index.
+};
+
+/**
+ * Creates an empty FP-tree with only a root node.
+ * @param numRanks - The number of distinct items that can be inserted in the tree.
+ * @return The new tree.
+ */
+static struct FpTree *createFpTree(size_t numRanks) {
+    struct FpTree *tree = malloc(sizeof(struct FpTree));
+    tree->capacity = 64;
+    tree->nodes = malloc(tree->capacity * sizeof(struct FpNode));
+    tree->nodes[0] = (struct FpNode) {UINT32_MAX, 0, -1, -1, -1, -1};
+    tree->numNodes = 1;
+    tree->heads = malloc(numRanks * sizeof(int32_t));
+    memset(tree->heads, -1, numRanks * sizeof(int32_t));
+    tree->supports = calloc(numRanks, sizeof(uint32_t));
+    return tree;
+}
+
+/**
+ * Frees an FP-tree.
+ * @param tree - The tree to free.
+ */
+static void freeFpTree(struct FpTree *tree) {
+    free(tree->nodes);
+    free(tree->heads);
+    free(tree->supports);
+    free(tree);
+}
+
+/**
+ * Inserts a path of items into an FP-tree, sharing the longest existing prefix.
+ * @param tree - The tree to insert the path into.
+ * @param ranks - The ranks of the items on the path, in increasing order.
+ * @param numRanks - The number of items on the path.
+ * @param count - The number of transactions that contain the path.
+ */
+static void insertPath(struct FpTree *tree, const uint32_t *ranks, size_t numRanks, uint32_t count) {
+    int32_t node = 0;
+    for (size_t i = 0; i < numRanks; i++) {
+        int32_t child = tree->nodes[node].firstChild;
+        while (child >= 0 && tree->nodes[child].rank != ranks[i]) {
+            child = tree->nodes[child].nextSibling;
+        }
+        if (child < 0) {
+            if (tree->numNodes == tree->capacity) {
+                tree->capacity *= 2;
+                tree->nodes = realloc(tree->nodes, tree->capacity * sizeof(struct FpNode));
+            }
+            child = (int32_t) tree->numNodes++;
+            tree->nodes[child] = (struct FpNode) {ranks[i], 0, node, -1, tree->nodes[node].firstChild,
+                                                  tree->heads[ranks[i]]};
+            tree->nodes[node].firstChild = child;
+            tree->heads[ranks[i]] = child;
+        }
+        tree->nodes[child].count += count;
+        tree->supports[ranks[i]] += count;
+        node = child;
+    }
+}
+
+/**
+ * Compares two unsigned integers, for use with qsort.
+ */
+static int compareRanks(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *) a;
+    uint32_t y = *(const uint32_t *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Compares two itemsets of the same size lexicographically, for use with qsort.
+ */
+static int compareItemsets(const void *a, const void *b) {
+    const struct Itemset *x = a;
+    const struct Itemset *y = b;
+    for (size_t i = 0; i < x->size; i++) {
+        if (x->items[i] != y->items[i]) {
+            return x->items[i] < y->items[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Adds the current prefix to the list of frequent itemsets of its size.
+ * @param miner - The state of the recursion.
+ * @param size - The number of items in the prefix.
+ * @param support - The support of the prefix.
+ */
+static void addFrequentItemset(struct FpMiner *miner, size_t size, uint32_t support) {
+    struct FrequentItemset *level = &miner->frequentItemsets[size - 1];
+    if (level->numberOfItemsets == miner->capacities[size - 1]) {
+        miner->capacities[size - 1] = miner->capacities[size - 1] == 0 ? 64 : miner->capacities[size - 1] * 2;
+        level->itemsets = realloc(level->itemsets, miner->capacities[size - 1] * sizeof(struct Itemset));
+    }
+    struct Itemset *itemset = &level->itemsets[level->numberOfItemsets];
+    itemset->items = calloc(size, sizeof(uint32_t));
+    for (size_t i = 0; i < size; i++) {
+        itemset->items[i] = miner->rankItems[miner->prefix[i]];
+    }
+    qsort(itemset->items, size, sizeof(uint32_t), compareRanks);
+    itemset->size = size;
+    itemset->support = support;
+    itemset->id = (uint32_t) level->numberOfItemsets;
+    level->size = size;
+    level->numberOfItemsets++;
+    if (size > miner->maxSize) {
+        miner->maxSize = size;
+    }
+}
+
+/**
+ * Finds the slot of a key in the table of a superset index.
+ * @param index - The index; its table must have a free slot.
+ * @param support - The support of the itemsets of the list, or 0 in maximal mode.
+ * @param rank - The item of the itemsets of the list.
+ * @return The slot holding the key, or the free slot it would go in.
+ */
+static struct IndexKey *findKey(struct SupersetIndex *index, uint32_t support, uint32_t rank) {
+    size_t mask = index->keyCapacity - 1;
+    size_t slot = ((size_t) support * 0x9E3779B1u ^ (size_t) rank * 0x85EBCA6Bu) & mask;
+    while (index->keys[slot].head >= 0 && (index->keys[slot].support != support || index->keys[slot].rank != rank)) {
+        slot = (slot + 1) & mask;
+    }
+    return &index->keys[slot];
+}
+
+/**
+ * Creates the table of the keys of a superset index, or doubles its size, keeping it at most half full.
+ * @param index - The index.
+ */
+static void growKeys(struct SupersetIndex *index) {
+    struct IndexKey *oldKeys = index->keys;
+    size_t oldCapacity = index->keyCapacity;
+    index->keyCapacity = oldCapacity == 0 ? 1024 : 2 * oldCapacity;
+    index->keys = malloc(index->keyCapacity * sizeof(struct IndexKey));
+    for (size_t i = 0; i < index->keyCapacity; i++) {
+        index->keys[i].head = -1;
+    }
+    for (size_t i = 0; i < oldCapacity; i++) {
+        if (oldKeys[i].head >= 0) {
+            *findKey(index, oldKeys[i].support, oldKeys[i].rank) = oldKeys[i];
+        }
+    }
+    free(oldKeys);
+}
+
+/**
+ * Adds an itemset to a superset index.
+ * @param index - The index.
+ * @param ranks - The ranks of the items of the itemset, in increasing order.
+ * @param size - The number of items.
+ * @param support - The support the itemset is listed under, or 0 in maximal mode.
+ */
+static void addToIndex(struct SupersetIndex *index, const uint32_t *ranks, size_t size, uint32_t support) {
+    if (index->numItemsets + 1 >= index->itemsetCapacity) {
+        index->itemsetCapacity = index->itemsetCapacity == 0 ? 1024 : 2 * index->itemsetCapacity;
+        index->offsets = realloc(index->offsets, (index->itemsetCapacity + 1) * sizeof(size_t));
+        index->offsets[0] = 0;
+    }
+    if (index->numRanks + size > index->rankCapacity) {
+        while (index->numRanks + size > index->rankCapacity) {
+            index->rankCapacity = index->rankCapacity == 0 ? 4096 : 2 * index->rankCapacity;
+        }
+        index->ranks = realloc(index->ranks, index->rankCapacity * sizeof(uint32_t));
+    }
+    if (index->numEntries + size > index->entryCapacity) {
+        while (index->numEntries + size > index->entryCapacity) {
+            index->entryCapacity = index->entryCapacity == 0 ? 4096 : 2 * index->entryCapacity;
+        }
+        index->entryItemsets = realloc(index->entryItemsets, index->entryCapacity * sizeof(uint32_t));
+        index->entryNext = realloc(index->entryNext, index->entryCapacity * sizeof(int32_t));
+    }
+    uint32_t itemset = (uint32_t) index->numItemsets++;
+    memcpy(&index->ranks[index->numRanks], ranks, size * sizeof(uint32_t));
+    index->numRanks += size;
+    index->offsets[index->numItemsets] = index->numRanks;
+
+    for (size_t i = 0; i < size; i++) {
+        if (2 * (index->numKeys + 1) > index->keyCapacity) {
+            growKeys(index);
+        }
+        struct IndexKey *key = findKey(index, support, ranks[i]);
+        if (key->head < 0) {
+            *key = (struct IndexKey) {support, ranks[i], 0, -1};
+            index->numKeys++;
+        }
+        // The latest itemsets come first, as they are the most likely to cover the next ones.
+        int32_t entry = (int32_t) index->numEntries++;
+        index->entryItemsets[entry] = itemset;
+        index->entryNext[entry] = key->head;
+        key->head = entry;
+        key->count++;
+    }
+}
+
+/**
+ * Checks whether an itemset of a superset index holds all the items of another itemset.
+ * @param index - The index.
+ * @param ranks - The ranks of the items of the itemset to cover, in increasing order.
+ * @param size - The number of items.
+ * @param support - The support of the itemsets of the index to consider, or 0 in maximal mode.
+ * @return true if an itemset of the index with that support is a superset of the itemset, or the itemset itself.
+ */
+static bool hasSuperset(struct SupersetIndex *index, const uint32_t *ranks, size_t size, uint32_t support) {
+    if (index->numKeys == 0 || size == 0) {
+        return false;
+    }
+    // Scan the shortest of the lists of the items.
+    struct IndexKey *shortest = NULL;
+    for (size_t i = 0; i < size; i++) {
+        struct IndexKey *key = findKey(index, support, ranks[i]);
+        if (key->head < 0) {
+            return false;
+        }
+        if (shortest == NULL || key->count < shortest->count) {
+            shortest = key;
+        }
+    }
+    for (int32_t entry = shortest->head; entry >= 0; entry = index->entryNext[entry]) {
+        uint32_t itemset = index->entryItemsets[entry];
+        const uint32_t *candidate = &index->ranks[index->offsets[itemset]];
+        size_t candidateSize = index->offsets[itemset + 1] - index->offsets[itemset];
+        if (candidateSize < size) {
+            continue;
+        }
+        // Both itemsets are sorted, so one merge tells whether the candidate holds every item.
+        size_t i = 0;
+        for (size_t j = 0; j < candidateSize && i < size && candidateSize - j >= size - i; j++) {
+            if (candidate[j] == ranks[i]) {
+                i++;
+            } else if (candidate[j] > ranks[i]) {
+                break;
+            }
+        }
+        if (i == size) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Frees the arrays of a superset index.
+ * @param index - The index.
+ */
+static void freeSupersetIndex(struct SupersetIndex *index) {
+    free(index->ranks);
+    free(index->offsets);
+    free(index->keys);
+    free(index->entryItemsets);
+    free(index->entryNext);
+}
+
+/**
+ * Counts the items of the conditional pattern base of an item: the paths leading to its nodes.
+ * @param tree - The tree holding the item.
+ * @param r - The rank of the item.
+ * @param conditionalSupports - Set to the support of every rank below r in the transactions holding the item.
+ */
+static void countConditionalSupports(struct FpTree *tree, size_t r, uint32_t *conditionalSupports) {
+    memset(conditionalSupports, 0, r * sizeof(uint32_t));
+    for (int32_t node = tree->heads[r]; node >= 0; node = tree->nodes[node].nextSameItem) {
+        for (int32_t p = tree->nodes[node].parent; p > 0; p = tree->nodes[p].parent) {
+            conditionalSupports[tree->nodes[p].rank] += tree->nodes[node].count;
+        }
+    }
+}
+
+/**
+ * Builds the conditional tree of an item from the frequent items of each path leading to it.
+ * @param miner - The state of the recursion.
+ * @param tree - The tree holding the item.
+ * @param r - The rank of the item.
+ * @param conditionalSupports - The support of every rank below r in the conditional pattern base; the ranks below the
+ *                              minimum support are left out of the tree.
+ * @param path - Room for a path of the tree.
+ * @return The conditional tree.
+ */
+static struct FpTree *buildConditionalTree(struct FpMiner *miner, struct FpTree *tree, size_t r,
+                                           const uint32_t *conditionalSupports, uint32_t *path) {
+    struct FpTree *conditionalTree = createFpTree(miner->numRanks);
+    for (int32_t node = tree->heads[r]; node >= 0; node = tree->nodes[node].nextSameItem) {
+        size_t pathLength = 0;
+        for (int32_t p = tree->nodes[node].parent; p > 0; p = tree->nodes[p].parent) {
+            if (conditionalSupports[tree->nodes[p].rank] >= miner->minSupport) {
+                path[pathLength++] = tree->nodes[p].rank;
+            }
+        }
+        // The path was collected from the leaf up, so reverse it.
+        for (size_t i = 0; i < pathLength / 2; i++) {
+            uint32_t swap = path[i];
+            path[i] = path[pathLength - 1 - i];
+            path[pathLength - 1 - i] = swap;
+        }
+        insertPath(conditionalTree, path, pathLength, tree->nodes[node].count);
+    }
+    return conditionalTree;
+}
+
+/**
+ * Grows the frequent itemsets that extend the current prefix with the items of the given tree.
+ * @param miner - The state of the recursion.
+ * @param tree - The tree of the transactions containing the prefix (the conditional tree of the prefix).
+ * @param prefixSize - The number of items in the prefix.
+ */
+static void growItemsets(struct FpMiner *miner, struct FpTree *tree, size_t prefixSize) {
+    uint32_t *path = malloc(miner->numRanks * sizeof(uint32_t));
+    uint32_t *conditionalSupports = malloc(miner->numRanks * sizeof(uint32_t));
+
+    // Start from the least frequent item, whose node-links are the shortest.
+    for (size_t r = miner->numRanks; r-- > 0;) {
+        if (tree->supports[r] < miner->minSupport) {
+            continue;
+        }
+        miner->prefix[prefixSize] = (uint32_t) r;
+        // The frequent 1-itemsets are already known.
+        if (prefixSize > 0) {
+            addFrequentItemset(miner, prefixSize + 1, tree->supports[r]);
+        }
+
+        // Count the items of the conditional pattern base of the extended prefix.
+        countConditionalSupports(tree, r, conditionalSupports);
+        bool extendable = false;
+        for (size_t i = 0; i < r; i++) {
+            if (conditionalSupports[i] >= miner->minSupport) {
+                extendable = true;
+                break;
+            }
+        }
+        if (!extendable) {
+            continue;
+        }
+
+        struct FpTree *conditionalTree = buildConditionalTree(miner, tree, r, conditionalSupports, path);
+        growItemsets(miner, conditionalTree, prefixSize + 1);
+        freeFpTree(conditionalTree);
+    }
+    free(path);
+    free(conditionalSupports);
+}
+
+/**
+ * Grows the closed or maximal itemsets that extend the current prefix with the items of the given tree. Every
+ * itemset of a branch holds the items found in all the transactions of its conditional tree, so they are merged into
+ * the prefix instead of being branched on. A branch is dropped when its prefix is a subset of a closed itemset of the
+ * same support found before, or, in maximal mode, when its prefix and all the items of its tree are a subset of a
+ * maximal itemset found before: the itemsets of the branch would then be neither closed nor maximal.
+ * @param miner - The state of the recursion.
+ * @param tree - The tree of the transactions containing the prefix (the conditional tree of the prefix).
+ * @param prefixSize - The number of items in the prefix.
+ */
+static void growClosedItemsets(struct FpMiner *miner, struct FpTree *tree, size_t prefixSize) {
+    uint32_t *path = malloc(miner->numRanks * sizeof(uint32_t));
+    uint32_t *conditionalSupports = malloc(miner->numRanks * sizeof(uint32_t));
+    bool maximal = miner->filter == APRIORI_ITEMSETS_MAXIMAL;
+
+    // Start from the least frequent item, so the supersets of an itemset are found before it.
+    for (size_t r = miner->numRanks; r-- > 0;) {
+        uint32_t support = tree->supports[r];
+        if (support < miner->minSupport) {
+            continue;
+        }
+        size_t size = prefixSize;
+        miner->prefix[size++] = (uint32_t) r;
+
+        // Merge the items of every transaction holding the extended prefix into it.
+        countConditionalSupports(tree, r, conditionalSupports);
+        size_t numTail = 0;
+        for (size_t i = 0; i < r; i++) {
+            if (conditionalSupports[i] == support) {
+                miner->prefix[size++] = (uint32_t) i;
+                conditionalSupports[i] = 0;
+            } else if (conditionalSupports[i] >= miner->minSupport) {
+                numTail++;
+            }
+        }
+
+        // Check the prefix, along with the items it may still be extended with in maximal mode, against the index.
+        memcpy(miner->sorted, miner->prefix, size * sizeof(uint32_t));
+        size_t numSorted = size;
+        for (size_t i = 0; maximal && i < r; i++) {
+            if (conditionalSupports[i] >= miner->minSupport) {
+                miner->sorted[numSorted++] = (uint32_t) i;
+            }
+        }
+        qsort(miner->sorted, numSorted, sizeof(uint32_t), compareRanks);
+        if (hasSuperset(&miner->found, miner->sorted, numSorted, maximal ? 0 : support)) {
+            continue;
+        }
+        // A closed prefix is reported at once; a maximal one only if it cannot be extended.
+        if (!maximal || numTail == 0) {
+            addFrequentItemset(miner, size, support);
+            addToIndex(&miner->found, miner->sorted, size, maximal ? 0 : support);
+        }
+        if (numTail == 0) {
+            continue;
+        }
+
+        struct FpTree *conditionalTree = buildConditionalTree(miner, tree, r, conditionalSupports, path);
+        growClosedItemsets(miner, conditionalTree, size);
+        freeFpTree(conditionalTree);
+    }
+    free(path);
+    free(conditionalSupports);
+}
+
+/**
+ * Finds the frequent itemsets of size k > 1 with FP-Growth, or the closed or maximal itemsets of every size.
+ * The frequent 1-itemsets must already be in frequentItemsets[0] with their supports, which give the order of the
+ * items in the tree. The following levels are filled in the same lexicographic order that the hash tree engine
+ * produces. The closed and maximal itemsets replace the frequent 1-itemsets, and the levels of the sizes that have
+ * none are left empty.
+ * @param database - The transactions.
+ * @param minSupport - The minimum support count of a frequent itemset.
+ * @param frequentItemsets - The list of frequent itemsets to fill, with room for the longest transaction.
+ * @param filter - The itemsets to find.
+ */
+void mineFpGrowth(struct TransactionDatabase *database, uint32_t minSupport, struct FrequentItemset *frequentItemsets,
+                  enum AprioriItemsetFilter filter) {
+    size_t numTransactions = database->numTransactions;
+    size_t maxItemNumber = database->maxItemNumber;
+    struct FpMiner miner;
+    miner.numRanks = frequentItemsets[0].numberOfItemsets;
+    miner.minSupport = minSupport;
+    if (miner.numRanks == 0) {
+        return;
+    }
+
+    // Rank the frequent items by decreasing support, breaking ties by item number.
+    struct Itemset *order = malloc(miner.numRanks * sizeof(struct Itemset));
+    memcpy(order, frequentItemsets[0].itemsets, miner.numRanks * sizeof(struct Itemset));
+    for (size_t i = 1; i < miner.numRanks; i++) {
+        struct Itemset current = order[i];
+        size_t j = i;
+        while (j > 0 && (order[j - 1].support < current.support ||
+                         (order[j - 1].support == current.support && order[j - 1].items[0] > current.items[0]))) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = current;
+    }
+    miner.rankItems = malloc(miner.numRanks * sizeof(uint32_t));
+    uint32_t *itemRanks = malloc((maxItemNumber + 1) * sizeof(uint32_t));
+    for (size_t i = 0; i <= maxItemNumber; i++) {
+        itemRanks[i] = UINT32_MAX;
+    }
+    for (size_t r = 0; r < miner.numRanks; r++) {
+        miner.rankItems[r] = order[r].items[0];
+        itemRanks[order[r].items[0]] = (uint32_t) r;
+    }
+    free(order);
+
+    // Compress the transactions into the FP-tree.
+    struct FpTree *tree = createFpTree(miner.numRanks);
+    uint32_t *path = malloc(miner.numRanks * sizeof(uint32_t));
+    for (size_t t = 0; t < numTransactions; t++) {
+        size_t pathLength = 0;
+        struct Transaction transaction = getTransaction(database, t);
+        for (int i = 0; i < transaction.numItems; i++) {
+            uint32_t rank = itemRanks[transaction.items[i]];
+            if (rank != UINT32_MAX) {
+                path[pathLength++] = rank;
+            }
+        }
+        qsort(path, pathLength, sizeof(uint32_t), compareRanks);
+        insertPath(tree, path, pathLength, 1);
+    }
+    free(path);
+    free(itemRanks);
+
+    miner.frequentItemsets = frequentItemsets;
+    miner.capacities = calloc(miner.numRanks + 1, sizeof(size_t));
+    miner.prefix = malloc(miner.numRanks * sizeof(uint32_t));
+    miner.maxSize = 1;
+    miner.filter = filter;
+    memset(&miner.found, 0, sizeof(struct SupersetIndex));
+    if (filter == APRIORI_ITEMSETS_ALL) {
+        growItemsets(&miner, tree, 0);
+    } else {
+        // The 1-itemsets are found again along with the others, in place of the frequent ones.
+        for (size_t i = 0; i < frequentItemsets[0].numberOfItemsets; i++) {
+            free(frequentItemsets[0].itemsets[i].items);
+        }
+        miner.capacities[0] = frequentItemsets[0].numberOfItemsets;
+        frequentItemsets[0].numberOfItemsets = 0;
+        miner.sorted = malloc(miner.numRanks * sizeof(uint32_t));
+        growClosedItemsets(&miner, tree, 0);
+        free(miner.sorted);
+        freeSupersetIndex(&miner.found);
+    }
+    freeFpTree(tree);
+
+    // The itemsets were found depth first, so sort every level to match the level-wise engines.
+    for (size_t k = filter == APRIORI_ITEMSETS_ALL ? 1 : 0; k < miner.maxSize; k++) {
+        if (frequentItemsets[k].numberOfItemsets == 0) {
+            continue;
+        }
+        qsort(frequentItemsets[k].itemsets, frequentItemsets[k].numberOfItemsets, sizeof(struct Itemset),
+              compareItemsets);
+        for (size_t i = 0; i < frequentItemsets[k].numberOfItemsets; i++) {
+            frequentItemsets[k].itemsets[i].id = (uint32_t) i;
+        }
+    }
+    free(miner.capacities);
+    free(miner.prefix);
+    free(miner.rankItems);
+}
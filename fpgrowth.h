@@ -0,0 +1,12 @@
+//
+// FP-Growth mining engine.
+//
+
+#ifndef APRIORI_FPGROWTH_H
+#define APRIORI_FPGROWTH_H
+
+#include "apriori.h"
+
+void mineFpGrowth(struct TransactionDatabase *database, uint32_t minSupport, struct FrequentItemset *frequentItemsets,
+                  enum AprioriItemsetFilter filter);
+#endif //APRIORI_FPGROWTH_H
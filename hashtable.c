@@ -2,17 +2,12 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include "lookup3.h"
+#include "hashtable.h"
 
 //
 // Created by Zach Holland on 2017-01-31.
 //
 
-struct Entry {
-    uint32_t *key;
-    size_t keyLength;
-    uint32_t value;
-};
-
 uint32_t hashCode(uint32_t *key, size_t keyLength, size_t tableSize) {
     return hashword(key, keyLength, 0) & hashmask(tableSize);
 //    return 0;
@@ -61,6 +56,24 @@ struct Entry *getEntry(struct Entry *table, size_t tableSize, uint32_t *key, siz
     return &table[hashIndex];
 }
 
+// Looks up a key without inserting it; returns NULL if the key is not in the table.
+struct Entry *findEntry(struct Entry *table, size_t tableSize, uint32_t *key, size_t keyLength) {
+    uint32_t hashIndex = hashCode(key, keyLength, tableSize);
+
+    int tableLengthExpanded = 1 << tableSize;
+    while (table[hashIndex].key != NULL) {
+        if (table[hashIndex].keyLength == keyLength && keysEqual(table[hashIndex].key, key, keyLength)) {
+            return &table[hashIndex];
+        }
+        //go to next cell
+        hashIndex += 1;
+
+        //wrap around the table
+        hashIndex %= tableLengthExpanded;
+    }
+    return NULL;
+}
+
 // Table size is 2^^tableSize
 uint32_t incrementCount(struct Entry *table, size_t tableSize, uint32_t *key, size_t keyLength) {
 //    uint32_t hashIndex = hashCode(key, keyLength, tableSize);
@@ -95,4 +108,16 @@ void printValues(struct Entry *table, size_t tableSize) {
         }
     }
     printf("%d\n", count);
-}
\ No newline at end of file
+}
+/**
+ * Gets the size of a hash table that keeps a given number of keys at most half full.
+ * @param numKeys - The number of keys that will be stored in the table.
+ * @return The base 2 logarithm of the table size, as expected by create().
+ */
+size_t hashTableSizeFor(size_t numKeys) {
+    size_t tableSize = 4;
+    while (hashsize(tableSize) < 2 * numKeys) {
+        tableSize++;
+    }
+    return tableSize;
+}
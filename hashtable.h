@@ -6,9 +6,20 @@
 #define APRIORI_HASHTABLE_H
 
 #include <stdint.h>
+#include <stddef.h>
+
+struct Entry {
+    uint32_t *key;
+    size_t keyLength;
+    uint32_t value;
+};
 
 struct Entry * create(size_t tableSize);
+size_t hashTableSizeFor(size_t numKeys);
+struct Entry *getEntry(struct Entry *table, size_t tableSize, uint32_t *key, size_t keyLength);
+struct Entry *findEntry(struct Entry *table, size_t tableSize, uint32_t *key, size_t keyLength);
 uint32_t incrementCount(struct Entry *table, size_t tableSize, uint32_t *key, size_t keyLength);
 uint32_t getCount(struct Entry *table, size_t tableSize, uint32_t *key, size_t keyLength);
 void printValues(struct Entry *table, size_t tableSize);
+void delete(struct Entry *table);
 #endif //APRIORI_HASHTABLE_H
@@ -0,0 +1,1525 @@
+//
+// The hash tree engine: level-wise Apriori (Agrawal and Srikant, 1994) counting the candidates of every pass with a
+// hash tree, or with a prefix trie (see trie.c). The partitioned, incremental and sampled runs (see partition.c,
+// incremental.c and sample.c) count their candidates with it.
+//
+
+#include <stdio.h>
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "hashtree.h"
+#include "arena.h"
+#include "hashtable.h"
+#include "lookup3.h"
+#include "trie.h"
+
+// The number of transactions counted by a single task.
+#define COUNT_BLOCK_SIZE 256
+
+// The number of itemsets a leaf of a hash tree holds before it is split, unless set with --leaf-size.
+#define DEFAULT_LEAF_SIZE 16
+
+// The largest leaf size picked to fit a hash tree in the memory budget before its fanout is lowered.
+#define MAX_AUTO_LEAF_SIZE 1024
+
+// The number of itemsets a new leaf has room for; leaves grow by doubling up to the leaf size.
+#define INITIAL_LEAF_CAPACITY 2
+
+/*
+ * Define structures
+ */
+
+// Represents an internal or external node of a hash tree.
+struct Node {
+    bool isLeaf;
+    struct Node **hashtable;
+    struct Itemset **itemsets;
+    size_t numItemsets;
+    size_t capacity; // The number of itemsets the leaf can hold.
+    struct Node *nextLeaf;
+    struct Node *prevLeaf;
+};
+
+// Represents a hash tree data structure.
+struct HashTree {
+    struct Node *root;
+    struct Node *firstLeaf;
+    size_t fanout;       // The number of children of an interior node; items are hashed modulo the fanout.
+    size_t leafSize;     // The number of itemsets a leaf holds before it is split.
+    bool lossless;       // true if no two items hash to the same child, so a path in the tree identifies its items.
+    struct Arena *arena; // The arena the nodes of the tree are allocated from.
+    size_t numNodes;     // The number of nodes, leaves included.
+    size_t numLeaves;
+};
+
+// Represents a growable list of itemset ids.
+struct IdList {
+    uint32_t *ids;
+    size_t length;
+    size_t capacity;
+};
+
+
+// Represents the counters of a single thread.
+struct Counter {
+    uint32_t *supports; // Indexed by the id of the candidate itemsets.
+    uint32_t *lastSeen; // The stamp of the last transaction counted for each candidate, if the tree is lossy.
+    uint32_t *marks;    // The stamp of the last transaction that contained each itemset of the previous level.
+    struct TrieFrame *stack; // The room for the walk of the trie, if the candidates are in one.
+    uint32_t stamp;
+    uint64_t nodeVisits;
+    uint64_t itemComparisons;
+};
+
+// Represents the counting of the candidates of one level, split into blocks of live transactions.
+struct CountJob {
+    struct HashTree *tree;
+    struct CandidateTrie *trie; // The trie holding the candidates instead of the tree, or NULL.
+    struct TransactionDatabase *database;
+    struct ActiveTransactions *active;
+    struct Generators *generators;
+    size_t k;
+    size_t numCandidates;
+    int numThreads;
+    struct Counter *counters; // The counters of each thread.
+    struct IdList *contained; // The candidates contained by the transactions of each block, if they are recorded.
+};
+
+// Represents the counting of the pairs of frequent items in triangular matrices, split into blocks of live
+// transactions.
+struct PairJob {
+    struct TransactionDatabase *database;
+    struct ActiveTransactions *active;
+    uint32_t *itemIndex; // The index of each item among the frequent items, or UINT32_MAX if it is infrequent.
+    size_t numItems;     // The number of frequent items.
+    uint32_t **matrices; // The pair counters of each thread.
+};
+
+// Represents the counting of the candidates of several levels in the same pass, indexed by their size minus one.
+struct LevelsJob {
+    struct CountJob *jobs;
+    size_t numLevels;
+    struct PairJob *pairs; // The counting of the 2-itemsets in triangular matrices, or NULL if they are in a tree.
+};
+
+/*
+ * Define helper functions that are used by the algorithm
+ */
+
+/**
+ * Creates an empty leaf of a hash tree, at the start of the tree's list of leaves.
+ * @param tree - The tree the leaf belongs to.
+ * @return The new leaf.
+ */
+struct Node *createLeaf(struct HashTree *tree) {
+    struct Node *leaf = arenaAlloc(tree->arena, sizeof(struct Node));
+    leaf->isLeaf = true;
+    leaf->hashtable = NULL;
+    leaf->capacity = tree->leafSize < INITIAL_LEAF_CAPACITY ? tree->leafSize : INITIAL_LEAF_CAPACITY;
+    leaf->itemsets = arenaCalloc(tree->arena, leaf->capacity, sizeof(struct Itemset *));
+    leaf->numItemsets = 0;
+    leaf->prevLeaf = NULL;
+    leaf->nextLeaf = tree->firstLeaf;
+    if (tree->firstLeaf != NULL) {
+        tree->firstLeaf->prevLeaf = leaf;
+    }
+    tree->firstLeaf = leaf;
+    tree->numNodes++;
+    tree->numLeaves++;
+    return leaf;
+}
+
+/**
+ * Creates a hash tree for use with the Apriori algorithm.
+ * @param fanout - The size of the hash tables of the internal nodes.
+ * @param leafSize - The number of itemsets a leaf holds before it is split.
+ * @param numItems - The number of distinct items, numbered from 0.
+ * @param arena - The arena to allocate the tree from; the tree is freed when the arena is destroyed.
+ * @return a pointer to an empty hash tree.
+ */
+struct HashTree *createHashTree(size_t fanout, size_t leafSize, size_t numItems, struct Arena *arena) {
+    struct HashTree *tree = arenaAlloc(arena, sizeof(struct HashTree));
+    tree->fanout = fanout;
+    tree->leafSize = leafSize;
+    tree->lossless = fanout >= numItems;
+    tree->arena = arena;
+    tree->firstLeaf = NULL;
+    tree->numNodes = 0;
+    tree->numLeaves = 0;
+    tree->root = createLeaf(tree);
+    return tree;
+}
+
+/**
+ * Gets the slot of the hash table of an internal node that an item hashes to.
+ * @param tree - The hash tree.
+ * @param item - The item.
+ * @return The index of the child in the hash table.
+ */
+static inline size_t hashItem(struct HashTree *tree, uint32_t item) {
+    return tree->lossless ? item : item % tree->fanout;
+}
+
+/**
+ * Inserts an itemset into the given hash tree.
+ * The children of an internal node are only created when an itemset hashes to them.
+ * @param tree - The hash tree to intern the itemset into.
+ * @param node - The current node of the hash tree (call with root at the start).
+ * @param d  - The current depth of the call to insert in the hash tree (call with 1 at the start).
+ * @param itemset - The itemset to insert.
+ */
+void insert(struct HashTree *tree, struct Node *node, uint32_t d, struct Itemset *itemset) {
+    if (node->isLeaf) {
+        // If the current node has less itemsets than the maximum, insert the itemset.
+        if (node->numItemsets < node->capacity) {
+            node->itemsets[node->numItemsets] = itemset;
+            node->numItemsets += 1;
+            return;
+        }
+        if (node->capacity < tree->leafSize || d > itemset->size) {
+            // Grow the leaf up to the leaf size; past it if every item of the itemsets has been hashed, since the
+            // leaf cannot be split then.
+            struct Itemset **itemsets = arenaAlloc(tree->arena, 2 * node->capacity * sizeof(struct Itemset *));
+            memcpy(itemsets, node->itemsets, node->numItemsets * sizeof(struct Itemset *));
+            node->itemsets = itemsets;
+            node->capacity *= 2;
+            node->itemsets[node->numItemsets] = itemset;
+            node->numItemsets += 1;
+            return;
+        }
+
+        // Otherwise split the leaf into an internal node, taking it out of the list of leaves.
+        if (node->prevLeaf != NULL) {
+            node->prevLeaf->nextLeaf = node->nextLeaf;
+        } else {
+            tree->firstLeaf = node->nextLeaf;
+        }
+        if (node->nextLeaf != NULL) {
+            node->nextLeaf->prevLeaf = node->prevLeaf;
+        }
+        struct Itemset **itemsets = node->itemsets;
+        size_t numItemsets = node->numItemsets;
+        node->isLeaf = false;
+        node->hashtable = arenaCalloc(tree->arena, tree->fanout, sizeof(struct Node *));
+        node->itemsets = NULL;
+        node->numItemsets = 0;
+        node->nextLeaf = NULL;
+        node->prevLeaf = NULL;
+        tree->numLeaves--;
+
+        // Insert the itemsets from the current node into the lists of the children.
+        for (size_t i = 0; i < numItemsets; i++) {
+            insert(tree, node, d, itemsets[i]);
+        }
+    }
+    struct Node **child = &node->hashtable[hashItem(tree, itemset->items[d - 1])];
+    if (*child == NULL) {
+        *child = createLeaf(tree);
+    }
+    insert(tree, *child, d + 1, itemset);
+}
+
+/**
+ * Computes the number of bytes taken by a lossless hash tree. A node at depth d holds the candidates sharing a prefix
+ * of d - 1 items, and is split if there are more than leafSize of them.
+ * @param candidates - The candidates, in lexicographic order.
+ * @param numCandidates - The number of candidates.
+ * @param k - The size of the candidates.
+ * @param fanout - The fanout of the tree.
+ * @param leafSize - The leaf size of the tree.
+ * @return The size of the tree, give or take the growth of the leaves.
+ */
+size_t estimateTreeBytes(struct Itemset **candidates, size_t numCandidates, size_t k, size_t fanout,
+                         size_t leafSize) {
+    size_t numSplits = 0;
+    size_t numLeaves = 1;
+    for (size_t prefix = 0; prefix < k; prefix++) {
+        // Find the nodes at depth prefix + 1 with too many candidates.
+        size_t start = 0;
+        for (size_t c = 1; c <= numCandidates; c++) {
+            if (c == numCandidates || memcmp(candidates[c]->items, candidates[start]->items,
+                                             prefix * sizeof(uint32_t)) != 0) {
+                if (c - start > leafSize) {
+                    numSplits++;
+                    // The children are the distinct items following the prefix.
+                    for (size_t i = start; i < c; i++) {
+                        if (i == start || candidates[i]->items[prefix] != candidates[i - 1]->items[prefix]) {
+                            numLeaves++;
+                        }
+                    }
+                }
+                start = c;
+            }
+        }
+    }
+    // The leaves grow by doubling, so they hold up to twice as many slots as itemsets.
+    return numSplits * fanout * sizeof(struct Node *) + numLeaves * sizeof(struct Node) +
+           2 * numCandidates * sizeof(struct Itemset *);
+}
+
+/**
+ * Chooses the fanout and leaf size of the hash tree of a level, unless they were given.
+ * A lossless tree, with a slot for every item, only compares the items below the leaves and never visits a leaf
+ * twice for a transaction, so it is used with leaves as small as the memory budget allows. Its hash tables take most
+ * of its memory; if even large leaves do not fit, the items are hashed modulo the smallest fanout that spreads the
+ * candidates over leaves of the default size at a depth of at most k.
+ * @param options - The settings of the engine.
+ * @param candidates - The candidates the tree will hold, in lexicographic order.
+ * @param numCandidates - The number of candidates.
+ * @param k - The size of the candidates.
+ * @param numItems - The number of distinct items.
+ * @param fanout - Set to the fanout of the tree.
+ * @param leafSize - Set to the leaf size of the tree.
+ */
+void chooseTreeShape(struct HashTreeOptions *options, struct Itemset **candidates, size_t numCandidates, size_t k,
+                     size_t numItems, size_t *fanout, size_t *leafSize) {
+    *fanout = options->fanout > 0 ? options->fanout : (numItems > 2 ? numItems : 2);
+    *leafSize = options->leafSize > 0 ? options->leafSize : DEFAULT_LEAF_SIZE;
+    if (*fanout < numItems) {
+        return;
+    }
+    while (options->leafSize == 0 && *leafSize < MAX_AUTO_LEAF_SIZE &&
+           estimateTreeBytes(candidates, numCandidates, k, *fanout, *leafSize) > options->memoryBudget) {
+        *leafSize *= 2;
+    }
+    if (options->fanout == 0 &&
+        estimateTreeBytes(candidates, numCandidates, k, *fanout, *leafSize) > options->memoryBudget) {
+        if (options->leafSize == 0) {
+            *leafSize = DEFAULT_LEAF_SIZE;
+        }
+        *fanout = 2;
+        while (*fanout + 1 < numItems) {
+            size_t numLeaves = *fanout;
+            for (size_t d = 1; d < k && numLeaves * *leafSize < numCandidates; d++) {
+                numLeaves *= *fanout;
+            }
+            if (numLeaves * *leafSize >= numCandidates) {
+                break;
+            }
+            (*fanout)++;
+        }
+    }
+}
+
+/**
+ * Gathers the shape of a hash tree.
+ * @param node - The current node (call with root at the start).
+ * @param d - The depth of the node (call with 1 at the start).
+ * @param fanout - The number of children of an internal node.
+ * @param numLeaves - Incremented by the number of leaves under the node.
+ * @param numEmptyLeaves - Incremented by the number of empty leaves under the node.
+ * @param maxDepth - Raised to the depth of the deepest leaf under the node.
+ */
+void measureTree(struct Node *node, size_t d, size_t fanout, size_t *numLeaves, size_t *numEmptyLeaves,
+                 size_t *maxDepth) {
+    if (node->isLeaf) {
+        (*numLeaves)++;
+        if (node->numItemsets == 0) {
+            (*numEmptyLeaves)++;
+        }
+        if (d > *maxDepth) {
+            *maxDepth = d;
+        }
+    } else {
+        for (size_t i = 0; i < fanout; i++) {
+            if (node->hashtable[i] != NULL) {
+                measureTree(node->hashtable[i], d + 1, fanout, numLeaves, numEmptyLeaves, maxDepth);
+            }
+        }
+    }
+}
+
+/**
+ * Stores the candidates of a level in a hash tree sized for them, or in a prefix trie if the settings ask for one.
+ * @param options - The settings of the engine.
+ * @param candidates - The candidates, in lexicographic order.
+ * @param numCandidates - The number of candidates.
+ * @param k - The size of the candidates.
+ * @param numItems - The number of distinct items.
+ * @param arena - The arena to allocate the tree or the trie from.
+ * @param trie - Set to the trie, or to NULL if the candidates are in a hash tree.
+ * @param levelStats - The statistics to add the nodes and leaves to.
+ * @return The hash tree, or NULL if the candidates are in a trie.
+ */
+struct HashTree *storeCandidates(struct HashTreeOptions *options, struct Itemset **candidates, size_t numCandidates,
+                                 size_t k, size_t numItems, struct Arena *arena, struct CandidateTrie **trie,
+                                 struct LevelStats *levelStats) {
+    if (options->trie) {
+        *trie = createCandidateTrie(candidates, numCandidates, k, arena);
+        levelStats->treeNodes += (*trie)->numNodes;
+        levelStats->treeLeaves += (*trie)->numLeaves;
+        return NULL;
+    }
+    *trie = NULL;
+    size_t fanout;
+    size_t leafSize;
+    chooseTreeShape(options, candidates, numCandidates, k, numItems, &fanout, &leafSize);
+    struct HashTree *tree = createHashTree(fanout, leafSize, numItems, arena);
+    for (size_t i = 0; i < numCandidates; i++) {
+        insert(tree, tree->root, 1, candidates[i]);
+    }
+    levelStats->treeNodes += tree->numNodes;
+    levelStats->treeLeaves += tree->numLeaves;
+    return tree;
+}
+
+/**
+ * Appends an id to a list, growing it as needed.
+ * @param list - The list to append to.
+ * @param id - The id to append.
+ */
+void appendId(struct IdList *list, uint32_t id) {
+    if (list->length == list->capacity) {
+        list->capacity = list->capacity == 0 ? 1024 : list->capacity * 2;
+        list->ids = realloc(list->ids, list->capacity * sizeof(uint32_t));
+    }
+    list->ids[list->length++] = id;
+}
+
+/**
+ * Records a candidate contained in a transaction; a TrieMatchCallback.
+ * @param context - The IdList to append to.
+ * @param id - The id of the candidate.
+ */
+void recordId(void *context, uint32_t id) {
+    appendId(context, id);
+}
+
+/**
+ * Counts the number occurences of the itemsets contained in the given transaction.
+ * If the tree is lossy, a leaf can be reached through items other than the ones of its itemsets, and more than once
+ * for the same transaction: the itemsets are then compared to the whole transaction, and counted only the first time
+ * they are found, as recorded in lastSeen.
+ * @param tree - The hash tree storing the itemsets.
+ * @param node - The current node of the count (call with root at the start).
+ * @param transaction - The transaction to count.
+ * @param i - The index of the current item in the transaction.
+ * @param k - The size of the itemsets to be counted.
+ * @param d - The current depth in the hash tree (call with 1 at the start).
+ * @param counter - The counters of the thread, whose stamp identifies the transaction, and which count the nodes
+ *                  visited and the items compared.
+ * @param contained - The list to record the ids of the contained itemsets in, or NULL.
+ * @return The number of itemsets of the node's subtree contained in the transaction.
+ */
+uint32_t count(struct HashTree *tree, struct Node *node, struct Transaction *transaction, int i, size_t k, int d,
+               struct Counter *counter, struct IdList *contained) {
+    uint32_t numMatches = 0;
+    counter->nodeVisits++;
+    if (node->isLeaf) {
+        // For each candidate itemset in the node.
+        for (size_t c = 0; c < node->numItemsets; c++) {
+            struct Itemset *itemset = node->itemsets[c];
+            int j = d - 1;
+            int u = i;
+            if (!tree->lossless) {
+                if (counter->lastSeen[itemset->id] == counter->stamp) {
+                    continue;
+                }
+                j = 0;
+                u = 0;
+            }
+            // Compare the current itemset to the transaction.
+            int start = u;
+            while ((size_t) j < k && u < transaction->numItems) {
+                if (itemset->items[j] == transaction->items[u]) {
+                    j++;
+                }
+                u++;
+            }
+            counter->itemComparisons += (uint64_t) (u - start);
+            // If a match was found, increment its support.
+            if ((size_t) j == k) {
+                if (!tree->lossless) {
+                    counter->lastSeen[itemset->id] = counter->stamp;
+                }
+                counter->supports[itemset->id] += 1;
+                numMatches++;
+                if (contained != NULL) {
+                    appendId(contained, itemset->id);
+                }
+            }
+        }
+    } else {
+        // Recursively call count on subsets of the current transaction at the next level of the hash tree.
+        // The items at depths d to k still have to be matched, so the item hashed at depth d can be at most the
+        // (k - d + 1)th last item of the transaction.
+        while (i + (int) k - d < transaction->numItems) {
+            struct Node *child = node->hashtable[hashItem(tree, transaction->items[i])];
+            if (child != NULL) {
+                numMatches += count(tree, child, transaction, i + 1, k, d + 1, counter, contained);
+            }
+            i++;
+        }
+    }
+    return numMatches;
+}
+
+/**
+ * Prepares a pass over the transactions.
+ * @param pass - The pass to prepare.
+ * @param database - The database in memory, or the summary of the streamed file.
+ * @param active - The live transactions of the database in memory.
+ * @param source - The file to stream the transactions from, or NULL to read the database in memory.
+ */
+void startPass(struct Pass *pass, struct TransactionDatabase *database, struct ActiveTransactions *active,
+               struct StreamSource *source) {
+    memset(pass, 0, sizeof(struct Pass));
+    pass->database = database;
+    pass->active = active;
+    pass->source = source;
+}
+
+/**
+ * Gets the next batch of transactions of a pass. In memory, the only batch is the database with its live
+ * transactions; when streaming, every transaction of a batch is live.
+ * @param pass - The pass.
+ * @param database - Set to the transactions of the batch.
+ * @param active - Set to the live transactions of the batch.
+ * @return true if there is a batch, false at the end of the pass or if the streamed file could not be opened.
+ */
+bool nextBatch(struct Pass *pass, struct TransactionDatabase **database, struct ActiveTransactions **active) {
+    if (pass->source == NULL) {
+        if (pass->started) {
+            return false;
+        }
+        pass->started = true;
+        *database = pass->database;
+        *active = pass->active;
+        return true;
+    }
+    if (!pass->started) {
+        pass->started = true;
+        pass->stream = openTransactionStream(pass->source);
+        if (pass->stream == NULL) {
+            pass->failed = true;
+            return false;
+        }
+    }
+    struct TransactionDatabase *batch = nextTransactionBatch(pass->stream);
+    if (batch == NULL) {
+        return false;
+    }
+    if (batch->numTransactions > pass->batchCapacity) {
+        pass->batchCapacity = batch->numTransactions;
+        pass->batchActive.transactions = realloc(pass->batchActive.transactions,
+                                                 pass->batchCapacity * sizeof(size_t));
+        pass->batchActive.numMatches = realloc(pass->batchActive.numMatches, pass->batchCapacity * sizeof(uint32_t));
+    }
+    for (size_t t = 0; t < batch->numTransactions; t++) {
+        pass->batchActive.transactions[t] = t;
+    }
+    pass->batchActive.numTransactions = batch->numTransactions;
+    *database = batch;
+    *active = &pass->batchActive;
+    return true;
+}
+
+/**
+ * Ends a pass over the transactions. The pass fails if the streamed file could not be read entirely, since the
+ * supports counted would be wrong; the run then has to stop.
+ * @param pass - The pass.
+ */
+void endPass(struct Pass *pass) {
+    if (pass->stream != NULL) {
+        pass->failed = !closeTransactionStream(pass->stream) || pass->failed;
+        free(pass->batchActive.transactions);
+        free(pass->batchActive.numMatches);
+    }
+}
+
+/**
+ * Counts the candidate itemsets contained in a block of live transactions into the counters of the running thread.
+ * @param context - The CountJob of the level.
+ * @param block - The index of the block of live transactions.
+ * @param thread - The index of the running thread.
+ */
+void countBlock(void *context, size_t block, int thread) {
+    struct CountJob *job = context;
+    struct ActiveTransactions *active = job->active;
+    struct IdList *contained = job->contained != NULL ? &job->contained[block] : NULL;
+    size_t last = (block + 1) * COUNT_BLOCK_SIZE;
+    if (last > active->numTransactions) {
+        last = active->numTransactions;
+    }
+    // Work on a copy of the counters, so that the threads do not update the same cache lines.
+    struct Counter counter = job->counters[thread];
+    for (size_t a = block * COUNT_BLOCK_SIZE; a < last; a++) {
+        struct Transaction transaction = getTransaction(job->database, active->transactions[a]);
+        active->numMatches[a] = 0;
+        if ((size_t) transaction.numItems >= job->k) {
+            if (++counter.stamp == 0 && counter.lastSeen != NULL) {
+                memset(counter.lastSeen, 0, job->numCandidates * sizeof(uint32_t));
+                counter.stamp = 1;
+            }
+            if (job->trie != NULL) {
+                active->numMatches[a] = countTrie(job->trie, &transaction, counter.stack, counter.supports,
+                                                  &counter.nodeVisits, &counter.itemComparisons,
+                                                  contained != NULL ? recordId : NULL, contained);
+            } else {
+                active->numMatches[a] = count(job->tree, job->tree->root, &transaction, 0, job->k, 1, &counter,
+                                              contained);
+            }
+        }
+    }
+    job->counters[thread] = counter;
+}
+
+/**
+ * Counts the candidate itemsets contained in a block of live transactions in AprioriTid mode: a candidate is
+ * contained in a transaction if the two itemsets it was joined from both are.
+ * @param context - The CountJob of the level.
+ * @param block - The index of the block of live transactions.
+ * @param thread - The index of the running thread.
+ */
+void countTidBlock(void *context, size_t block, int thread) {
+    struct CountJob *job = context;
+    struct ActiveTransactions *active = job->active;
+    uint32_t *firstCandidate = job->generators->firstCandidate;
+    uint32_t *secondGenerator = job->generators->secondGenerator;
+    size_t last = (block + 1) * COUNT_BLOCK_SIZE;
+    if (last > active->numTransactions) {
+        last = active->numTransactions;
+    }
+    // Work on a copy of the counters, as countBlock does.
+    struct Counter counter = job->counters[thread];
+    for (size_t a = block * COUNT_BLOCK_SIZE; a < last; a++) {
+        uint32_t *itemsets = &active->tidItems[active->tidOffsets[a]];
+        size_t numItemsets = active->tidOffsets[a + 1] - active->tidOffsets[a];
+
+        // Mark the itemsets of the previous level contained in the transaction.
+        if (++counter.stamp == 0) {
+            memset(counter.marks, 0, job->generators->numItemsets * sizeof(uint32_t));
+            counter.stamp = 1;
+        }
+        for (size_t i = 0; i < numItemsets; i++) {
+            counter.marks[itemsets[i]] = counter.stamp;
+        }
+
+        uint32_t numMatches = 0;
+        for (size_t i = 0; i < numItemsets; i++) {
+            for (uint32_t c = firstCandidate[itemsets[i]]; c < firstCandidate[itemsets[i] + 1]; c++) {
+                counter.itemComparisons++;
+                if (counter.marks[secondGenerator[c]] == counter.stamp) {
+                    counter.supports[c]++;
+                    numMatches++;
+                    appendId(&job->contained[block], c);
+                }
+            }
+        }
+        active->numMatches[a] = numMatches;
+    }
+    job->counters[thread] = counter;
+}
+
+/**
+ * Joins the lists of candidates contained by the transactions of every block into the new lists of the live
+ * transactions, used by the next pass in AprioriTid mode.
+ * @param active - The live transactions.
+ * @param contained - The candidates contained by the transactions of each block, which are freed.
+ * @param numBlocks - The number of blocks.
+ */
+void joinContainedLists(struct ActiveTransactions *active, struct IdList *contained, size_t numBlocks) {
+    size_t numIds = 0;
+    for (size_t b = 0; b < numBlocks; b++) {
+        numIds += contained[b].length;
+    }
+    free(active->tidItems);
+    active->tidItems = malloc((numIds + 1) * sizeof(uint32_t));
+    numIds = 0;
+    for (size_t b = 0; b < numBlocks; b++) {
+        if (contained[b].length > 0) {
+            memcpy(&active->tidItems[numIds], contained[b].ids, contained[b].length * sizeof(uint32_t));
+            numIds += contained[b].length;
+        }
+        free(contained[b].ids);
+    }
+    free(contained);
+    if (active->tidOffsets == NULL) {
+        active->tidOffsets = malloc((active->numTransactions + 1) * sizeof(size_t));
+    }
+    active->tidOffsets[0] = 0;
+    for (size_t a = 0; a < active->numTransactions; a++) {
+        active->tidOffsets[a + 1] = active->tidOffsets[a] + active->numMatches[a];
+    }
+}
+
+/**
+ * Allocates the counters of every thread for the counting of the candidates of a level.
+ * @param job - The job to prepare; its database, live transactions and lists are set for every batch.
+ * @param tree - The hash tree storing the candidate itemsets, unused in AprioriTid mode or if they are in a trie.
+ * @param trie - The trie storing the candidate itemsets, or NULL.
+ * @param numCandidates - The number of candidate itemsets.
+ * @param generators - The itemsets the candidates were joined from, used in AprioriTid mode.
+ * @param k - The size of the candidate itemsets.
+ * @param tidMode - true if the candidates are counted in AprioriTid mode.
+ * @param numThreads - The number of threads counting.
+ * @param levelStats - The statistics to add the counters to.
+ */
+void prepareCountJob(struct CountJob *job, struct HashTree *tree, struct CandidateTrie *trie, size_t numCandidates,
+                     struct Generators *generators, size_t k, bool tidMode, int numThreads,
+                     struct LevelStats *levelStats) {
+    job->tree = tree;
+    job->trie = trie;
+    job->generators = generators;
+    job->k = k;
+    job->numCandidates = numCandidates;
+    job->numThreads = numThreads;
+    job->contained = NULL;
+    job->counters = calloc((size_t) numThreads, sizeof(struct Counter));
+    size_t counterLength = numCandidates + 1;
+    for (int w = 0; w < numThreads; w++) {
+        job->counters[w].supports = calloc(numCandidates + 1, sizeof(uint32_t));
+        if (tidMode) {
+            job->counters[w].marks = calloc(generators->numItemsets + 1, sizeof(uint32_t));
+        } else if (trie != NULL) {
+            job->counters[w].stack = calloc(k, sizeof(struct TrieFrame));
+        } else if (!tree->lossless) {
+            job->counters[w].lastSeen = calloc(numCandidates + 1, sizeof(uint32_t));
+        }
+    }
+    if (tidMode) {
+        counterLength += generators->numItemsets + 1;
+    } else if (trie == NULL && !tree->lossless) {
+        counterLength += numCandidates + 1;
+    }
+    levelStats->bytesAllocated += (size_t) numThreads * counterLength * sizeof(uint32_t);
+}
+
+/**
+ * Sums the counters of every thread into the supports of the candidates, and frees them.
+ * @param job - The job whose counting is over.
+ * @param candidates - The candidate itemsets, indexed by their id.
+ * @param levelStats - The statistics to add the node visits and item comparisons to.
+ */
+void finishCountJob(struct CountJob *job, struct Itemset **candidates, struct LevelStats *levelStats) {
+    for (size_t c = 0; c < job->numCandidates; c++) {
+        uint32_t support = 0;
+        for (int w = 0; w < job->numThreads; w++) {
+            support += job->counters[w].supports[c];
+        }
+        candidates[c]->support = support;
+    }
+    for (int w = 0; w < job->numThreads; w++) {
+        levelStats->nodeVisits += job->counters[w].nodeVisits;
+        levelStats->itemComparisons += job->counters[w].itemComparisons;
+        free(job->counters[w].supports);
+        free(job->counters[w].marks);
+        free(job->counters[w].lastSeen);
+        free(job->counters[w].stack);
+    }
+    free(job->counters);
+}
+
+/**
+ * Counts the support of every candidate itemset, splitting the live transactions between threads.
+ * Each thread counts into its own array of counters, which are summed into the candidates once all threads are done,
+ * so the supports are the same regardless of the number of threads.
+ * @param tree - The hash tree storing the candidate itemsets, unused in AprioriTid mode or if they are in a trie.
+ * @param trie - The trie storing the candidate itemsets, or NULL.
+ * @param candidates - The candidate itemsets, indexed by their id.
+ * @param numCandidates - The number of candidate itemsets.
+ * @param pass - The transactions to count. In AprioriTid mode, or if record is true, the lists of the live
+ *               transactions are replaced by the ids of the candidates they contain.
+ * @param generators - The itemsets the candidates were joined from, used in AprioriTid mode.
+ * @param k - The size of the candidate itemsets.
+ * @param record - true to record the candidates contained by each transaction in the hash tree mode.
+ * @param pool - The threads to count with.
+ * @param levelStats - The statistics to add the node visits, item comparisons and counters to.
+ */
+void countSupports(struct HashTree *tree, struct CandidateTrie *trie, struct Itemset **candidates, size_t numCandidates,
+                   struct Pass *pass, struct Generators *generators, size_t k, bool record, struct ThreadPool *pool,
+                   struct LevelStats *levelStats) {
+    bool tidMode = pass->active->tidOffsets != NULL;
+    struct CountJob job;
+    prepareCountJob(&job, tree, trie, numCandidates, generators, k, tidMode, threadPoolSize(pool), levelStats);
+
+    struct TransactionDatabase *database;
+    struct ActiveTransactions *active;
+    while (nextBatch(pass, &database, &active)) {
+        size_t numBlocks = (active->numTransactions + COUNT_BLOCK_SIZE - 1) / COUNT_BLOCK_SIZE;
+        job.database = database;
+        job.active = active;
+        job.contained = tidMode || record ? calloc(numBlocks + 1, sizeof(struct IdList)) : NULL;
+        runParallel(pool, numBlocks, tidMode ? countTidBlock : countBlock, &job);
+        if (job.contained != NULL) {
+            joinContainedLists(active, job.contained, numBlocks);
+        }
+    }
+    endPass(pass);
+
+    // Merge the counters of every thread into the candidates.
+    finishCountJob(&job, candidates, levelStats);
+}
+
+/**
+ * Removes the transactions that cannot contain any candidate of the next level, which has to contain k + 1 frequent
+ * itemsets of size k. In AprioriTid mode the lists of the transactions are also translated from candidate ids to the
+ * indices of the frequent itemsets, dropping the infrequent candidates.
+ * @param active - The live transactions, after the candidates of size k were counted.
+ * @param frequentIndex - The index of each candidate among the frequent itemsets, or UINT32_MAX if it is infrequent;
+ *                        only used in AprioriTid mode.
+ * @param k - The size of the candidates just counted.
+ */
+void reduceTransactions(struct ActiveTransactions *active, const uint32_t *frequentIndex, size_t k) {
+    size_t numLive = 0;
+    size_t numIds = 0;
+    for (size_t a = 0; a < active->numTransactions; a++) {
+        uint32_t numMatches = active->numMatches[a];
+        size_t start = numIds;
+        if (active->tidOffsets != NULL) {
+            for (size_t i = active->tidOffsets[a]; i < active->tidOffsets[a + 1]; i++) {
+                uint32_t index = frequentIndex[active->tidItems[i]];
+                if (index != UINT32_MAX) {
+                    active->tidItems[numIds++] = index;
+                }
+            }
+            numMatches = (uint32_t) (numIds - start);
+        }
+        if (numMatches < k + 1) {
+            numIds = start;
+            continue;
+        }
+        if (active->tidOffsets != NULL) {
+            active->tidOffsets[numLive] = start;
+        }
+        active->transactions[numLive++] = active->transactions[a];
+    }
+    active->numTransactions = numLive;
+    if (active->tidOffsets != NULL) {
+        active->tidOffsets[numLive] = numIds;
+    }
+}
+
+/**
+ * Gets the support for the given itemset.
+ * @param tree - The hash tree containing the itemsets and support counts.
+ * @param node - The current node of the tree.
+ * @param itemset - The itemset to get the support for.
+ * @param d - The current depth of the tree.
+ * @param k - The size of the itemset.
+ * @return The support count for the given item.
+ */
+uint32_t getSupport(struct HashTree *tree, struct Node *node, struct Itemset *itemset, int d, size_t k) {
+    // If the node is a leaf...
+    if (node->numItemsets > 0) {
+        // For each candidate itemset in the node.
+        for (size_t c = 0; c < node->numItemsets; c++) {
+            if (node->itemsets != NULL) {
+                int j = d - 1;
+                // Compare the candidate itemsets to the given itemset.
+                while ((size_t) j < itemset->size) {
+                    if (node->itemsets[c]->items[j] == itemset->items[j]) {
+                        j++;
+                    } else {
+                        break;
+                    }
+                }
+                // If a match was found.
+                if ((size_t) j == k) {
+                    return node->itemsets[c]->support;
+                }
+            }
+        }
+        return 0; // The itemset was not found.
+    } else {
+        // Otherwise, hash to the next level.
+        struct Node *child = node->hashtable[hashItem(tree, itemset->items[d - 1])];
+        if (child != NULL) {
+            return getSupport(tree, child, itemset, d + 1, k);
+        } else {
+            return 0; // The itemset was not found.
+        }
+    }
+}
+
+/**
+ * Gets the position of the counter of a pair of items in a packed upper triangular matrix.
+ * @param a - The index of the first item.
+ * @param b - The index of the second item, greater than a.
+ * @param numItems - The number of items.
+ * @return The position of the counter of the pair.
+ */
+static inline size_t pairIndex(size_t a, size_t b, size_t numItems) {
+    return a * (2 * numItems - a - 1) / 2 + (b - a - 1);
+}
+
+/**
+ * Counts the pairs of frequent items of a block of live transactions into the matrix of the running thread.
+ * @param context - The PairJob.
+ * @param block - The index of the block of live transactions.
+ * @param thread - The index of the running thread.
+ */
+void countPairBlock(void *context, size_t block, int thread) {
+    struct PairJob *job = context;
+    struct ActiveTransactions *active = job->active;
+    uint32_t *matrix = job->matrices[thread];
+    size_t last = (block + 1) * COUNT_BLOCK_SIZE;
+    if (last > active->numTransactions) {
+        last = active->numTransactions;
+    }
+    for (size_t a = block * COUNT_BLOCK_SIZE; a < last; a++) {
+        struct Transaction transaction = getTransaction(job->database, active->transactions[a]);
+        uint32_t numMatches = 0;
+        for (int i = 0; i < transaction.numItems; i++) {
+            uint32_t x = job->itemIndex[transaction.items[i]];
+            if (x == UINT32_MAX) {
+                continue;
+            }
+            for (int j = i + 1; j < transaction.numItems; j++) {
+                uint32_t y = job->itemIndex[transaction.items[j]];
+                if (y == UINT32_MAX || y == x) {
+                    continue;
+                }
+                matrix[x < y ? pairIndex(x, y, job->numItems) : pairIndex(y, x, job->numItems)]++;
+                numMatches++;
+            }
+        }
+        active->numMatches[a] = numMatches;
+    }
+}
+
+/**
+ * Counts every pair of frequent items of the live transactions in a packed upper triangular matrix, without
+ * generating candidates or building a hash tree. Every thread counts into a matrix of its own, so this is only done
+ * if the matrices fit in the memory budget.
+ * @param pass - The transactions to count.
+ * @param frequentItems - The frequent items, in increasing order.
+ * @param options - The settings of the engine.
+ * @param pool - The threads to count with.
+ * @param levelStats - The statistics to add the pairs and the matrices to.
+ * @return The support of every pair of frequent items, in lexicographic order, or NULL if the matrices would not fit
+ *         in the memory budget.
+ */
+uint32_t *countPairMatrix(struct Pass *pass, struct FrequentItemset *frequentItems, struct HashTreeOptions *options,
+                          struct ThreadPool *pool, struct LevelStats *levelStats) {
+    size_t numItems = frequentItems->numberOfItemsets;
+    size_t numPairs = numItems * (numItems - 1) / 2;
+    int numThreads = threadPoolSize(pool);
+    if (numPairs * sizeof(uint32_t) * (size_t) numThreads > options->memoryBudget) {
+        return NULL;
+    }
+
+    levelStats->candidatesGenerated += numPairs;
+    levelStats->bytesAllocated += numPairs * sizeof(uint32_t) * (size_t) numThreads;
+
+    struct PairJob job;
+    job.numItems = numItems;
+    job.itemIndex = malloc((pass->database->maxItemNumber + 1) * sizeof(uint32_t));
+    for (size_t i = 0; i <= pass->database->maxItemNumber; i++) {
+        job.itemIndex[i] = UINT32_MAX;
+    }
+    for (size_t i = 0; i < numItems; i++) {
+        job.itemIndex[frequentItems->itemsets[i].items[0]] = (uint32_t) i;
+    }
+    job.matrices = malloc((size_t) numThreads * sizeof(uint32_t *));
+    for (int w = 0; w < numThreads; w++) {
+        job.matrices[w] = calloc(numPairs + 1, sizeof(uint32_t));
+    }
+    struct TransactionDatabase *database;
+    struct ActiveTransactions *active;
+    while (nextBatch(pass, &database, &active)) {
+        job.database = database;
+        job.active = active;
+        runParallel(pool, (active->numTransactions + COUNT_BLOCK_SIZE - 1) / COUNT_BLOCK_SIZE, countPairBlock, &job);
+    }
+    endPass(pass);
+
+    // Merge the matrices of every thread into the first one.
+    uint32_t *supports = job.matrices[0];
+    for (int w = 1; w < numThreads; w++) {
+        for (size_t p = 0; p < numPairs; p++) {
+            supports[p] += job.matrices[w][p];
+        }
+        free(job.matrices[w]);
+    }
+    if (options->verbose) {
+        fprintf(stderr, "Level 2: %zu pairs of %zu items counted in a triangular matrix (%.1lf MB per thread)\n",
+                numPairs, numItems, (double) (numPairs * sizeof(uint32_t)) / (1024 * 1024));
+    }
+    free(job.matrices);
+    free(job.itemIndex);
+    return supports;
+}
+
+/**
+ * Finds the frequent 2-itemsets by counting every pair of frequent items in a triangular matrix, if it fits in the
+ * memory budget.
+ * @param pass - The transactions to count.
+ * @param minSupport - The minimum support count of a frequent itemset.
+ * @param frequentItemsets - The list of frequent itemsets, whose level of 2-itemsets is filled.
+ * @param options - The settings of the engine.
+ * @param pool - The threads to count with.
+ * @param levelStats - The statistics to add the pairs and the matrices to.
+ * @return true if the pairs were counted, false if the matrices would not fit in the memory budget.
+ */
+bool countPairs(struct Pass *pass, uint32_t minSupport, struct FrequentItemset *frequentItemsets, struct HashTreeOptions *options, struct ThreadPool *pool,
+                struct LevelStats *levelStats) {
+    uint32_t *supports = countPairMatrix(pass, &frequentItemsets[0], options, pool, levelStats);
+    if (supports == NULL) {
+        return false;
+    }
+    size_t numItems = frequentItemsets[0].numberOfItemsets;
+    size_t numPairs = numItems * (numItems - 1) / 2;
+
+    // Add the frequent pairs in lexicographic order, which is the order of the matrix.
+    size_t numFrequent = 0;
+    for (size_t p = 0; p < numPairs; p++) {
+        if (supports[p] >= minSupport) {
+            numFrequent++;
+        }
+    }
+    frequentItemsets[1].numberOfItemsets = numFrequent;
+    frequentItemsets[1].size = 2;
+    frequentItemsets[1].itemsets = calloc(numFrequent, sizeof(struct Itemset));
+    size_t itemsetIndex = 0;
+    size_t p = 0;
+    for (size_t a = 0; a < numItems; a++) {
+        for (size_t b = a + 1; b < numItems; b++, p++) {
+            if (supports[p] >= minSupport) {
+                struct Itemset *itemset = &frequentItemsets[1].itemsets[itemsetIndex];
+                itemset->size = 2;
+                itemset->items = calloc(2, sizeof(uint32_t));
+                itemset->items[0] = frequentItemsets[0].itemsets[a].items[0];
+                itemset->items[1] = frequentItemsets[0].itemsets[b].items[0];
+                itemset->support = supports[p];
+                itemset->id = (uint32_t) itemsetIndex;
+                itemsetIndex++;
+            }
+        }
+    }
+    free(supports);
+    return true;
+}
+
+/**
+ * Checks whether the live transactions would take less room as lists of the frequent itemsets they contain, as
+ * estimated from the supports of the frequent itemsets of the last level.
+ * @param database - The transactions.
+ * @param active - The live transactions.
+ * @param level - The frequent itemsets of the last level.
+ * @return true if the lists are estimated to be smaller than the items of the live transactions.
+ */
+bool listsAreSmaller(struct TransactionDatabase *database, struct ActiveTransactions *active,
+                     struct FrequentItemset *level) {
+    size_t numListEntries = 0;
+    for (size_t i = 0; i < level->numberOfItemsets; i++) {
+        numListEntries += level->itemsets[i].support;
+    }
+    size_t numItems = 0;
+    for (size_t a = 0; a < active->numTransactions; a++) {
+        size_t t = active->transactions[a];
+        numItems += database->offsets[t + 1] - database->offsets[t];
+    }
+    return numListEntries < numItems;
+}
+
+/**
+ * Generates the candidate itemsets of a level by joining the pairs of frequent itemsets of the previous level that
+ * share all their items but the last, and pruning the candidates one of whose subsets is not frequent.
+ * @param previous - The frequent itemsets of size k + 1, in lexicographic order.
+ * @param k - The index of the previous level.
+ * @param minSupport - The minimum support count of the itemsets joined, which may have been raised since the previous
+ *                     level was counted; the itemsets below it are left out.
+ * @param arena - The arena to allocate the candidates from.
+ * @param candidatesOut - Set to the candidates of size k + 2, in lexicographic order, numbered by their id.
+ * @param generators - Set to the itemsets each candidate was joined from.
+ * @param levelStats - The statistics to add the generated and pruned candidates and their lists to.
+ * @return The number of candidates.
+ */
+size_t joinCandidates(struct FrequentItemset *previous, size_t k, uint32_t minSupport, struct Arena *arena,
+                      struct Itemset ***candidatesOut, struct Generators *generators, struct LevelStats *levelStats) {
+    // Index the frequent itemsets of size k-1 to check the subsets of the candidates against them.
+    size_t tableSize = hashTableSizeFor(previous->numberOfItemsets);
+    struct Entry *previousLevel = create(tableSize);
+    for (size_t i = 0; i < previous->numberOfItemsets; i++) {
+        struct Itemset *itemset = &previous->itemsets[i];
+        if (itemset->support >= minSupport) {
+            getEntry(previousLevel, tableSize, itemset->items, itemset->size)->value = itemset->support;
+        }
+    }
+    uint32_t *joined = calloc(k + 2, sizeof(uint32_t));
+    uint32_t *subset = calloc(k + 1, sizeof(uint32_t));
+    generators->numItemsets = previous->numberOfItemsets;
+    generators->firstCandidate = malloc((generators->numItemsets + 1) * sizeof(uint32_t));
+
+    // Generate candidate itemsets of size k from the frequent itemsets of size k-1.
+    size_t c = 0;
+    size_t maxCandidates = 1024;
+    struct Itemset **candidates = malloc(maxCandidates * sizeof(struct Itemset *));
+    generators->secondGenerator = malloc(maxCandidates * sizeof(uint32_t));
+    for (size_t p = 0; p < previous->numberOfItemsets; p++) {
+        struct Itemset itemsetP = previous->itemsets[p];
+        generators->firstCandidate[p] = (uint32_t) c;
+        if (itemsetP.support < minSupport) {
+            continue;
+        }
+        // The itemsets are in lexicographic order, so the ones sharing the first k-2 items with p follow it.
+        for (size_t q = p + 1; q < previous->numberOfItemsets; q++) {
+            struct Itemset itemsetQ = previous->itemsets[q];
+            if (memcmp(itemsetP.items, itemsetQ.items, k * sizeof(uint32_t)) != 0) {
+                break;
+            }
+            if (itemsetQ.support < minSupport) {
+                continue;
+            }
+
+            // Join p and q into the new candidate.
+            memcpy(joined, itemsetP.items, (k + 1) * sizeof(uint32_t));
+            joined[k + 1] = itemsetQ.items[k];
+
+            // Prune the candidate if one of its subsets of size k-1 is not frequent. The subsets without the
+            // last or the second last item are p and q, so only the others are checked.
+            bool allSubsetsFrequent = true;
+            for (size_t skip = 0; skip < k && allSubsetsFrequent; skip++) {
+                memcpy(subset, joined, skip * sizeof(uint32_t));
+                memcpy(&subset[skip], &joined[skip + 1], (k + 1 - skip) * sizeof(uint32_t));
+                allSubsetsFrequent = findEntry(previousLevel, tableSize, subset, k + 1) != NULL;
+            }
+            levelStats->candidatesGenerated++;
+            if (!allSubsetsFrequent) {
+                levelStats->candidatesPruned++;
+                continue;
+            }
+
+            struct Itemset *newItemset = arenaAlloc(arena, sizeof(struct Itemset));
+            newItemset->items = arenaCalloc(arena, k + 2, sizeof(uint32_t));
+            memcpy(newItemset->items, joined, (k + 2) * sizeof(uint32_t));
+            newItemset->support = 0;
+            newItemset->size = k + 2;
+            newItemset->id = (uint32_t) c;
+            if (c == maxCandidates) {
+                maxCandidates *= 2;
+                candidates = realloc(candidates, maxCandidates * sizeof(struct Itemset *));
+                generators->secondGenerator = realloc(generators->secondGenerator, maxCandidates * sizeof(uint32_t));
+            }
+            candidates[c] = newItemset;
+            generators->secondGenerator[c] = (uint32_t) q;
+            c++;
+        }
+    }
+    generators->firstCandidate[generators->numItemsets] = (uint32_t) c;
+    free(joined);
+    free(subset);
+    delete(previousLevel);
+    levelStats->bytesAllocated += maxCandidates * (sizeof(struct Itemset *) + sizeof(uint32_t)) +
+                                  (generators->numItemsets + 1) * sizeof(uint32_t);
+    *candidatesOut = candidates;
+    return c;
+}
+
+/**
+ * Hands a level just found over to the levelFound callback of the options, if any.
+ * @param options - The settings of the engine.
+ * @param frequentItemsets - The list of frequent itemsets.
+ * @param level - The index of the level found.
+ * @param minSupport - The minimum support count the level was found with.
+ * @return The minimum support count of the next levels.
+ */
+static uint32_t raiseMinSupport(struct HashTreeOptions *options, struct FrequentItemset *frequentItemsets,
+                                size_t level, uint32_t minSupport) {
+    if (options->levelFound == NULL) {
+        return minSupport;
+    }
+    uint32_t raised = options->levelFound(options->levelContext, frequentItemsets, level);
+    if (raised > minSupport && options->verbose) {
+        fprintf(stderr, "Raised the minimum support to %u after level %zu\n", raised, level + 1);
+    }
+    return raised > minSupport ? raised : minSupport;
+}
+
+/**
+ * Finds the frequent itemsets of size k > 1 level by level, counting the candidate itemsets of each level with a
+ * hash tree. The frequent 1-itemsets must already be in frequentItemsets[0].
+ * The hash tree and candidates of each level live in an arena of their own, released as soon as the frequent itemsets
+ * of the level have been copied out.
+ * The 2-itemsets are counted directly in a triangular matrix when it fits in the memory budget.
+ * After every level the transactions that cannot contain a candidate of the next level are left out of the following
+ * passes. In hybrid mode, once the frequent itemsets contained by the live transactions take less room than their
+ * items, the transactions are replaced by these lists and the candidates counted as in AprioriTid (Agrawal and
+ * Srikant, 1994), without a hash tree.
+ * When streaming, every pass reads the whole file again, and only the candidates and their counters are kept in
+ * memory; the transactions are then neither reduced nor recorded.
+ * The levelFound callback of the options may raise the minimum support between levels; the itemsets already found
+ * below it are kept, but not joined into candidates any more.
+ * @param database - The transactions, or the summary of the streamed file.
+ * @param minSupport - The minimum support count of a frequent itemset.
+ * @param frequentItemsets - The list of frequent itemsets to fill.
+ * @param options - The settings of the engine.
+ * @param pool - The threads to count the candidates with.
+ * @return true if the itemsets were found, false if the streamed file could not be read (an error message has been
+ *         printed).
+ */
+bool mineHashTree(struct TransactionDatabase *database, uint32_t minSupport, struct FrequentItemset *frequentItemsets,
+                  struct HashTreeOptions *options, struct ThreadPool *pool) {
+    // Start with the transactions that hold at least two frequent items.
+    struct ActiveTransactions active = {0};
+    bool streaming = options->stream != NULL;
+    if (!streaming) {
+        active.transactions = malloc((database->numTransactions + 1) * sizeof(size_t));
+        active.numMatches = malloc((database->numTransactions + 1) * sizeof(uint32_t));
+        for (size_t t = 0; t < database->numTransactions; t++) {
+            if (database->offsets[t + 1] - database->offsets[t] >= 2) {
+                active.transactions[active.numTransactions++] = t;
+            }
+        }
+    }
+    bool record = false; // true when the candidates contained by each transaction are recorded during this pass.
+    bool failed = false;
+
+    // Start of the main loop...
+    // Count the number of frequent itemsets of size k > 1.
+    for (size_t k = 0; frequentItemsets[k].numberOfItemsets > 0; k++) {
+        struct LevelStats levelStats = {0};
+        struct Stopwatch stopwatch;
+        levelStats.liveTransactions = streaming ? database->numTransactions : active.numTransactions;
+        struct Pass pass;
+        startPass(&pass, database, &active, options->stream);
+
+        // The pairs need neither candidates nor a hash tree.
+        startStopwatch(&stopwatch);
+        if (k == 0 && countPairs(&pass, minSupport, frequentItemsets, options, pool, &levelStats)) {
+            stopStopwatch(&stopwatch, &levelStats.count);
+            if (pass.failed) {
+                failed = true;
+                break;
+            }
+            startStopwatch(&stopwatch);
+            if (!streaming) {
+                reduceTransactions(&active, NULL, 2);
+                record = options->hybrid && listsAreSmaller(database, &active, &frequentItemsets[1]);
+            }
+            stopStopwatch(&stopwatch, &levelStats.scan);
+            levelStats.numFrequent = frequentItemsets[1].numberOfItemsets;
+            if (options->stats != NULL) {
+                *getLevelStats(options->stats, 2) = levelStats;
+            }
+            minSupport = raiseMinSupport(options, frequentItemsets, 1, minSupport);
+            continue;
+        }
+
+        // Inititialize Ck
+        struct Arena *arena = createArena(ARENA_BLOCK_SIZE);
+
+        struct Itemset **candidates;
+        struct Generators generators;
+        size_t c = joinCandidates(&frequentItemsets[k], k, minSupport, arena, &candidates, &generators, &levelStats);
+        bool tidMode = active.tidOffsets != NULL;
+        stopStopwatch(&stopwatch, &levelStats.join);
+
+        // Insert the candidates into a hash tree sized for them or a trie, unless they are counted in AprioriTid mode.
+        startStopwatch(&stopwatch);
+        struct HashTree *Ck = NULL;
+        struct CandidateTrie *trie = NULL;
+        if (!tidMode) {
+            Ck = storeCandidates(options, candidates, c, k + 2, database->maxItemNumber + 1, arena, &trie,
+                                 &levelStats);
+            if (options->verbose && trie != NULL) {
+                fprintf(stderr, "Level %zu: %zu candidates in a trie of %zu nodes, %.1lf children per internal node, "
+                                "%.1lf MB\n",
+                        k + 2, c, trie->numNodes,
+                        (double) (trie->numNodes - 1) / (double) (trie->firstLeaf > 0 ? trie->firstLeaf : 1),
+                        (double) arenaBytesAllocated(arena) / (1024 * 1024));
+            } else if (options->verbose) {
+                size_t numLeaves = 0;
+                size_t numEmptyLeaves = 0;
+                size_t maxDepth = 0;
+                measureTree(Ck->root, 1, Ck->fanout, &numLeaves, &numEmptyLeaves, &maxDepth);
+                fprintf(stderr, "Level %zu: %zu candidates in a hash tree of fanout %zu and leaf size %zu%s: depth %zu, "
+                                "%zu leaves (%zu empty), %.1lf itemsets per non-empty leaf, %.1lf MB\n",
+                        k + 2, c, Ck->fanout, Ck->leafSize, Ck->lossless ? "" : " (lossy)", maxDepth, numLeaves,
+                        numEmptyLeaves, numLeaves > numEmptyLeaves ? (double) c / (double) (numLeaves - numEmptyLeaves) : 0,
+                        (double) arenaBytesAllocated(arena) / (1024 * 1024));
+            }
+        }
+        levelStats.bytesAllocated += arenaBytesAllocated(arena);
+        stopStopwatch(&stopwatch, &levelStats.insert);
+
+        // Using the list of transactions, count the support for the candidate itemsets.
+        startStopwatch(&stopwatch);
+        countSupports(Ck, trie, candidates, c, &pass, &generators, k + 2, record, pool, &levelStats);
+        free(generators.firstCandidate);
+        free(generators.secondGenerator);
+        stopStopwatch(&stopwatch, &levelStats.count);
+        if (pass.failed) {
+            free(candidates);
+            destroyArena(arena);
+            failed = true;
+            break;
+        }
+        startStopwatch(&stopwatch);
+
+        // Count the number of frequent k itemsets.
+        size_t numFrequent = 0;
+        for (size_t i = 0; i < c; i++) {
+            if (candidates[i]->support >= minSupport) {
+                numFrequent++;
+            }
+        }
+
+        // Initialize the k frequent itemset list.
+        frequentItemsets[k + 1].numberOfItemsets = numFrequent;
+        frequentItemsets[k + 1].size = k + 2;
+        frequentItemsets[k + 1].itemsets = calloc(numFrequent, sizeof(struct Itemset));
+        size_t itemsetIndex = 0;
+        uint32_t *frequentIndex = malloc((c + 1) * sizeof(uint32_t));
+
+        // Add all the k frequent itemsets to the list, in the (lexicographic) order they were generated.
+        for (size_t i = 0; i < c; i++) {
+            frequentIndex[i] = UINT32_MAX;
+            if (candidates[i]->support >= minSupport) {
+                frequentIndex[i] = (uint32_t) itemsetIndex;
+                frequentItemsets[k + 1].itemsets[itemsetIndex].size = k + 2;
+                frequentItemsets[k + 1].itemsets[itemsetIndex].items = calloc(k + 2, sizeof(uint32_t));
+                for (size_t j = 0; j < k + 2; j++) {
+                    frequentItemsets[k + 1].itemsets[itemsetIndex].items[j] = candidates[i]->items[j];
+                }
+                frequentItemsets[k + 1].itemsets[itemsetIndex].support = candidates[i]->support;
+                itemsetIndex++;
+            }
+        }
+        free(candidates);
+        destroyArena(arena);
+
+        if (!streaming) {
+            reduceTransactions(&active, frequentIndex, k + 2);
+
+            // Record the candidates contained by the transactions in the next pass, and count the following levels in
+            // AprioriTid mode, once these lists should be smaller than the items of the transactions.
+            record = options->hybrid && active.tidOffsets == NULL &&
+                     listsAreSmaller(database, &active, &frequentItemsets[k + 1]);
+        }
+        free(frequentIndex);
+        stopStopwatch(&stopwatch, &levelStats.scan);
+        levelStats.numFrequent = numFrequent;
+        if (options->stats != NULL) {
+            *getLevelStats(options->stats, k + 2) = levelStats;
+        }
+        minSupport = raiseMinSupport(options, frequentItemsets, k + 1, minSupport);
+    } // End of the main loop.
+    free(active.transactions);
+    free(active.numMatches);
+    free(active.tidItems);
+    free(active.tidOffsets);
+    return !failed;
+}
+
+/**
+ * Compares two itemsets of the same size lexicographically, for use with qsort.
+ */
+int compareItemsets(const void *a, const void *b) {
+    const struct Itemset *x = *(struct Itemset *const *) a;
+    const struct Itemset *y = *(struct Itemset *const *) b;
+    for (size_t i = 0; i < x->size; i++) {
+        if (x->items[i] != y->items[i]) {
+            return x->items[i] < y->items[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Counts the candidates of every level contained in a block of live transactions, so that each transaction is read
+ * once for all the levels.
+ * @param context - The LevelsJob.
+ * @param block - The index of the block of live transactions.
+ * @param thread - The index of the running thread.
+ */
+void countLevelsBlock(void *context, size_t block, int thread) {
+    struct LevelsJob *job = context;
+    if (job->pairs != NULL) {
+        countPairBlock(job->pairs, block, thread);
+    }
+    for (size_t l = 0; l < job->numLevels; l++) {
+        if (job->jobs[l].numCandidates > 0) {
+            countBlock(&job->jobs[l], block, thread);
+        }
+    }
+}
+
+/**
+ * Prepares the counting of candidate 2-itemsets in triangular matrices over their items, if they fit in the memory
+ * budget.
+ * @param database - The transactions.
+ * @param candidates - The candidate 2-itemsets.
+ * @param numCandidates - The number of candidates.
+ * @param options - The settings holding the memory budget.
+ * @param numThreads - The number of threads, each counting into its own matrix.
+ * @param job - The job to prepare.
+ * @param levelStats - The statistics to add the matrices to.
+ * @return true if the matrices were allocated, false if they would not fit in the memory budget.
+ */
+bool preparePairJob(struct TransactionDatabase *database, struct Itemset **candidates, size_t numCandidates,
+                    struct HashTreeOptions *options, int numThreads, struct PairJob *job,
+                    struct LevelStats *levelStats) {
+    job->itemIndex = malloc((database->maxItemNumber + 1) * sizeof(uint32_t));
+    for (size_t i = 0; i <= database->maxItemNumber; i++) {
+        job->itemIndex[i] = UINT32_MAX;
+    }
+    // Number the items of the candidates in increasing order, so that every candidate has a cell.
+    for (size_t c = 0; c < numCandidates; c++) {
+        job->itemIndex[candidates[c]->items[0]] = 0;
+        job->itemIndex[candidates[c]->items[1]] = 0;
+    }
+    job->numItems = 0;
+    for (size_t i = 0; i <= database->maxItemNumber; i++) {
+        if (job->itemIndex[i] == 0) {
+            job->itemIndex[i] = (uint32_t) job->numItems++;
+        }
+    }
+    size_t numPairs = job->numItems * (job->numItems - 1) / 2;
+    if (numPairs * sizeof(uint32_t) * (size_t) numThreads > options->memoryBudget) {
+        free(job->itemIndex);
+        return false;
+    }
+    job->matrices = malloc((size_t) numThreads * sizeof(uint32_t *));
+    for (int w = 0; w < numThreads; w++) {
+        job->matrices[w] = calloc(numPairs + 1, sizeof(uint32_t));
+    }
+    levelStats->bytesAllocated += numPairs * sizeof(uint32_t) * (size_t) numThreads;
+    return true;
+}
+
+/**
+ * Sums the matrices of every thread into the supports of the candidate 2-itemsets, and frees them.
+ * @param job - The job whose counting is over.
+ * @param candidates - The candidate 2-itemsets.
+ * @param numCandidates - The number of candidates.
+ * @param numThreads - The number of threads.
+ */
+void finishPairJob(struct PairJob *job, struct Itemset **candidates, size_t numCandidates, int numThreads) {
+    for (size_t c = 0; c < numCandidates; c++) {
+        size_t cell = pairIndex(job->itemIndex[candidates[c]->items[0]], job->itemIndex[candidates[c]->items[1]],
+                                job->numItems);
+        uint32_t support = 0;
+        for (int w = 0; w < numThreads; w++) {
+            support += job->matrices[w][cell];
+        }
+        candidates[c]->support = support;
+    }
+    for (int w = 0; w < numThreads; w++) {
+        free(job->matrices[w]);
+    }
+    free(job->matrices);
+    free(job->itemIndex);
+}
+
+/**
+ * Counts the candidates of several sizes in a single pass over the live transactions, with a hash tree or a trie per
+ * size, so that each transaction is read once for all of them. The 2-itemsets are counted in triangular matrices
+ * instead, if they fit in the memory budget.
+ * @param database - The transactions.
+ * @param active - The live transactions.
+ * @param levelCandidates - The candidates of each level l > 0, of size l + 1, indexed by their id.
+ * @param numCandidates - The number of candidates of each level; the levels without candidates are skipped.
+ * @param numLevels - The number of levels.
+ * @param options - The settings of the hash trees.
+ * @param pool - The threads to count with.
+ * @param arena - The arena to allocate the hash trees or the tries from.
+ * @param levelStats - The statistics of each level, to add the tree, the pass and the counters to.
+ */
+void countLevels(struct TransactionDatabase *database, struct ActiveTransactions *active,
+                 struct Itemset ***levelCandidates, const size_t *numCandidates, size_t numLevels,
+                 struct HashTreeOptions *options, struct ThreadPool *pool, struct Arena *arena,
+                 struct LevelStats *levelStats) {
+    struct CountJob *jobs = calloc(numLevels + 1, sizeof(struct CountJob));
+    int numThreads = threadPoolSize(pool);
+    struct Stopwatch stopwatch;
+    struct PairJob pairJob;
+    struct LevelsJob job = {jobs, numLevels, NULL};
+    if (numLevels > 1 && numCandidates[1] > 0 &&
+        preparePairJob(database, levelCandidates[1], numCandidates[1], options, numThreads, &pairJob,
+                       &levelStats[1])) {
+        pairJob.database = database;
+        pairJob.active = active;
+        job.pairs = &pairJob;
+    }
+    for (size_t l = 1; l < numLevels; l++) {
+        if (numCandidates[l] == 0 || (l == 1 && job.pairs != NULL)) {
+            continue;
+        }
+        startStopwatch(&stopwatch);
+        struct CandidateTrie *trie;
+        struct HashTree *tree = storeCandidates(options, levelCandidates[l], numCandidates[l], l + 1,
+                                                database->maxItemNumber + 1, arena, &trie, &levelStats[l]);
+        prepareCountJob(&jobs[l], tree, trie, numCandidates[l], NULL, l + 1, false, numThreads, &levelStats[l]);
+        jobs[l].database = database;
+        jobs[l].active = active;
+        stopStopwatch(&stopwatch, &levelStats[l].insert);
+    }
+
+    // The pass is shared by the levels, so its time is given to each of them.
+    startStopwatch(&stopwatch);
+    runParallel(pool, (active->numTransactions + COUNT_BLOCK_SIZE - 1) / COUNT_BLOCK_SIZE, countLevelsBlock, &job);
+    for (size_t l = 1; l < numLevels; l++) {
+        if (numCandidates[l] == 0) {
+            continue;
+        }
+        if (l == 1 && job.pairs != NULL) {
+            finishPairJob(job.pairs, levelCandidates[l], numCandidates[l], numThreads);
+        } else {
+            finishCountJob(&jobs[l], levelCandidates[l], &levelStats[l]);
+        }
+        levelStats[l].liveTransactions += active->numTransactions;
+    }
+    struct PhaseTime count = {0};
+    stopStopwatch(&stopwatch, &count);
+    for (size_t l = 1; l < numLevels; l++) {
+        if (numCandidates[l] > 0) {
+            levelStats[l].count.wallSeconds += count.wallSeconds;
+            levelStats[l].count.cpuSeconds += count.cpuSeconds;
+        }
+    }
+    free(jobs);
+}
+
+/**
+ * Lists the transactions of a database that hold at least two items, which are the only ones that can contain a
+ * candidate itemset.
+ * @param active - The live transactions to fill.
+ * @param database - The transactions.
+ */
+void initActiveTransactions(struct ActiveTransactions *active, struct TransactionDatabase *database) {
+    memset(active, 0, sizeof(struct ActiveTransactions));
+    active->transactions = malloc((database->numTransactions + 1) * sizeof(size_t));
+    active->numMatches = malloc((database->numTransactions + 1) * sizeof(uint32_t));
+    for (size_t t = 0; t < database->numTransactions; t++) {
+        if (database->offsets[t + 1] - database->offsets[t] >= 2) {
+            active->transactions[active->numTransactions++] = t;
+        }
+    }
+}
+
+/**
+ * Counts the support of candidate itemsets in the live transactions of a database, with a hash tree sized for them or
+ * a trie.
+ * @param database - The transactions.
+ * @param active - The live transactions.
+ * @param candidates - The candidate itemsets, indexed by their id.
+ * @param numCandidates - The number of candidate itemsets.
+ * @param k - The size of the candidate itemsets.
+ * @param options - The settings of the hash tree.
+ * @param pool - The threads to count with.
+ * @param arena - The arena to allocate the hash tree or the trie from.
+ * @param levelStats - The statistics to add the tree, the pass and the counters to.
+ */
+void countCandidates(struct TransactionDatabase *database, struct ActiveTransactions *active,
+                     struct Itemset **candidates, size_t numCandidates, size_t k, struct HashTreeOptions *options,
+                     struct ThreadPool *pool, struct Arena *arena, struct LevelStats *levelStats) {
+    struct Stopwatch stopwatch;
+    startStopwatch(&stopwatch);
+    struct CandidateTrie *trie;
+    struct HashTree *tree = storeCandidates(options, candidates, numCandidates, k, database->maxItemNumber + 1, arena,
+                                            &trie, levelStats);
+    stopStopwatch(&stopwatch, &levelStats->insert);
+
+    startStopwatch(&stopwatch);
+    struct Pass pass;
+    startPass(&pass, database, active, NULL);
+    countSupports(tree, trie, candidates, numCandidates, &pass, NULL, k, false, pool, levelStats);
+    levelStats->liveTransactions += active->numTransactions;
+    stopStopwatch(&stopwatch, &levelStats->count);
+}
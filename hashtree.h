@@ -0,0 +1,86 @@
+//
+// The hash tree engine, and the counting of candidates the partitioned, incremental and sampled runs are built from.
+//
+
+#ifndef APRIORI_HASHTREE_H
+#define APRIORI_HASHTREE_H
+
+#include <stdbool.h>
+#include "apriori.h"
+#include "threadpool.h"
+#include "stats.h"
+#include "stream.h"
+#include "arena.h"
+
+// The number of bytes the hash tree of one level should fit in, unless set with --memory-budget.
+#define DEFAULT_MEMORY_BUDGET ((size_t) 256 << 20)
+
+// The size of the blocks the hash trees and candidate itemsets are allocated from.
+#define ARENA_BLOCK_SIZE ((size_t) 4 << 20)
+
+// Represents the settings of the hash tree engine.
+struct HashTreeOptions {
+    size_t fanout;       // The number of children of an interior node, or 0 to choose it from the candidates.
+    size_t leafSize;     // The number of itemsets a leaf holds before it is split, or 0 to choose it.
+    size_t memoryBudget; // The number of bytes the tree of one level should fit in when the sizes are chosen.
+    bool hybrid;         // true to switch to AprioriTid counting when it is estimated to be cheaper.
+    bool trie;           // true to store the candidates in a prefix trie instead of a hash tree.
+    bool verbose;        // true to print the shape of the tree of every level to the standard error.
+    struct Stats *stats; // The statistics to fill with the levels, or NULL.
+    struct StreamSource *stream; // The file to read in every pass instead of the database in memory, or NULL.
+    // Called with the list and the index of a level once its frequent itemsets are found; returns a minimum support
+    // for the next levels, which is only applied if it is larger. NULL if the minimum support never changes.
+    uint32_t (*levelFound)(void *context, struct FrequentItemset *frequentItemsets, size_t level);
+    void *levelContext;  // Passed to levelFound.
+};
+
+// Represents the transactions that may still contain candidate itemsets. In AprioriTid mode every transaction is
+// represented by the indices of the frequent itemsets of the previous level it contains, instead of by its items.
+struct ActiveTransactions {
+    size_t *transactions; // The index in the database of each live transaction.
+    size_t numTransactions;
+    uint32_t *numMatches; // The number of candidates each live transaction contained in the last pass.
+    uint32_t *tidItems;   // The itemsets contained by each live transaction, in AprioriTid mode.
+    size_t *tidOffsets;   // The start of each live transaction in tidItems, or NULL outside AprioriTid mode.
+};
+
+// Represents a pass over the transactions: the live transactions of the database in memory, or, when streaming, every
+// transaction of the file, decoded a batch at a time.
+struct Pass {
+    struct TransactionDatabase *database;  // The database in memory, or the summary of the streamed file.
+    struct ActiveTransactions *active;     // The live transactions of the database in memory.
+    struct StreamSource *source;           // The streamed file, or NULL.
+    struct TransactionStream *stream;
+    struct ActiveTransactions batchActive; // The transactions of the current batch, when streaming.
+    size_t batchCapacity;
+    bool started;
+    bool failed;                           // true if the streamed file could not be opened or read entirely.
+};
+
+// Represents the frequent itemsets each candidate was joined from: the candidates joined from the itemset p of the
+// previous level are firstCandidate[p] to firstCandidate[p + 1] - 1, and the other itemset of candidate c is
+// secondGenerator[c].
+struct Generators {
+    size_t numItemsets; // The number of frequent itemsets of the previous level.
+    uint32_t *firstCandidate;
+    uint32_t *secondGenerator;
+};
+
+bool mineHashTree(struct TransactionDatabase *database, uint32_t minSupport, struct FrequentItemset *frequentItemsets,
+                  struct HashTreeOptions *options, struct ThreadPool *pool);
+void initActiveTransactions(struct ActiveTransactions *active, struct TransactionDatabase *database);
+void startPass(struct Pass *pass, struct TransactionDatabase *database, struct ActiveTransactions *active,
+               struct StreamSource *source);
+uint32_t *countPairMatrix(struct Pass *pass, struct FrequentItemset *frequentItems, struct HashTreeOptions *options,
+                          struct ThreadPool *pool, struct LevelStats *levelStats);
+size_t joinCandidates(struct FrequentItemset *previous, size_t k, uint32_t minSupport, struct Arena *arena,
+                      struct Itemset ***candidates, struct Generators *generators, struct LevelStats *levelStats);
+void countCandidates(struct TransactionDatabase *database, struct ActiveTransactions *active,
+                     struct Itemset **candidates, size_t numCandidates, size_t k, struct HashTreeOptions *options,
+                     struct ThreadPool *pool, struct Arena *arena, struct LevelStats *levelStats);
+void countLevels(struct TransactionDatabase *database, struct ActiveTransactions *active,
+                 struct Itemset ***levelCandidates, const size_t *numCandidates, size_t numLevels,
+                 struct HashTreeOptions *options, struct ThreadPool *pool, struct Arena *arena,
+                 struct LevelStats *levelStats);
+int compareItemsets(const void *a, const void *b);
+#endif //APRIORI_HASHTREE_H
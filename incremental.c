@@ -0,0 +1,638 @@
+//
+// Incremental mining (FUP, Cheung et al., 1996): the transactions appended since a run are mined from the state it
+// kept, counting the old transactions only for the itemsets that may have become frequent. The state is a binary
+// file: a header, then for every level the size and number of its itemsets, each written as its item numbers followed
+// by its support.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "incremental.h"
+#include "hashtable.h"
+#include "loader.h"
+#include "recode.h"
+#include "arena.h"
+
+// The first bytes of a state file.
+static const char STATE_MAGIC[8] = {'A', 'P', 'R', 'I', 'O', 'R', 'I', 'S'};
+
+// The version of the state format written by writeMiningState.
+#define STATE_VERSION 1
+
+// Written in the header to detect files saved on a machine of the other byte order.
+#define STATE_BYTE_ORDER 0x01020304u
+
+// The fraction of the minimum support an infrequent itemset needs to be kept in the state of an incremental run.
+// The others are counted again in the old transactions when they may have become frequent, which keeps the pairs of
+// frequent items that rarely occur together out of the state.
+#define STATE_BORDER_FRACTION 0.5
+
+// The header of a state file.
+struct StateHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t numTransactions;
+    uint64_t maxTransactionLength;
+    uint64_t minSupport;
+    uint64_t numLevels;
+};
+
+
+// Represents the mining of old transactions and of the transactions appended since, from the state of the run over
+// the old ones.
+struct IncrementalMining {
+    struct TransactionDatabase *increment; // The appended transactions, recoded.
+    struct ActiveTransactions incrementActive;
+    struct MiningState *state;             // The state of the run over the old transactions.
+    struct Entry **stateLevels;            // The itemsets of each size of the state, keyed by their codes.
+    size_t *stateTableSizes;
+    struct MiningState *newState;
+    const char *historyFileName;           // The file of the old transactions, loaded once they are needed.
+    struct TransactionDatabase history;
+    struct ActiveTransactions historyActive;
+    bool historyLoaded;
+    const uint32_t *itemNames;
+    const uint32_t *itemCodes;
+    size_t numItemCodes;
+    enum AprioriItemOrder order;
+    uint32_t minSupport;
+    uint32_t borderSupport;                // The minimum support of the infrequent itemsets kept in the new state.
+    struct HashTreeOptions *options;
+    struct ThreadPool *pool;
+};
+
+// The ways the support of a candidate in the old transactions is found when mining incrementally.
+enum OldSupport {
+    OLD_SUPPORT_KNOWN, // The state holds the candidate, or there are no old transactions.
+    OLD_SUPPORT_COUNT, // The candidate has to be counted in the old transactions, since it may have become frequent.
+    OLD_SUPPORT_BELOW  // The candidate was below the old minimum support, and still is.
+};
+
+/**
+ * Gets a level of a state, adding the levels up to it if needed, and allocates room for its itemsets.
+ * @param state - The state.
+ * @param size - The size of the itemsets of the level, from 1.
+ * @param numItemsets - The number of itemsets the level will hold; they are counted by numberOfItemsets as they are
+ *                      added.
+ * @return The level, empty.
+ */
+struct FrequentItemset *addStateLevel(struct MiningState *state, size_t size, size_t numItemsets) {
+    if (size > state->numLevels) {
+        state->levels = realloc(state->levels, size * sizeof(struct FrequentItemset));
+        memset(&state->levels[state->numLevels], 0, (size - state->numLevels) * sizeof(struct FrequentItemset));
+        state->numLevels = size;
+    }
+    struct FrequentItemset *level = &state->levels[size - 1];
+    level->size = size;
+    level->numberOfItemsets = 0;
+    level->itemsets = realloc(level->itemsets, (numItemsets > 0 ? numItemsets : 1) * sizeof(struct Itemset));
+    return level;
+}
+
+/**
+ * Reads the state of a run.
+ * @param fileName - The file written by writeMiningState.
+ * @param state - The state to fill.
+ * @return true if the state was read, false otherwise (an error message has been printed).
+ */
+bool readMiningState(const char *fileName, struct MiningState *state) {
+    memset(state, 0, sizeof(struct MiningState));
+    FILE *file = fopen(fileName, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "File '%s' was not found.\n", fileName);
+        return false;
+    }
+    struct StateHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, STATE_MAGIC, sizeof(STATE_MAGIC)) != 0 ||
+        header.version != STATE_VERSION || header.byteOrder != STATE_BYTE_ORDER) {
+        fprintf(stderr, "File '%s' is not a state file.\n", fileName);
+        fclose(file);
+        return false;
+    }
+    state->numTransactions = (size_t) header.numTransactions;
+    state->maxTransactionLength = (size_t) header.maxTransactionLength;
+    state->minSupport = (uint32_t) header.minSupport;
+
+    bool valid = true;
+    for (uint64_t l = 0; l < header.numLevels && valid; l++) {
+        uint64_t sizes[2];
+        valid = fread(sizes, sizeof(uint64_t), 2, file) == 2 && sizes[0] == l + 1;
+        if (!valid) {
+            break;
+        }
+        struct FrequentItemset *level = addStateLevel(state, l + 1, (size_t) sizes[1]);
+        for (uint64_t i = 0; i < sizes[1] && valid; i++) {
+            struct Itemset *itemset = &level->itemsets[level->numberOfItemsets++];
+            itemset->size = l + 1;
+            itemset->items = calloc(l + 1, sizeof(uint32_t));
+            itemset->id = 0;
+            valid = fread(itemset->items, sizeof(uint32_t), l + 1, file) == l + 1 &&
+                    fread(&itemset->support, sizeof(uint32_t), 1, file) == 1;
+        }
+    }
+    fclose(file);
+    if (!valid) {
+        fprintf(stderr, "File '%s' is truncated.\n", fileName);
+        freeMiningState(state);
+    }
+    return valid;
+}
+
+/**
+ * Writes the state of a run.
+ * @param fileName - The file to write.
+ * @param state - The state.
+ * @return true if the state was written, false otherwise (an error message has been printed).
+ */
+bool writeMiningState(const char *fileName, const struct MiningState *state) {
+    FILE *file = fopen(fileName, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "File '%s' could not be created.\n", fileName);
+        return false;
+    }
+    struct StateHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, STATE_MAGIC, sizeof(STATE_MAGIC));
+    header.version = STATE_VERSION;
+    header.byteOrder = STATE_BYTE_ORDER;
+    header.numTransactions = state->numTransactions;
+    header.maxTransactionLength = state->maxTransactionLength;
+    header.minSupport = state->minSupport;
+    header.numLevels = state->numLevels;
+
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (size_t l = 0; l < state->numLevels && written; l++) {
+        struct FrequentItemset *level = &state->levels[l];
+        uint64_t sizes[2] = {l + 1, level->numberOfItemsets};
+        written = fwrite(sizes, sizeof(uint64_t), 2, file) == 2;
+        for (size_t i = 0; i < level->numberOfItemsets && written; i++) {
+            written = fwrite(level->itemsets[i].items, sizeof(uint32_t), l + 1, file) == l + 1 &&
+                      fwrite(&level->itemsets[i].support, sizeof(uint32_t), 1, file) == 1;
+        }
+    }
+    if (fclose(file) != 0 || !written) {
+        fprintf(stderr, "File '%s' could not be written.\n", fileName);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Adds the supports of the items in a state to the supports counted in the transactions appended since, and records
+ * every item seen so far in a new state.
+ * @param state - The state of the previous run; every item it does not hold has a support of 0.
+ * @param increment - The appended transactions, whose item supports have been counted.
+ * @param newState - The state to add the items to.
+ * @param itemSupports - Set to the support of every item number in all the transactions.
+ * @return The largest item number of all the transactions.
+ */
+size_t mergeItemSupports(const struct MiningState *state, const struct TransactionDatabase *increment,
+                         struct MiningState *newState, uint32_t **itemSupports) {
+    size_t maxItemNumber = increment->maxItemNumber;
+    struct FrequentItemset *items = state->numLevels > 0 ? &state->levels[0] : NULL;
+    for (size_t i = 0; items != NULL && i < items->numberOfItemsets; i++) {
+        if (items->itemsets[i].items[0] > maxItemNumber) {
+            maxItemNumber = items->itemsets[i].items[0];
+        }
+    }
+    *itemSupports = calloc(maxItemNumber + 1, sizeof(uint32_t));
+    if (increment->numTransactions > 0) {
+        memcpy(*itemSupports, increment->itemSupports, (increment->maxItemNumber + 1) * sizeof(uint32_t));
+    }
+    for (size_t i = 0; items != NULL && i < items->numberOfItemsets; i++) {
+        (*itemSupports)[items->itemsets[i].items[0]] += items->itemsets[i].support;
+    }
+
+    size_t numItems = 0;
+    for (size_t i = 0; i <= maxItemNumber; i++) {
+        numItems += (*itemSupports)[i] > 0;
+    }
+    struct FrequentItemset *newItems = addStateLevel(newState, 1, numItems);
+    for (size_t i = 0; i <= maxItemNumber; i++) {
+        if ((*itemSupports)[i] > 0) {
+            struct Itemset *itemset = &newItems->itemsets[newItems->numberOfItemsets++];
+            itemset->size = 1;
+            itemset->items = calloc(1, sizeof(uint32_t));
+            itemset->items[0] = (uint32_t) i;
+            itemset->support = (*itemSupports)[i];
+            itemset->id = 0;
+        }
+    }
+    return maxItemNumber;
+}
+
+/**
+ * Frees the itemsets of a state.
+ * @param state - The state.
+ */
+void freeMiningState(struct MiningState *state) {
+    for (size_t l = 0; l < state->numLevels; l++) {
+        for (size_t i = 0; i < state->levels[l].numberOfItemsets; i++) {
+            free(state->levels[l].itemsets[i].items);
+        }
+        free(state->levels[l].itemsets);
+    }
+    free(state->levels);
+    state->levels = NULL;
+    state->numLevels = 0;
+}
+
+/**
+ * Finds the support of a candidate in the old transactions, from the state of the run over them.
+ * @param mining - The incremental mining.
+ * @param items - The codes of the candidate.
+ * @param size - The size of the candidate, at least 2.
+ * @param incrementSupport - The support of the candidate in the appended transactions.
+ * @param oldSupport - Set to the support of the candidate in the old transactions, when it is known.
+ * @return How the support of the candidate in the old transactions is found.
+ */
+enum OldSupport findOldSupport(struct IncrementalMining *mining, uint32_t *items, size_t size,
+                               uint32_t incrementSupport, uint32_t *oldSupport) {
+    struct MiningState *state = mining->state;
+    *oldSupport = 0;
+    if (state->numTransactions == 0) {
+        return OLD_SUPPORT_KNOWN;
+    }
+    if (size <= state->numLevels) {
+        struct Entry *entry = findEntry(mining->stateLevels[size - 1], mining->stateTableSizes[size - 1], items, size);
+        if (entry != NULL) {
+            *oldSupport = entry->value;
+            return OLD_SUPPORT_KNOWN;
+        }
+    }
+    // Any other itemset had a support below the old minimum support.
+    return (uint64_t) incrementSupport + state->minSupport > mining->minSupport ? OLD_SUPPORT_COUNT : OLD_SUPPORT_BELOW;
+}
+
+/**
+ * Loads the old transactions the first time candidates have to be counted in them, and recodes them like the
+ * appended ones.
+ * @param mining - The incremental mining.
+ * @return true if the old transactions are loaded, false otherwise (an error message has been printed).
+ */
+bool loadHistory(struct IncrementalMining *mining) {
+    if (mining->historyLoaded) {
+        return true;
+    }
+    if (!loadTransactions(mining->historyFileName, &mining->history)) {
+        return false;
+    }
+    if (mining->history.itemNumbers != NULL) {
+        fprintf(stderr, "The item numbers of file '%s' are too sparse to update the state of a run.\n",
+                mining->historyFileName);
+        freeTransactions(&mining->history);
+        return false;
+    }
+    if (mining->history.numTransactions != mining->state->numTransactions) {
+        fprintf(stderr, "File '%s' holds %zu transactions, but the state was saved after %zu.\n",
+                mining->historyFileName, mining->history.numTransactions, mining->state->numTransactions);
+        freeTransactions(&mining->history);
+        return false;
+    }
+    applyItemCodes(&mining->history, mining->itemCodes, mining->numItemCodes, mining->order);
+    mining->history.maxItemNumber = mining->increment->maxItemNumber;
+    initActiveTransactions(&mining->historyActive, &mining->history);
+    mining->historyLoaded = true;
+    return true;
+}
+
+/**
+ * Adds an itemset to a level of a state, translating its codes back to item numbers.
+ * @param level - The level of the state, with room for the itemset.
+ * @param codes - The codes of the itemset.
+ * @param size - The size of the itemset.
+ * @param support - The support of the itemset.
+ * @param itemNames - The item number of each code.
+ */
+void addStateItemset(struct FrequentItemset *level, const uint32_t *codes, size_t size, uint32_t support,
+                     const uint32_t *itemNames) {
+    struct Itemset *itemset = &level->itemsets[level->numberOfItemsets++];
+    itemset->size = size;
+    itemset->items = calloc(size, sizeof(uint32_t));
+    for (size_t j = 0; j < size; j++) {
+        itemset->items[j] = itemNames[codes[j]];
+    }
+    itemset->support = support;
+    itemset->id = 0;
+}
+
+/**
+ * Finds the frequent 2-itemsets of the old and new transactions from the supports of the pairs of frequent items in
+ * the new ones, counted in a triangular matrix. If some pairs missing from the state may have become frequent, every
+ * pair is counted in a matrix of the old transactions too.
+ * @param mining - The incremental mining.
+ * @param frequentItemsets - The list of frequent itemsets, whose level of 2-itemsets is filled.
+ * @param supports - The supports of the pairs in the appended transactions, replaced by their supports in all the
+ *                   transactions, or 0 for the pairs that cannot be frequent.
+ * @param levelStats - The statistics of the level.
+ * @return true if the pairs were counted, false if the old transactions could not be loaded.
+ */
+bool mineIncrementPairs(struct IncrementalMining *mining, struct FrequentItemset *frequentItemsets, uint32_t *supports,
+                        struct LevelStats *levelStats) {
+    size_t numItems = frequentItemsets[0].numberOfItemsets;
+    size_t numPairs = numItems * (numItems - 1) / 2;
+    struct Stopwatch stopwatch;
+    startStopwatch(&stopwatch);
+    bool *counted = calloc(numPairs + 1, sizeof(bool));
+    size_t numCounted = 0;
+    size_t numKnown = 0;
+    uint32_t pair[2];
+    size_t p = 0;
+    for (size_t a = 0; a < numItems; a++) {
+        pair[0] = frequentItemsets[0].itemsets[a].items[0];
+        for (size_t b = a + 1; b < numItems; b++, p++) {
+            pair[1] = frequentItemsets[0].itemsets[b].items[0];
+            uint32_t oldSupport;
+            switch (findOldSupport(mining, pair, 2, supports[p], &oldSupport)) {
+                case OLD_SUPPORT_KNOWN:
+                    supports[p] += oldSupport;
+                    numKnown++;
+                    break;
+                case OLD_SUPPORT_COUNT:
+                    counted[p] = true;
+                    numCounted++;
+                    break;
+                case OLD_SUPPORT_BELOW:
+                    supports[p] = 0;
+                    break;
+            }
+        }
+    }
+    stopStopwatch(&stopwatch, &levelStats->scan);
+
+    if (numCounted > 0) {
+        startStopwatch(&stopwatch);
+        if (!loadHistory(mining)) {
+            free(counted);
+            return false;
+        }
+        // The matrix fits in the memory budget, since the one of the appended transactions did.
+        struct Pass pass;
+        startPass(&pass, &mining->history, &mining->historyActive, NULL);
+        uint32_t *oldSupports = countPairMatrix(&pass, &frequentItemsets[0], mining->options, mining->pool,
+                                                levelStats);
+        for (p = 0; p < numPairs; p++) {
+            if (counted[p]) {
+                supports[p] += oldSupports[p];
+            }
+        }
+        free(oldSupports);
+        levelStats->liveTransactions += mining->historyActive.numTransactions;
+        stopStopwatch(&stopwatch, &levelStats->count);
+    }
+    free(counted);
+    if (mining->options->verbose) {
+        fprintf(stderr, "Level 2: %zu pairs, %zu with a known old support, %zu counted in the old transactions\n",
+                numPairs, numKnown, numCounted);
+    }
+
+    // Add the frequent pairs, and the pairs kept in the new state, in lexicographic order.
+    startStopwatch(&stopwatch);
+    size_t numFrequent = 0;
+    size_t numKept = 0;
+    for (p = 0; p < numPairs; p++) {
+        numFrequent += supports[p] >= mining->minSupport;
+        numKept += supports[p] >= mining->borderSupport;
+    }
+    frequentItemsets[1].numberOfItemsets = numFrequent;
+    frequentItemsets[1].size = 2;
+    frequentItemsets[1].itemsets = calloc(numFrequent, sizeof(struct Itemset));
+    struct FrequentItemset *stateLevel = addStateLevel(mining->newState, 2, numKept);
+    size_t itemsetIndex = 0;
+    p = 0;
+    for (size_t a = 0; a < numItems; a++) {
+        pair[0] = frequentItemsets[0].itemsets[a].items[0];
+        for (size_t b = a + 1; b < numItems; b++, p++) {
+            pair[1] = frequentItemsets[0].itemsets[b].items[0];
+            if (supports[p] >= mining->minSupport) {
+                struct Itemset *itemset = &frequentItemsets[1].itemsets[itemsetIndex];
+                itemset->size = 2;
+                itemset->items = calloc(2, sizeof(uint32_t));
+                memcpy(itemset->items, pair, sizeof(pair));
+                itemset->support = supports[p];
+                itemset->id = (uint32_t) itemsetIndex++;
+            }
+            if (supports[p] >= mining->borderSupport) {
+                addStateItemset(stateLevel, pair, 2, supports[p], mining->itemNames);
+            }
+        }
+    }
+    levelStats->numFrequent = numFrequent;
+    stopStopwatch(&stopwatch, &levelStats->scan);
+    return true;
+}
+
+/**
+ * Finds the frequent itemsets of a level of the old and new transactions, counting the candidates joined from the
+ * previous level with hash trees: in the appended transactions, and in the old ones for the candidates missing from
+ * the state that may have become frequent.
+ * @param mining - The incremental mining.
+ * @param frequentItemsets - The list of frequent itemsets, whose level k + 1 is filled.
+ * @param k - The index of the previous level.
+ * @param levelStats - The statistics of the level.
+ * @return true if the candidates were counted, false if the old transactions could not be loaded.
+ */
+bool mineIncrementLevel(struct IncrementalMining *mining, struct FrequentItemset *frequentItemsets, size_t k,
+                        struct LevelStats *levelStats) {
+    struct Stopwatch stopwatch;
+    startStopwatch(&stopwatch);
+    struct Arena *arena = createArena(ARENA_BLOCK_SIZE);
+    struct Itemset **candidates;
+    struct Generators generators;
+    size_t c = joinCandidates(&frequentItemsets[k], k, mining->minSupport, arena, &candidates, &generators, levelStats);
+    free(generators.firstCandidate);
+    free(generators.secondGenerator);
+    stopStopwatch(&stopwatch, &levelStats->join);
+
+    // Count the candidates in the appended transactions.
+    countCandidates(mining->increment, &mining->incrementActive, candidates, c, k + 2, mining->options, mining->pool,
+                    arena, levelStats);
+
+    // Add the old supports known by the state, and pick the other candidates that may have become frequent.
+    startStopwatch(&stopwatch);
+    uint32_t *incrementSupports = malloc((c + 1) * sizeof(uint32_t)); // The supports of the counted candidates.
+    struct Itemset **counted = malloc((c + 1) * sizeof(struct Itemset *));
+    size_t numCounted = 0;
+    size_t numKnown = 0;
+    for (size_t i = 0; i < c; i++) {
+        uint32_t oldSupport;
+        switch (findOldSupport(mining, candidates[i]->items, k + 2, candidates[i]->support, &oldSupport)) {
+            case OLD_SUPPORT_KNOWN:
+                candidates[i]->support += oldSupport;
+                numKnown++;
+                break;
+            case OLD_SUPPORT_COUNT:
+                candidates[i]->id = (uint32_t) numCounted;
+                incrementSupports[numCounted] = candidates[i]->support;
+                counted[numCounted++] = candidates[i];
+                break;
+            case OLD_SUPPORT_BELOW:
+                candidates[i]->support = 0;
+                break;
+        }
+    }
+    stopStopwatch(&stopwatch, &levelStats->scan);
+
+    bool loaded = true;
+    if (numCounted > 0) {
+        startStopwatch(&stopwatch);
+        loaded = loadHistory(mining);
+        stopStopwatch(&stopwatch, &levelStats->count);
+    }
+    if (numCounted > 0 && loaded) {
+        countCandidates(&mining->history, &mining->historyActive, counted, numCounted, k + 2, mining->options,
+                        mining->pool, arena, levelStats);
+        for (size_t i = 0; i < numCounted; i++) {
+            counted[i]->support += incrementSupports[i];
+        }
+    }
+    free(incrementSupports);
+    free(counted);
+    if (mining->options->verbose) {
+        fprintf(stderr, "Level %zu: %zu candidates, %zu with a known old support, %zu counted in the old "
+                        "transactions\n", k + 2, c, numKnown, numCounted);
+    }
+
+    // Add the frequent candidates, and the candidates kept in the new state, in the order they were generated.
+    startStopwatch(&stopwatch);
+    size_t numFrequent = 0;
+    size_t numKept = 0;
+    for (size_t i = 0; i < c && loaded; i++) {
+        numFrequent += candidates[i]->support >= mining->minSupport;
+        numKept += candidates[i]->support >= mining->borderSupport;
+    }
+    frequentItemsets[k + 1].numberOfItemsets = numFrequent;
+    frequentItemsets[k + 1].size = k + 2;
+    frequentItemsets[k + 1].itemsets = calloc(numFrequent, sizeof(struct Itemset));
+    struct FrequentItemset *stateLevel = addStateLevel(mining->newState, k + 2, numKept);
+    size_t itemsetIndex = 0;
+    for (size_t i = 0; i < c && loaded; i++) {
+        if (candidates[i]->support >= mining->minSupport) {
+            struct Itemset *itemset = &frequentItemsets[k + 1].itemsets[itemsetIndex];
+            itemset->size = k + 2;
+            itemset->items = calloc(k + 2, sizeof(uint32_t));
+            memcpy(itemset->items, candidates[i]->items, (k + 2) * sizeof(uint32_t));
+            itemset->support = candidates[i]->support;
+            itemset->id = (uint32_t) itemsetIndex++;
+        }
+        if (candidates[i]->support >= mining->borderSupport) {
+            addStateItemset(stateLevel, candidates[i]->items, k + 2, candidates[i]->support, mining->itemNames);
+        }
+    }
+    free(candidates);
+    levelStats->bytesAllocated += arenaBytesAllocated(arena);
+    destroyArena(arena);
+    levelStats->numFrequent = numFrequent;
+    stopStopwatch(&stopwatch, &levelStats->scan);
+    return loaded;
+}
+
+/**
+ * Finds the frequent itemsets of size k > 1 of old transactions and of the transactions appended since, from the
+ * state of the run over the old ones, as in FUP (Cheung et al., 1996). The frequent 1-itemsets must already be in
+ * frequentItemsets[0], from the supports of the items in the state and in the increment.
+ * Level by level, the candidates joined from the frequent itemsets of the previous level are counted in the appended
+ * transactions only. The candidates held by the state add their old support to it. Any other candidate had a support
+ * below the old minimum support, so it can only have become frequent if its support in the increment is at least the
+ * new minimum support minus the old one plus one; the few that are are counted in the old transactions, which are only
+ * loaded then. The others are dropped without knowing their support, which is below the new minimum support.
+ * The new state keeps the frequent itemsets and the candidates with at least STATE_BORDER_FRACTION of the minimum
+ * support; every itemset left out of it is thus below the minimum support, as the update of the next run requires.
+ * With an empty state this is Apriori over the increment, without the reduction of the transactions.
+ * @param increment - The appended transactions, recoded.
+ * @param minSupport - The minimum support count of a frequent itemset in all the transactions.
+ * @param frequentItemsets - The list of frequent itemsets to fill.
+ * @param state - The state of the run over the old transactions.
+ * @param newState - The state to add the itemsets of size k > 1 to.
+ * @param itemNames - The item number of each code.
+ * @param itemCodes - The code of each item number, or UINT32_MAX for the infrequent items.
+ * @param numItemCodes - The number of entries in itemCodes.
+ * @param historyFileName - The file of the old transactions, or NULL if the state is empty.
+ * @param order - The order of the codes.
+ * @param options - The settings of the hash trees.
+ * @param pool - The threads to count the candidates with.
+ * @return true if the itemsets were found, false if the old transactions could not be loaded (an error message has
+ *         been printed).
+ */
+bool mineIncrement(struct TransactionDatabase *increment, uint32_t minSupport, struct FrequentItemset *frequentItemsets,
+                   struct MiningState *state, struct MiningState *newState, const uint32_t *itemNames,
+                   const uint32_t *itemCodes, size_t numItemCodes, const char *historyFileName,
+                   enum AprioriItemOrder order, struct HashTreeOptions *options, struct ThreadPool *pool) {
+    struct IncrementalMining mining = {0};
+    mining.increment = increment;
+    mining.state = state;
+    mining.newState = newState;
+    mining.historyFileName = historyFileName;
+    mining.itemNames = itemNames;
+    mining.itemCodes = itemCodes;
+    mining.numItemCodes = numItemCodes;
+    mining.order = order;
+    mining.minSupport = minSupport;
+    mining.borderSupport = (uint32_t) (minSupport * STATE_BORDER_FRACTION);
+    if (mining.borderSupport < 1) {
+        mining.borderSupport = 1;
+    }
+    mining.options = options;
+    mining.pool = pool;
+    initActiveTransactions(&mining.incrementActive, increment);
+
+    // Index the itemsets of size k > 1 of the state by their codes, leaving out those holding an infrequent item,
+    // which cannot be candidates.
+    struct Arena *stateArena = createArena(ARENA_BLOCK_SIZE);
+    mining.stateLevels = calloc(state->numLevels + 1, sizeof(struct Entry *));
+    mining.stateTableSizes = calloc(state->numLevels + 1, sizeof(size_t));
+    for (size_t l = 1; l < state->numLevels; l++) {
+        mining.stateTableSizes[l] = hashTableSizeFor(state->levels[l].numberOfItemsets);
+        mining.stateLevels[l] = create(mining.stateTableSizes[l]);
+        for (size_t i = 0; i < state->levels[l].numberOfItemsets; i++) {
+            struct Itemset *itemset = &state->levels[l].itemsets[i];
+            uint32_t *codes = arenaAlloc(stateArena, (l + 1) * sizeof(uint32_t));
+            if (encodeTransaction(itemset->items, l + 1, itemCodes, numItemCodes, order, codes) == l + 1) {
+                getEntry(mining.stateLevels[l], mining.stateTableSizes[l], codes, l + 1)->value = itemset->support;
+            }
+        }
+    }
+
+    bool mined = true;
+    for (size_t k = 0; frequentItemsets[k].numberOfItemsets > 0 && mined; k++) {
+        struct LevelStats levelStats = {0};
+        levelStats.liveTransactions = mining.incrementActive.numTransactions;
+        uint32_t *supports = NULL;
+        if (k == 0) {
+            // Count the pairs in a triangular matrix when it fits in the memory budget.
+            struct Stopwatch stopwatch;
+            startStopwatch(&stopwatch);
+            struct Pass pass;
+            startPass(&pass, increment, &mining.incrementActive, NULL);
+            supports = countPairMatrix(&pass, &frequentItemsets[0], options, pool, &levelStats);
+            stopStopwatch(&stopwatch, &levelStats.count);
+        }
+        if (supports != NULL) {
+            mined = mineIncrementPairs(&mining, frequentItemsets, supports, &levelStats);
+            free(supports);
+        } else {
+            levelStats.liveTransactions = 0;
+            mined = mineIncrementLevel(&mining, frequentItemsets, k, &levelStats);
+        }
+        if (options->stats != NULL) {
+            *getLevelStats(options->stats, k + 2) = levelStats;
+        }
+    }
+
+    for (size_t l = 1; l < state->numLevels; l++) {
+        delete(mining.stateLevels[l]);
+    }
+    free(mining.stateLevels);
+    free(mining.stateTableSizes);
+    destroyArena(stateArena);
+    free(mining.incrementActive.transactions);
+    free(mining.incrementActive.numMatches);
+    if (mining.historyLoaded) {
+        free(mining.historyActive.transactions);
+        free(mining.historyActive.numMatches);
+        freeTransactions(&mining.history);
+    }
+    return mined;
+}
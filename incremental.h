@@ -0,0 +1,35 @@
+//
+// Incremental mining of appended transactions, as in FUP (Cheung et al., 1996), from the state of the run over the
+// old ones: the supports of the frequent itemsets and of their negative border.
+//
+
+#ifndef APRIORI_INCREMENTAL_H
+#define APRIORI_INCREMENTAL_H
+
+#include <stdbool.h>
+#include "apriori.h"
+#include "hashtree.h"
+#include "threadpool.h"
+
+// Represents the itemsets whose supports are known after a run, in item numbers: the frequent itemsets and their
+// negative border, the infrequent itemsets all of whose subsets are frequent. Any other itemset has a support below
+// minSupport.
+struct MiningState {
+    size_t numTransactions;      // The number of transactions mined so far.
+    size_t maxTransactionLength; // The length of their longest transaction.
+    uint32_t minSupport;         // The minimum support count of the run; 1 if no transaction was mined.
+    struct FrequentItemset *levels; // The itemsets of each size, indexed by their size minus one.
+    size_t numLevels;
+};
+
+bool readMiningState(const char *fileName, struct MiningState *state);
+bool writeMiningState(const char *fileName, const struct MiningState *state);
+size_t mergeItemSupports(const struct MiningState *state, const struct TransactionDatabase *increment,
+                         struct MiningState *newState, uint32_t **itemSupports);
+struct FrequentItemset *addStateLevel(struct MiningState *state, size_t size, size_t numItemsets);
+void freeMiningState(struct MiningState *state);
+bool mineIncrement(struct TransactionDatabase *increment, uint32_t minSupport, struct FrequentItemset *frequentItemsets,
+                   struct MiningState *state, struct MiningState *newState, const uint32_t *itemNames,
+                   const uint32_t *itemCodes, size_t numItemCodes, const char *historyFileName,
+                   enum AprioriItemOrder order, struct HashTreeOptions *options, struct ThreadPool *pool);
+#endif //APRIORI_INCREMENTAL_H
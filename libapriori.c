@@ -0,0 +1,714 @@
+//
+// The mining library: recodes the transactions, finds their frequent itemsets with the selected engine, and generates
+// the strong association rules from them in parallel. Nothing is printed but the progress of verbose runs and the
+// error messages, both to the standard error.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "libapriori.h"
+#include "hashtree.h"
+#include "bitset.h"
+#include "fpgrowth.h"
+#include "loader.h"
+#include "recode.h"
+#include "threadpool.h"
+#include "stream.h"
+#include "partition.h"
+#include "incremental.h"
+#include "sample.h"
+#include "rules.h"
+#include "stats.h"
+
+// The number of candidate rules generated by a single task.
+#define RULE_CHUNK_SIZE 8192
+
+// The quantile of the normal distribution giving the 95% confidence intervals of the supports of approximate runs.
+#define SUPPORT_MARGIN_Z 1.96
+
+// Represents the frequent itemsets found by a run.
+struct AprioriResult {
+    struct FrequentItemset *frequentItemsets; // The itemsets of each size; closed and maximal runs may skip sizes.
+    size_t numLevels;                         // The number of sizes up to the largest itemset.
+    uint32_t *itemNames;                      // The item number of each item code.
+    size_t numTransactions;
+    uint32_t minSupport;
+    double minConfidence;
+    size_t sampledFrom;                       // The transactions an approximate run sampled, or 0 for an exact run.
+    struct ThreadPool *pool;                  // The threads to generate the rules with.
+    struct SupportIndex index;                // The index of the supports, built by the first generation of rules.
+    struct TopRules *top;                     // The best rules, in a top-K run, or NULL.
+};
+
+// Represents a group of frequent itemsets of the same size whose rules are generated by a single task.
+struct RuleChunk {
+    size_t level;
+    size_t firstItemset;
+    size_t lastItemset;
+};
+
+// Represents the generation of the rules of a range of chunks.
+struct RuleJob {
+    struct FrequentItemset *frequentItemsets;
+    struct SupportIndex *index;
+    double minConfidence;
+    struct RuleChunk *chunks;
+    size_t firstChunk;
+    struct RuleList *lists; // The rules of each chunk, or NULL if the rules are only counted.
+    uint32_t *ruleCounts;   // The number of rules of each chunk.
+};
+
+/**
+ * Sets the options of a run to their defaults: the hash tree engine on a single thread, with the shape of the trees
+ * chosen for every level, and a minimum support and confidence of 0.
+ * @param options - The options to set.
+ */
+void aprioriInitOptions(struct AprioriOptions *options) {
+    memset(options, 0, sizeof(struct AprioriOptions));
+    options->engine = APRIORI_ENGINE_HASH_TREE;
+    options->numThreads = 1;
+    options->itemOrder = APRIORI_ITEM_ORDER_ID;
+    options->memoryBudget = DEFAULT_MEMORY_BUDGET;
+    options->partitionDirectory = "/tmp";
+    options->seed = 1;
+}
+
+/**
+ * Checks that the options of a run can be combined.
+ * @param options - The options of the run.
+ * @return true if the options are valid, false otherwise (an error message has been printed).
+ */
+static bool checkOptions(const struct AprioriOptions *options) {
+    if (options->numThreads < 1) {
+        fprintf(stderr, "The number of threads must be at least 1.\n");
+        return false;
+    }
+    if (options->fanout == 1) {
+        fprintf(stderr, "The fanout must be 'auto' or at least 2.\n");
+        return false;
+    }
+    if (options->stream && options->engine != APRIORI_ENGINE_HASH_TREE && options->engine != APRIORI_ENGINE_TRIE) {
+        fprintf(stderr, "The streaming mode only works with the hash tree and trie engines.\n");
+        return false;
+    }
+    if (options->stream && options->numPartitions > 0) {
+        fprintf(stderr, "The streaming mode cannot be combined with partitions.\n");
+        return false;
+    }
+    bool incremental = options->saveStateFileName != NULL || options->updateFileName != NULL;
+    if (options->sampleFraction < 0 || options->sampleFraction > 1) {
+        fprintf(stderr, "The sample must be a fraction of the transactions between 0 and 1.\n");
+        return false;
+    }
+    if (options->sampleFraction > 0 && (options->stream || options->numPartitions > 0 || incremental ||
+                                        options->filter != APRIORI_ITEMSETS_ALL)) {
+        fprintf(stderr, "The sampling mode cannot be combined with streaming, partitions, incremental mining or "
+                        "closed and maximal itemsets.\n");
+        return false;
+    }
+    if (options->approximate && options->sampleFraction == 0) {
+        fprintf(stderr, "The approximate mode needs a sample.\n");
+        return false;
+    }
+    if (incremental && ((options->engine != APRIORI_ENGINE_HASH_TREE && options->engine != APRIORI_ENGINE_TRIE) ||
+                        options->stream || options->numPartitions > 0)) {
+        fprintf(stderr, "The incremental mode only works with the hash tree and trie engines, without streaming or "
+                        "partitions.\n");
+        return false;
+    }
+    if (options->filter != APRIORI_ITEMSETS_ALL && (options->engine != APRIORI_ENGINE_FP_GROWTH || options->stream ||
+                                            options->numPartitions > 0 || incremental)) {
+        fprintf(stderr, "The closed and maximal modes only work with the FP-Growth engine, without streaming, "
+                        "partitions or incremental mining.\n");
+        return false;
+    }
+    if (options->topRules > 0 && options->ranking == APRIORI_RANK_LIFT && options->filter != APRIORI_ITEMSETS_ALL) {
+        fprintf(stderr, "The rules cannot be ranked by lift with closed or maximal itemsets.\n");
+        return false;
+    }
+    if (options->updateFileName != NULL && options->historyFileName == NULL) {
+        fprintf(stderr, "The old transactions of the state must be given with --history.\n");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Gets the name an engine is selected with on the command line.
+ * @param engine - The engine.
+ * @return The name of the engine.
+ */
+static const char *engineName(enum AprioriEngine engine) {
+    switch (engine) {
+        case APRIORI_ENGINE_BITSET:
+            return "bitset";
+        case APRIORI_ENGINE_FP_GROWTH:
+            return "fpgrowth";
+        case APRIORI_ENGINE_TRIE:
+            return "trie";
+        default:
+            return "hashtree";
+    }
+}
+
+/**
+ * Frees a list of frequent itemsets, whatever the engine that found them.
+ * @param frequentItemsets - The list.
+ * @param numLevels - The number of levels of the list, empty ones included.
+ */
+static void freeFrequentItemsets(struct FrequentItemset *frequentItemsets, size_t numLevels) {
+    for (size_t k = 0; k < numLevels; k++) {
+        for (size_t i = 0; i < frequentItemsets[k].numberOfItemsets; i++) {
+            free(frequentItemsets[k].itemsets[i].items);
+        }
+        free(frequentItemsets[k].itemsets);
+    }
+    free(frequentItemsets);
+}
+
+/**
+ * Finds the frequent itemsets of a database. The database and the state are freed whatever the outcome.
+ * @param database - The transactions, loaded or, when streaming, only summarized.
+ * @param fileName - The file the transactions are read from again in every pass when streaming, or NULL.
+ * @param state - The state of the run over the old transactions when updating, otherwise an empty state.
+ * @param options - The options of the run.
+ * @param stats - The statistics to add the times of the phases to.
+ * @return The result, or NULL if the itemsets could not be found (an error message has been printed).
+ */
+static struct AprioriResult *mineDatabase(struct TransactionDatabase *database, const char *fileName,
+                                          struct MiningState *state, const struct AprioriOptions *options,
+                                          struct Stats *stats) {
+    struct Stopwatch stopwatch;
+    bool streaming = options->stream;
+    bool incremental = options->saveStateFileName != NULL || options->updateFileName != NULL;
+    struct MiningState newState = {0};
+    if (incremental && database->itemNumbers != NULL) {
+        // The state is indexed by item number.
+        fprintf(stderr, "The item numbers are too sparse to save or update the state of a run.\n");
+        freeMiningState(state);
+        freeTransactions(database);
+        return NULL;
+    }
+
+    // When updating, the database only holds the transactions appended since the state was saved.
+    size_t numTransactions = state->numTransactions + database->numTransactions;
+
+    // Turn the support percentage into an integer value
+    int minSupport = (int) (options->minSupport * numTransactions + 0.5);
+    // An itemset has to appear at least once to be frequent.
+    if (minSupport < 1) {
+        minSupport = 1;
+    }
+
+    // Drop the infrequent items and number the frequent ones densely; only the results use the item numbers. When
+    // streaming, the transactions are recoded as they are read.
+    size_t numItemsLoaded = streaming ? 0 : database->offsets[database->numTransactions];
+    size_t maxLoadedLength = database->maxTransactionLength;
+    uint32_t *loadedSupports = database->itemSupports;
+    if (incremental) {
+        // The items are coded from their supports in the old transactions and the new ones together.
+        uint32_t *itemSupports;
+        database->maxItemNumber = mergeItemSupports(state, database, &newState, &itemSupports);
+        database->itemSupports = itemSupports;
+    }
+    size_t numDistinctItems = database->maxItemNumber + 1;
+    uint32_t *itemNames;
+    uint32_t *itemCodes = NULL;
+    struct StreamSource source = {fileName, NULL, numDistinctItems, options->itemOrder};
+    struct HashTreeOptions treeOptions = {options->fanout, options->leafSize, options->memoryBudget, options->hybrid,
+                                          options->engine == APRIORI_ENGINE_TRIE, options->verbose, options->stats,
+                                          NULL, NULL, NULL};
+    startStopwatch(&stopwatch);
+    if (streaming) {
+        itemNames = chooseItemCodes(database, (uint32_t) minSupport, options->itemOrder, &itemCodes);
+        source.itemCodes = itemCodes;
+        treeOptions.stream = &source;
+    } else if (incremental) {
+        itemNames = chooseItemCodes(database, (uint32_t) minSupport, options->itemOrder, &itemCodes);
+        applyItemCodes(database, itemCodes, numDistinctItems, options->itemOrder);
+    } else {
+        itemNames = recodeTransactions(database, (uint32_t) minSupport, options->itemOrder);
+    }
+    stopStopwatch(&stopwatch, &stats->recode);
+    if (options->verbose && !streaming) {
+        fprintf(stderr, "Kept %zu of %zu item occurrences\n", database->offsets[database->numTransactions],
+                numItemsLoaded);
+    }
+    size_t maxItemNumber = database->maxItemNumber; // The largest item code.
+    size_t maxItemsOnLine = database->maxTransactionLength;
+    if (incremental && state->maxTransactionLength > maxItemsOnLine) {
+        // The frequent itemsets may come from the old transactions.
+        maxItemsOnLine = state->maxTransactionLength;
+    }
+
+    // Initialize the frequent itemset list, with an empty entry after the largest possible level.
+    size_t numLevels = maxItemsOnLine + 1;
+    struct FrequentItemset *frequentItemsets = calloc(numLevels, sizeof(struct FrequentItemset));
+
+    // Count the number of 1 frequent itemsets, from the supports counted by the loader.
+    size_t numFrequent = 0;
+    for (size_t i = 0; i <= maxItemNumber; i++) {
+        if (database->itemSupports[i] >= (uint32_t) minSupport) {
+            numFrequent++;
+        }
+    }
+    // Add the 1 frequent itemsets to the list.
+    frequentItemsets[0].numberOfItemsets = numFrequent;
+    frequentItemsets[0].size = 1;
+    frequentItemsets[0].itemsets = calloc(numFrequent > 0 ? numFrequent : 1, sizeof(struct Itemset));
+    size_t itemsetIndex = 0;
+    for (uint32_t i = 0; i <= maxItemNumber; i++) {
+        if (database->itemSupports[i] >= (uint32_t) minSupport) {
+            frequentItemsets[0].itemsets[itemsetIndex].size = 1;
+            frequentItemsets[0].itemsets[itemsetIndex].items = calloc(1, sizeof(uint32_t));
+            frequentItemsets[0].itemsets[itemsetIndex].items[0] = i;
+            frequentItemsets[0].itemsets[itemsetIndex].support = database->itemSupports[i];
+            itemsetIndex++;
+        }
+    }
+
+    // Keep the best rules only in a top-K run; the hash tree engine then offers them each level as soon as it is found,
+    // so that ranking by support raises the minimum support of the next levels.
+    struct TopRules *top = NULL;
+    if (options->topRules > 0) {
+        top = createTopRules(options->topRules, options->ranking, options->minConfidence, (uint32_t) minSupport,
+                             numTransactions);
+        if (options->ranking == APRIORI_RANK_SUPPORT && !incremental && options->numPartitions == 0 &&
+            options->sampleFraction == 0) {
+            treeOptions.levelFound = raiseTopRulesSupport;
+            treeOptions.levelContext = top;
+        }
+    }
+
+    struct ThreadPool *pool = createThreadPool(options->numThreads);
+    bool mined = true;
+    startStopwatch(&stopwatch);
+    if (options->sampleFraction > 0) {
+        mineSample(database, (uint32_t) minSupport, frequentItemsets, options->engine, options->sampleFraction,
+                   options->seed, options->approximate, &treeOptions, pool, &stats->sample);
+    } else if (incremental) {
+        mined = mineIncrement(database, (uint32_t) minSupport, frequentItemsets, state, &newState, itemNames,
+                              itemCodes, numDistinctItems, options->historyFileName, options->itemOrder, &treeOptions,
+                              pool);
+    } else if (options->numPartitions > 0) {
+        mined = minePartitions(database, (uint32_t) minSupport, frequentItemsets, options->engine,
+                               options->numPartitions, options->partitionDirectory, &treeOptions, pool);
+    } else if (options->engine == APRIORI_ENGINE_BITSET) {
+        mineBitsets(database, (uint32_t) minSupport, frequentItemsets);
+    } else if (options->engine == APRIORI_ENGINE_FP_GROWTH) {
+        mineFpGrowth(database, (uint32_t) minSupport, frequentItemsets, options->filter);
+    } else {
+        mined = mineHashTree(database, (uint32_t) minSupport, frequentItemsets, &treeOptions, pool);
+    }
+    stopStopwatch(&stopwatch, &stats->mine);
+
+    if (mined && options->saveStateFileName != NULL) {
+        newState.numTransactions = numTransactions;
+        newState.maxTransactionLength = state->maxTransactionLength > maxLoadedLength ? state->maxTransactionLength
+                                                                                      : maxLoadedLength;
+        newState.minSupport = (uint32_t) minSupport;
+        mined = writeMiningState(options->saveStateFileName, &newState);
+    }
+
+    if (mined && options->stats != NULL) {
+        stats->engine = engineName(options->engine);
+        stats->numThreads = options->numThreads;
+        stats->numTransactions = numTransactions;
+        stats->minSupport = (uint32_t) minSupport;
+        // The first pass counts every item; the other engines only report the frequent itemsets of each level.
+        getLevelStats(stats, 1)->candidatesGenerated = numDistinctItems;
+        getLevelStats(stats, 1)->liveTransactions = numTransactions;
+        for (size_t k = 0; k < numLevels; k++) {
+            if (frequentItemsets[k].numberOfItemsets > 0) {
+                getLevelStats(stats, k + 1)->numFrequent = frequentItemsets[k].numberOfItemsets;
+            }
+        }
+    }
+
+    if (incremental) {
+        free(database->itemSupports);
+        database->itemSupports = loadedSupports;
+    }
+    freeMiningState(state);
+    freeMiningState(&newState);
+    freeTransactions(database);
+    free(itemCodes);
+    if (!mined) {
+        freeFrequentItemsets(frequentItemsets, numLevels);
+        freeTopRules(top);
+        free(itemNames);
+        destroyThreadPool(pool);
+        return NULL;
+    }
+
+    struct AprioriResult *result = calloc(1, sizeof(struct AprioriResult));
+    result->frequentItemsets = frequentItemsets;
+    result->numLevels = numLevels;
+    result->itemNames = itemNames;
+    result->numTransactions = numTransactions;
+    result->minSupport = (uint32_t) minSupport;
+    result->minConfidence = options->minConfidence;
+    if (options->approximate) {
+        // The supports are those of the sample.
+        result->sampledFrom = numTransactions;
+        result->numTransactions = stats->sample.sampleSize;
+        result->minSupport = stats->sample.sampleMinSupport;
+        if (top != NULL) {
+            top->numTransactions = result->numTransactions;
+            top->minSupport = result->minSupport;
+        }
+    }
+    result->pool = pool;
+    result->top = top;
+    return result;
+}
+
+/**
+ * Checks the options of a run and reads the state it updates, if any.
+ * @param options - The options of the run.
+ * @param state - Set to the state of the run over the old transactions, or to an empty state.
+ * @return true if the run can start, false otherwise (an error message has been printed).
+ */
+static bool startRun(const struct AprioriOptions *options, struct MiningState *state) {
+    memset(state, 0, sizeof(struct MiningState));
+    state->minSupport = 1;
+    return checkOptions(options) &&
+           (options->updateFileName == NULL || readMiningState(options->updateFileName, state));
+}
+
+/**
+ * Finds the frequent itemsets of transactions held in memory, which are checked and copied first.
+ * @param transactions - The transactions; when updating, only the ones appended since the state was saved.
+ * @param options - The options of the run; it cannot stream.
+ * @return The result, to free with aprioriFreeResult, or NULL if the items of a transaction do not increase or the
+ *         itemsets could not be found (an error message has been printed).
+ */
+struct AprioriResult *aprioriMineTransactions(const struct AprioriTransactions *transactions,
+                                              const struct AprioriOptions *options) {
+    if (options->stream) {
+        fprintf(stderr, "The streaming mode needs a file of transactions.\n");
+        return NULL;
+    }
+    struct Stats unused = {0};
+    struct Stats *stats = options->stats != NULL ? options->stats : &unused;
+    struct MiningState state;
+    if (!startRun(options, &state)) {
+        return NULL;
+    }
+    struct Stopwatch stopwatch;
+    struct TransactionDatabase database;
+    startStopwatch(&stopwatch);
+    if (!copyTransactions(transactions->items, transactions->offsets, transactions->numTransactions, &database)) {
+        freeMiningState(&state);
+        return NULL;
+    }
+    stopStopwatch(&stopwatch, &stats->load);
+    return mineDatabase(&database, NULL, &state, options, stats);
+}
+
+/**
+ * Finds the frequent itemsets of the transactions of a file, in text or in the binary format of apriori_convert.
+ * @param fileName - The file; when updating, it only holds the transactions appended since the state was saved.
+ * @param options - The options of the run.
+ * @return The result, to free with aprioriFreeResult, or NULL if the itemsets could not be found (an error message has
+ *         been printed).
+ */
+struct AprioriResult *aprioriMineFile(const char *fileName, const struct AprioriOptions *options) {
+    struct Stats unused = {0};
+    struct Stats *stats = options->stats != NULL ? options->stats : &unused;
+    struct MiningState state;
+    if (!startRun(options, &state)) {
+        return NULL;
+    }
+
+    // Load the transactions in memory, or only count their items when streaming.
+    struct Stopwatch stopwatch;
+    struct TransactionDatabase database;
+    startStopwatch(&stopwatch);
+    if (!(options->stream ? summarizeTransactions(fileName, &database) : loadTransactions(fileName, &database))) {
+        freeMiningState(&state);
+        return NULL;
+    }
+    stopStopwatch(&stopwatch, &stats->load);
+    if (options->verbose) {
+        double megabytes = (double) database.numBytes / (1024 * 1024);
+        fprintf(stderr, "%s %zu transactions (%.1lf MB) in %.3lf s (%.1lf MB/s)\n",
+                options->stream ? "Counted the items of" : "Loaded", database.numTransactions, megabytes,
+                database.loadSeconds, database.loadSeconds > 0 ? megabytes / database.loadSeconds : 0);
+    }
+    return mineDatabase(&database, fileName, &state, options, stats);
+}
+
+/**
+ * Gets the number of transactions a run mined.
+ * @param result - The result of the run.
+ * @return The number of transactions, including the old ones when updating; in an approximate run, the number of
+ *         transactions sampled, which the supports are counted in.
+ */
+size_t aprioriNumTransactions(const struct AprioriResult *result) {
+    return result->numTransactions;
+}
+
+/**
+ * Gets the minimum support count a run found the frequent itemsets with.
+ * @param result - The result of the run.
+ * @return The minimum support, as a number of transactions.
+ */
+uint32_t aprioriMinSupport(const struct AprioriResult *result) {
+    return result->minSupport;
+}
+
+/**
+ * Gets the number of transactions the sample of an approximate run was drawn from.
+ * @param result - The result of the run.
+ * @return The number of transactions, or 0 if the supports of the run are exact.
+ */
+size_t aprioriSampledFrom(const struct AprioriResult *result) {
+    return result->sampledFrom;
+}
+
+/**
+ * Gets the margin of error of a support found by an approximate run, at a confidence of 95%: the support of the
+ * itemset in all the transactions lies within the margin of its support in the sample, as fractions, 19 times out of
+ * 20. The interval is the normal approximation of the binomial, with the correction for a sample drawn without
+ * replacement.
+ * @param result - The result of the run.
+ * @param support - The support count of an itemset in the sample.
+ * @return The margin, as a fraction of the transactions, or 0 if the supports of the run are exact.
+ */
+double aprioriSupportMargin(const struct AprioriResult *result, uint32_t support) {
+    size_t sampleSize = result->numTransactions;
+    size_t population = result->sampledFrom;
+    if (population <= 1 || sampleSize == 0) {
+        return 0;
+    }
+    double p = (double) support / (double) sampleSize;
+    double correction = (double) (population - sampleSize) / (double) (population - 1);
+    return SUPPORT_MARGIN_Z * sqrt(p * (1 - p) / (double) sampleSize * correction);
+}
+
+/**
+ * Gets the size of the largest itemset found by a run.
+ * @param result - The result of the run.
+ * @return The number of items of the largest itemset, or 0 if there is none.
+ */
+size_t aprioriMaxItemsetSize(const struct AprioriResult *result) {
+    size_t size = result->numLevels;
+    while (size > 0 && result->frequentItemsets[size - 1].numberOfItemsets == 0) {
+        size--;
+    }
+    return size;
+}
+
+/**
+ * Gets the number of itemsets of a size found by a run.
+ * @param result - The result of the run.
+ * @param size - The size of the itemsets, from 1.
+ * @return The number of itemsets of that size; 0 for the sizes past the largest.
+ */
+size_t aprioriNumItemsets(const struct AprioriResult *result, size_t size) {
+    return size > 0 && size <= result->numLevels ? result->frequentItemsets[size - 1].numberOfItemsets : 0;
+}
+
+/**
+ * Sorts the item numbers an itemset or a side of a rule was translated to, which are in the order of their codes.
+ * @param items - The item numbers.
+ * @param numItems - The number of item numbers, a few at most.
+ */
+static void sortItemNumbers(uint32_t *items, size_t numItems) {
+    for (size_t i = 1; i < numItems; i++) {
+        uint32_t item = items[i];
+        size_t j = i;
+        while (j > 0 && items[j - 1] > item) {
+            items[j] = items[j - 1];
+            j--;
+        }
+        items[j] = item;
+    }
+}
+
+/**
+ * Passes every frequent itemset to a callback, from the smallest to the largest, in the order of their codes. A top-K
+ * run ranked by support raises its minimum support as it goes, so only part of its itemsets are found.
+ * @param result - The result of the run.
+ * @param callback - The function to call with every itemset.
+ * @param context - Passed to the callback.
+ */
+void aprioriForEachItemset(const struct AprioriResult *result, AprioriItemsetCallback callback, void *context) {
+    struct FrequentItemset *frequentItemsets = result->frequentItemsets;
+    size_t numLevels = aprioriMaxItemsetSize(result);
+    uint32_t *items = calloc(numLevels + 1, sizeof(uint32_t));
+    for (size_t k = 0; k < numLevels; k++) {
+        for (size_t i = 0; i < frequentItemsets[k].numberOfItemsets; i++) {
+            struct Itemset *itemset = &frequentItemsets[k].itemsets[i];
+            for (size_t j = 0; j <= k; j++) {
+                items[j] = result->itemNames[itemset->items[j]];
+            }
+            sortItemNumbers(items, k + 1);
+            callback(items, k + 1, itemset->support, context);
+        }
+    }
+    free(items);
+}
+
+/**
+ * Splits the frequent itemsets of size k > 1 into chunks of roughly the same number of candidate rules.
+ * @param frequentItemsets - The list of frequent itemsets.
+ * @param numLevels - The number of levels of the list.
+ * @param numChunks - Set to the number of chunks.
+ * @return The chunks, in the order of the frequent itemsets.
+ */
+static struct RuleChunk *createRuleChunks(struct FrequentItemset *frequentItemsets, size_t numLevels,
+                                          size_t *numChunks) {
+    size_t capacity = 64;
+    struct RuleChunk *chunks = malloc(capacity * sizeof(struct RuleChunk));
+    *numChunks = 0;
+    for (size_t k = 1; k < numLevels; k++) {
+        // Every itemset of size k + 1 has 2^(k+1) - 2 candidate rules.
+        size_t itemsetsPerChunk = RULE_CHUNK_SIZE >> (k + 1);
+        if (itemsetsPerChunk == 0) {
+            itemsetsPerChunk = 1;
+        }
+        for (size_t i = 0; i < frequentItemsets[k].numberOfItemsets; i += itemsetsPerChunk) {
+            if (*numChunks == capacity) {
+                capacity *= 2;
+                chunks = realloc(chunks, capacity * sizeof(struct RuleChunk));
+            }
+            chunks[*numChunks].level = k;
+            chunks[*numChunks].firstItemset = i;
+            chunks[*numChunks].lastItemset = i + itemsetsPerChunk < frequentItemsets[k].numberOfItemsets
+                                             ? i + itemsetsPerChunk : frequentItemsets[k].numberOfItemsets;
+            (*numChunks)++;
+        }
+    }
+    return chunks;
+}
+
+/**
+ * Generates the rules of one chunk of frequent itemsets, into the chunk's own list.
+ * @param context - The RuleJob the chunk belongs to.
+ * @param task - The index of the chunk, relative to the first chunk of the job.
+ * @param thread - The index of the running thread.
+ */
+static void generateRuleChunk(void *context, size_t task, int thread) {
+    (void) thread;
+    struct RuleJob *job = context;
+    struct RuleChunk *chunk = &job->chunks[job->firstChunk + task];
+    struct RuleList *rules = job->lists != NULL ? &job->lists[task] : NULL;
+    uint32_t numRules = 0;
+    for (size_t i = chunk->firstItemset; i < chunk->lastItemset; i++) {
+        numRules += generateStrongRules(job->index, &job->frequentItemsets[chunk->level].itemsets[i],
+                                        job->minConfidence, rules);
+    }
+    job->ruleCounts[task] = numRules;
+}
+
+/**
+ * Passes a rule to a callback, with the item numbers of its antecedent and consequence.
+ * @param result - The result of the run.
+ * @param rule - The rule.
+ * @param items - Room for the items of the rule's itemset.
+ * @param callback - The function to call.
+ * @param context - Passed to the callback.
+ */
+static void deliverRule(const struct AprioriResult *result, const struct Rule *rule, uint32_t *items,
+                        AprioriRuleCallback callback, void *context) {
+    const struct Itemset *itemset = rule->itemset;
+    size_t antecedentSize = 0;
+    size_t consequenceSize = 0;
+    uint32_t *consequence = &items[itemset->size];
+    for (size_t k = 0; k < itemset->size; k++) {
+        if (rule->antecedent & (1u << k)) {
+            items[antecedentSize++] = result->itemNames[itemset->items[k]];
+        } else {
+            consequence[consequenceSize++] = result->itemNames[itemset->items[k]];
+        }
+    }
+    sortItemNumbers(items, antecedentSize);
+    sortItemNumbers(consequence, consequenceSize);
+    callback(items, antecedentSize, consequence, consequenceSize, itemset->support, rule->confidence, context);
+}
+
+/**
+ * Generates the strong association rules of the frequent itemsets, and passes them to a callback in the order of the
+ * itemsets they come from. The rules are generated in parallel, a window of chunks at a time, and passed to the
+ * callback from the calling thread, so they come in the same order whatever the number of threads.
+ * @param result - The result of the run.
+ * @param callback - The function to call with every rule, or NULL to only count the rules.
+ * In a top-K run, only the best rules are kept, and they are passed to the callback best first.
+ * @param context - Passed to the callback.
+ * @return The number of strong rules, or of the best ones kept.
+ */
+size_t aprioriForEachRule(struct AprioriResult *result, AprioriRuleCallback callback, void *context) {
+    struct FrequentItemset *frequentItemsets = result->frequentItemsets;
+    struct TopRules *top = result->top;
+    if (top != NULL) {
+        finishTopRules(top, frequentItemsets, result->numLevels);
+        if (callback != NULL) {
+            uint32_t *items = calloc(2 * result->numLevels + 1, sizeof(uint32_t));
+            for (size_t r = 0; r < top->length; r++) {
+                deliverRule(result, &top->heap[r].rule, items, callback, context);
+            }
+            free(items);
+        }
+        return top->length;
+    }
+    if (result->index.tables == NULL) {
+        result->index = createSupportIndex(frequentItemsets, result->numLevels);
+    }
+    size_t numChunks;
+    struct RuleChunk *chunks = createRuleChunks(frequentItemsets, result->numLevels, &numChunks);
+    struct RuleJob job = {frequentItemsets, &result->index, result->minConfidence, chunks, 0, NULL, NULL};
+    size_t numRules = 0;
+    if (callback == NULL) {
+        job.ruleCounts = calloc(numChunks + 1, sizeof(uint32_t));
+        runParallel(result->pool, numChunks, generateRuleChunk, &job);
+        for (size_t i = 0; i < numChunks; i++) {
+            numRules += job.ruleCounts[i];
+        }
+    } else {
+        uint32_t *items = calloc(2 * result->numLevels + 1, sizeof(uint32_t));
+        size_t windowSize = 4 * (size_t) threadPoolSize(result->pool);
+        job.lists = calloc(windowSize, sizeof(struct RuleList));
+        job.ruleCounts = calloc(windowSize, sizeof(uint32_t));
+        for (job.firstChunk = 0; job.firstChunk < numChunks; job.firstChunk += windowSize) {
+            size_t numTasks = numChunks - job.firstChunk < windowSize ? numChunks - job.firstChunk : windowSize;
+            for (size_t i = 0; i < numTasks; i++) {
+                job.lists[i].length = 0;
+            }
+            runParallel(result->pool, numTasks, generateRuleChunk, &job);
+            for (size_t i = 0; i < numTasks; i++) {
+                for (size_t r = 0; r < job.lists[i].length; r++) {
+                    deliverRule(result, &job.lists[i].rules[r], items, callback, context);
+                }
+                numRules += job.lists[i].length;
+            }
+        }
+        for (size_t i = 0; i < windowSize; i++) {
+            free(job.lists[i].rules);
+        }
+        free(job.lists);
+        free(items);
+    }
+    free(job.ruleCounts);
+    free(chunks);
+    return numRules;
+}
+
+/**
+ * Frees the result of a run.
+ * @param result - The result.
+ */
+void aprioriFreeResult(struct AprioriResult *result) {
+    if (result == NULL) {
+        return;
+    }
+    freeSupportIndex(&result->index);
+    freeTopRules(result->top);
+    freeFrequentItemsets(result->frequentItemsets, result->numLevels);
+    free(result->itemNames);
+    destroyThreadPool(result->pool);
+    free(result);
+}
@@ -0,0 +1,111 @@
+//
+// The interface of the mining library: finds the frequent itemsets of transactions held in memory or read from a
+// file, and hands them and the strong association rules over to callbacks, without formatting them. The functions
+// report their errors by their return value, with a message on the standard error, and never end the process.
+//
+
+#ifndef APRIORI_LIBAPRIORI_H
+#define APRIORI_LIBAPRIORI_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// The number of partitions that lets a partitioned run choose it from the size of the transactions and the memory.
+#define APRIORI_AUTO_PARTITIONS SIZE_MAX
+
+// The algorithms that can be used to find the frequent itemsets of size k > 1.
+enum AprioriEngine {
+    APRIORI_ENGINE_HASH_TREE, // Level-wise Apriori counting candidates with a hash tree.
+    APRIORI_ENGINE_TRIE,      // Level-wise Apriori counting candidates with a prefix trie.
+    APRIORI_ENGINE_BITSET,    // Level-wise Apriori counting candidates with vertical transaction id bitsets.
+    APRIORI_ENGINE_FP_GROWTH  // FP-Growth, which grows the itemsets from conditional FP-trees without candidates.
+};
+
+// The frequent itemsets a run reports.
+enum AprioriItemsetFilter {
+    APRIORI_ITEMSETS_ALL,     // Every frequent itemset.
+    APRIORI_ITEMSETS_CLOSED,  // The itemsets none of whose supersets has the same support.
+    APRIORI_ITEMSETS_MAXIMAL  // The itemsets none of whose supersets is frequent.
+};
+
+// The measures the best rules of a run can be ranked by. The ties are broken by the confidence, then by the support,
+// then by the order the rules are generated in.
+enum AprioriRuleRanking {
+    APRIORI_RANK_CONFIDENCE,
+    APRIORI_RANK_LIFT,    // The confidence divided by the fraction of the transactions holding the consequence.
+    APRIORI_RANK_SUPPORT  // The support of the itemset the rule comes from.
+};
+
+// The orders in which the frequent items can be numbered after the first pass.
+enum AprioriItemOrder {
+    APRIORI_ITEM_ORDER_ID,       // Keep the order of the item numbers.
+    APRIORI_ITEM_ORDER_FREQUENCY // From the least to the most frequent item.
+};
+
+// The statistics of a run, filled when AprioriOptions.stats is set; see stats.h.
+struct Stats;
+
+// Represents transactions held by the caller, in compressed sparse row form: the items of transaction t are
+// items[offsets[t]] to items[offsets[t + 1] - 1], in increasing order without repeats; aprioriMineTransactions refuses
+// other transactions.
+struct AprioriTransactions {
+    const uint32_t *items;
+    const size_t *offsets;  // The start of each transaction in items, followed by the end of the last one.
+    size_t numTransactions;
+};
+
+// Represents the settings of a run. The ones after itemOrder are those of the command line options of the same name.
+struct AprioriOptions {
+    double minSupport;        // The fraction of the transactions an itemset has to appear in to be frequent.
+    double minConfidence;     // The fraction of the transactions with its antecedent a rule has to hold in.
+    enum AprioriEngine engine;
+    int numThreads;           // The number of threads counting the candidates and generating the rules.
+    enum AprioriItemOrder itemOrder; // The order of the codes of the frequent items.
+    size_t fanout;            // The fanout of the hash trees, or 0 to choose it for every level.
+    size_t leafSize;          // The number of itemsets a leaf of the hash trees holds, or 0 to choose it.
+    size_t memoryBudget;      // The number of bytes the hash tree of one level should fit in.
+    bool hybrid;
+    bool verbose;             // true to print the progress of the run to the standard error.
+    bool stream;              // true to read the file again in every pass; only with aprioriMineFile.
+    size_t numPartitions;     // The number of partitions mined by worker processes, APRIORI_AUTO_PARTITIONS to choose
+                              // it, or 0 to mine the whole database.
+    const char *partitionDirectory; // Where to create the private directory of the handoff files of the workers.
+    const char *saveStateFileName; // The file to write the state of the run to, or NULL.
+    const char *updateFileName;    // The state of the run over the old transactions, or NULL.
+    const char *historyFileName;   // The old transactions of the state, required with updateFileName.
+    enum AprioriItemsetFilter filter;     // The frequent itemsets to keep; only the FP-Growth engine filters them.
+    size_t topRules;          // The number of best strong rules to keep, or 0 to keep all of them. The itemsets of
+                              // such a run are only those searched for the rules, not every frequent itemset.
+    enum AprioriRuleRanking ranking; // The measure the best rules are ranked by.
+    double sampleFraction;    // The fraction of the transactions to mine a random sample of, or 0 to mine them all.
+    bool approximate;         // true to keep the itemsets of the sample, with their supports in it, without verifying.
+    uint64_t seed;            // The seed of the random sample.
+    struct Stats *stats;      // The statistics to fill, all but the output phase, or NULL.
+};
+
+// Represents the frequent itemsets found by a run.
+struct AprioriResult;
+
+// Receives a frequent itemset; its items are item numbers, in increasing order.
+typedef void (*AprioriItemsetCallback)(const uint32_t *items, size_t size, uint32_t support, void *context);
+
+// Receives a strong association rule, along with the support of the itemset it was generated from; the item numbers
+// of its antecedent and of its consequence are in increasing order.
+typedef void (*AprioriRuleCallback)(const uint32_t *antecedent, size_t antecedentSize, const uint32_t *consequent,
+                                    size_t consequentSize, uint32_t support, double confidence, void *context);
+
+void aprioriInitOptions(struct AprioriOptions *options);
+struct AprioriResult *aprioriMineTransactions(const struct AprioriTransactions *transactions,
+                                              const struct AprioriOptions *options);
+struct AprioriResult *aprioriMineFile(const char *fileName, const struct AprioriOptions *options);
+size_t aprioriNumTransactions(const struct AprioriResult *result);
+uint32_t aprioriMinSupport(const struct AprioriResult *result);
+size_t aprioriSampledFrom(const struct AprioriResult *result);
+double aprioriSupportMargin(const struct AprioriResult *result, uint32_t support);
+size_t aprioriMaxItemsetSize(const struct AprioriResult *result);
+size_t aprioriNumItemsets(const struct AprioriResult *result, size_t size);
+void aprioriForEachItemset(const struct AprioriResult *result, AprioriItemsetCallback callback, void *context);
+size_t aprioriForEachRule(struct AprioriResult *result, AprioriRuleCallback callback, void *context);
+void aprioriFreeResult(struct AprioriResult *result);
+#endif //APRIORI_LIBAPRIORI_H
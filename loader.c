@@ -0,0 +1,701 @@
+//
+// Loads a file of transactions, one transaction per line with its item numbers separated by spaces, in a single pass
+// over a memory mapping of the file. Files written by saveTransactions are recognized by their magic number and used
+// in place, without any parsing, once checked.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "loader.h"
+
+// The first bytes of a binary transaction file.
+static const char BINARY_MAGIC[8] = {'A', 'P', 'R', 'I', 'O', 'R', 'I', 'B'};
+
+// The version of the binary format written by saveTransactions.
+#define BINARY_VERSION 1
+
+// Written in the header to detect files saved on a machine of the other byte order.
+#define BINARY_BYTE_ORDER 0x01020304u
+
+// The header of a binary transaction file. It is followed by the support of every item number (the item dictionary),
+// the offsets of the transactions and their items, each section starting at a multiple of 8 bytes.
+struct BinaryHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t numTransactions;
+    uint64_t numItems;
+    uint64_t maxItemNumber;
+    uint64_t maxTransactionLength;
+    uint64_t supportsStart;    // uint32_t[maxItemNumber + 1]
+    uint64_t offsetsStart;     // uint64_t[numTransactions + 1]
+    uint64_t itemsStart;       // uint32_t[numItems]
+};
+
+/**
+ * Gets the current value of the monotonic clock.
+ * @return The time in seconds.
+ */
+static double now() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double) time.tv_sec + (double) time.tv_nsec / 1e9;
+}
+
+/**
+ * Reads the whole content of a file that cannot be memory mapped (a pipe for example).
+ * @param fd - The file to read.
+ * @param size - Set to the number of bytes read.
+ * @return The content of the file, or NULL if it could not be read or held in memory.
+ */
+static char *readAll(int fd, size_t *size) {
+    size_t capacity = 1 << 20;
+    char *data = malloc(capacity);
+    *size = 0;
+    ssize_t numRead = 0;
+    while (data != NULL && (numRead = read(fd, data + *size, capacity - *size)) > 0) {
+        *size += (size_t) numRead;
+        if (*size == capacity) {
+            capacity *= 2;
+            char *grown = realloc(data, capacity);
+            if (grown == NULL) {
+                free(data);
+            }
+            data = grown;
+        }
+    }
+    if (numRead < 0) {
+        free(data);
+        return NULL;
+    }
+    return data;
+}
+
+/**
+ * Grows an array, doubling its capacity until it holds a number of elements.
+ * @param array - The array, left as it was if it cannot be grown.
+ * @param capacity - The number of elements allocated, updated.
+ * @param needed - The number of elements the array has to hold.
+ * @param elementSize - The size of an element.
+ * @return true if the array holds the elements, false if memory ran out.
+ */
+static bool reserveArray(void **array, size_t *capacity, size_t needed, size_t elementSize) {
+    if (needed <= *capacity) {
+        return true;
+    }
+    size_t newCapacity = *capacity;
+    while (newCapacity < needed) {
+        newCapacity *= 2;
+    }
+    void *grown = realloc(*array, newCapacity * elementSize);
+    if (grown == NULL) {
+        return false;
+    }
+    *array = grown;
+    *capacity = newCapacity;
+    return true;
+}
+
+/**
+ * Compares two items, for use with qsort.
+ */
+static int compareItems(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *) a;
+    uint32_t y = *(const uint32_t *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Sorts the items of a transaction and removes the repeated ones, as the engines expect every transaction to increase.
+ * The items of most files already increase, which is checked first.
+ * @param items - The items of the transaction, rewritten in place.
+ * @param numItems - The number of items.
+ * @return The number of distinct items.
+ */
+size_t normalizeTransaction(uint32_t *items, size_t numItems) {
+    size_t i = 1;
+    while (i < numItems && items[i] > items[i - 1]) {
+        i++;
+    }
+    if (i >= numItems) {
+        return numItems;
+    }
+    qsort(items, numItems, sizeof(uint32_t), compareItems);
+    size_t numDistinct = 1;
+    for (i = 1; i < numItems; i++) {
+        if (items[i] != items[numDistinct - 1]) {
+            items[numDistinct++] = items[i];
+        }
+    }
+    return numDistinct;
+}
+
+/**
+ * Finds the index of an item number in a sorted list of distinct item numbers that holds it.
+ * @param numbers - The item numbers.
+ * @param numNumbers - The number of item numbers.
+ * @param item - The item number to find.
+ * @return Its index.
+ */
+static uint32_t findItemNumber(const uint32_t *numbers, size_t numNumbers, uint32_t item) {
+    size_t low = 0;
+    size_t high = numNumbers;
+    while (high - low > 1) {
+        size_t middle = low + (high - low) / 2;
+        if (numbers[middle] <= item) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return (uint32_t) low;
+}
+
+/**
+ * Counts the supports of the items of a database. When the item numbers are sparse, an array indexed by them would
+ * outgrow the transactions (a single item numbered 2000000000 would take 8 GB), so the items are numbered densely
+ * first, in the order of their item numbers so that every transaction still increases, and itemNumbers keeps the item
+ * number of each of them.
+ * @param database - The database, whose items are item numbers, each transaction increasing.
+ * @return true if the supports were counted, false if memory ran out (an error message has been printed).
+ */
+static bool countItemSupports(struct TransactionDatabase *database) {
+    size_t numItems = database->offsets[database->numTransactions];
+    uint32_t maxItemNumber = 0;
+    for (size_t i = 0; i < numItems; i++) {
+        if (database->items[i] > maxItemNumber) {
+            maxItemNumber = database->items[i];
+        }
+    }
+    if (maxItemNumber < numItems + DENSE_ITEM_SLACK) {
+        database->maxItemNumber = maxItemNumber;
+        database->itemSupports = calloc((size_t) maxItemNumber + 1, sizeof(uint32_t));
+        if (database->itemSupports == NULL) {
+            fprintf(stderr, "Not enough memory to load the transactions.\n");
+            return false;
+        }
+        for (size_t i = 0; i < numItems; i++) {
+            database->itemSupports[database->items[i]] += 1;
+        }
+        return true;
+    }
+
+    uint32_t *numbers = malloc(numItems * sizeof(uint32_t));
+    if (numbers == NULL) {
+        fprintf(stderr, "Not enough memory to load the transactions.\n");
+        return false;
+    }
+    memcpy(numbers, database->items, numItems * sizeof(uint32_t));
+    size_t numDistinct = normalizeTransaction(numbers, numItems);
+    database->itemSupports = calloc(numDistinct, sizeof(uint32_t));
+    if (database->itemSupports == NULL) {
+        fprintf(stderr, "Not enough memory to load the transactions.\n");
+        free(numbers);
+        return false;
+    }
+    for (size_t i = 0; i < numItems; i++) {
+        uint32_t item = findItemNumber(numbers, numDistinct, database->items[i]);
+        database->items[i] = item;
+        database->itemSupports[item] += 1;
+    }
+    uint32_t *shrunk = realloc(numbers, numDistinct * sizeof(uint32_t));
+    database->itemNumbers = shrunk != NULL ? shrunk : numbers;
+    database->maxItemNumber = numDistinct - 1;
+    return true;
+}
+
+/**
+ * Ends the transaction whose items were the last ones added to the database, sorting its items and removing the
+ * repeated ones.
+ * @param database - The database to add the transaction to.
+ * @param capacity - The number of offsets allocated in the database.
+ * @param numItems - The total number of items in the database, including the ones of the ended transaction; updated
+ *                   once the repeated items are removed.
+ * @return true if the transaction was added, false if memory ran out.
+ */
+static bool endTransaction(struct TransactionDatabase *database, size_t *capacity, size_t *numItems) {
+    if (!reserveArray((void **) &database->offsets, capacity, database->numTransactions + 2, sizeof(size_t))) {
+        return false;
+    }
+    size_t start = database->offsets[database->numTransactions];
+    size_t length = normalizeTransaction(&database->items[start], *numItems - start);
+    if (length > database->maxTransactionLength) {
+        database->maxTransactionLength = length;
+    }
+    *numItems = start + length;
+    database->offsets[++database->numTransactions] = *numItems;
+    return true;
+}
+
+/**
+ * Checks whether a character may separate two items of a line of transactions: a space, a tab, or the carriage return
+ * of a line ending in CRLF.
+ * @param c - The character.
+ * @return true if the character is a separator.
+ */
+static inline bool isItemSeparator(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/**
+ * Parses the transactions in a buffer. Every line is a transaction, including empty lines, whose item numbers are
+ * separated by spaces or tabs; any other character is an error. The items of a line may come in any order and
+ * repeat: each transaction is stored sorted, every item once.
+ * @param data - The content of the file.
+ * @param size - The number of bytes in data.
+ * @param database - The database to fill, which is freed if the transactions cannot be parsed.
+ * @return true if the transactions were parsed, false otherwise (an error message has been printed).
+ */
+static bool parseTransactions(const char *data, size_t size, struct TransactionDatabase *database) {
+    size_t capacity = 1024;
+    database->offsets = malloc(capacity * sizeof(size_t));
+    // Every item takes at least two bytes of the file, start from a quarter of that.
+    size_t itemCapacity = size / 8 + 64;
+    database->items = malloc(itemCapacity * sizeof(uint32_t));
+    if (database->offsets == NULL || database->items == NULL) {
+        fprintf(stderr, "Not enough memory to load the transactions.\n");
+        freeTransactions(database);
+        return false;
+    }
+    database->offsets[0] = 0;
+
+    size_t numItems = 0;
+    size_t line = 1;
+    bool allocated = true;
+    const char *p = data;
+    const char *end = data + size;
+    while (p < end && allocated) {
+        char c = *p;
+        if (c >= '0' && c <= '9') {
+            // Read the whole number.
+            uint64_t number = 0;
+            do {
+                number = number * 10 + (uint64_t) (*p - '0');
+                if (number > UINT32_MAX - 1) {
+                    fprintf(stderr, "Item number too large on line %zu.\n", line);
+                    freeTransactions(database);
+                    return false;
+                }
+                p++;
+            } while (p < end && *p >= '0' && *p <= '9');
+
+            allocated = reserveArray((void **) &database->items, &itemCapacity, numItems + 1, sizeof(uint32_t));
+            if (allocated) {
+                database->items[numItems++] = (uint32_t) number;
+            }
+        } else if (c == '\n') {
+            allocated = endTransaction(database, &capacity, &numItems);
+            line++;
+            p++;
+        } else if (isItemSeparator(c)) {
+            p++;
+        } else {
+            fprintf(stderr, "Unexpected character '%c' on line %zu: items must be numbers separated by spaces or "
+                            "tabs.\n", c, line);
+            freeTransactions(database);
+            return false;
+        }
+    }
+    // The last line may not end with a new line.
+    if (allocated && size > 0 && data[size - 1] != '\n') {
+        allocated = endTransaction(database, &capacity, &numItems);
+    }
+    if (!allocated) {
+        fprintf(stderr, "Not enough memory to load the transactions.\n");
+        freeTransactions(database);
+        return false;
+    }
+    // Give back the unused part of the item array.
+    uint32_t *items = realloc(database->items, (numItems > 0 ? numItems : 1) * sizeof(uint32_t));
+    if (items != NULL) {
+        database->items = items;
+    }
+    if (!countItemSupports(database)) {
+        freeTransactions(database);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Rounds a file position up to the next multiple of 8 bytes.
+ * @param position - The position to round.
+ * @return The rounded position.
+ */
+static uint64_t alignSection(uint64_t position) {
+    return (position + 7) & ~(uint64_t) 7;
+}
+
+/**
+ * Checks whether a buffer holds a binary transaction file.
+ * @param data - The content of the file.
+ * @param size - The number of bytes in data.
+ * @return true if the buffer starts with the magic number of the binary format.
+ */
+static bool isBinary(const char *data, size_t size) {
+    return size >= sizeof(BINARY_MAGIC) && memcmp(data, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0;
+}
+
+/**
+ * Checks whether a file is a binary transaction file, from its first bytes.
+ * @param fileName - The name of the file.
+ * @return true if the file starts with the magic number of the binary format.
+ */
+bool isBinaryTransactionFile(const char *fileName) {
+    char magic[sizeof(BINARY_MAGIC)];
+    int fd = open(fileName, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool binary = read(fd, magic, sizeof(magic)) == (ssize_t) sizeof(magic) && isBinary(magic, sizeof(magic));
+    close(fd);
+    return binary;
+}
+
+/**
+ * Checks the sections of a binary transaction file in one pass, so that the offsets and items can be used as array
+ * bounds: the offsets must not decrease, the items of every transaction must increase up to the largest item number,
+ * and the supports and the length of the longest transaction must be those of the transactions.
+ * @param header - The header of the file.
+ * @param offsets - The offsets of the transactions.
+ * @param items - The items of the transactions.
+ * @param supports - The supports of the item numbers.
+ * @return true if the sections are consistent, false otherwise (an error message has been printed).
+ */
+static bool checkBinaryTransactions(const struct BinaryHeader *header, const uint64_t *offsets, const uint32_t *items,
+                                    const uint32_t *supports) {
+    if (offsets[0] != 0 || offsets[header->numTransactions] != header->numItems) {
+        fprintf(stderr, "The binary transaction file is corrupted: the offsets do not span the items.\n");
+        return false;
+    }
+    uint32_t *counts = calloc(header->maxItemNumber + 1, sizeof(uint32_t));
+    if (counts == NULL) {
+        fprintf(stderr, "Not enough memory to check the binary transaction file.\n");
+        return false;
+    }
+    uint64_t maxTransactionLength = 0;
+    bool valid = true;
+    for (uint64_t t = 0; valid && t < header->numTransactions; t++) {
+        if (offsets[t + 1] < offsets[t] || offsets[t + 1] > header->numItems) {
+            fprintf(stderr, "The binary transaction file is corrupted: the offset of transaction %llu is out of "
+                            "order.\n", (unsigned long long) t + 1);
+            valid = false;
+            break;
+        }
+        for (uint64_t i = offsets[t]; i < offsets[t + 1]; i++) {
+            if (items[i] > header->maxItemNumber || (i > offsets[t] && items[i] <= items[i - 1])) {
+                fprintf(stderr, "The binary transaction file is corrupted: the items of transaction %llu are out of "
+                                "range or not increasing.\n", (unsigned long long) t);
+                valid = false;
+                break;
+            }
+            counts[items[i]]++;
+        }
+        if (offsets[t + 1] - offsets[t] > maxTransactionLength) {
+            maxTransactionLength = offsets[t + 1] - offsets[t];
+        }
+    }
+    if (valid && maxTransactionLength != header->maxTransactionLength) {
+        fprintf(stderr, "The binary transaction file is corrupted: the length of the longest transaction is wrong.\n");
+        valid = false;
+    }
+    if (valid && memcmp(counts, supports, (header->maxItemNumber + 1) * sizeof(uint32_t)) != 0) {
+        fprintf(stderr, "The binary transaction file is corrupted: the supports of the items are wrong.\n");
+        valid = false;
+    }
+    free(counts);
+    return valid;
+}
+
+/**
+ * Points a database at the sections of a binary transaction file, which must stay in memory as long as the database.
+ * @param data - The content of the file, aligned on 8 bytes.
+ * @param size - The number of bytes in data.
+ * @param database - The database to fill.
+ * @return true if the file is valid, false otherwise (an error message has been printed).
+ */
+static bool openBinaryTransactions(char *data, size_t size, struct TransactionDatabase *database) {
+    struct BinaryHeader header;
+    if (size < sizeof(header)) {
+        fprintf(stderr, "The binary transaction file is truncated.\n");
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (header.version != BINARY_VERSION || header.byteOrder != BINARY_BYTE_ORDER) {
+        fprintf(stderr, "Unsupported binary transaction file (version %u).\n", header.version);
+        return false;
+    }
+    // Bound the counts first, so that the sizes of the sections cannot overflow.
+    if (header.supportsStart < sizeof(header) || header.maxItemNumber >= UINT32_MAX ||
+        header.numTransactions >= size / sizeof(uint64_t) || header.numItems > size / sizeof(uint32_t) ||
+        header.supportsStart > size || header.offsetsStart > size || header.itemsStart > size ||
+        header.supportsStart + (header.maxItemNumber + 1) * sizeof(uint32_t) > header.offsetsStart ||
+        header.offsetsStart + (header.numTransactions + 1) * sizeof(uint64_t) > header.itemsStart ||
+        header.itemsStart + header.numItems * sizeof(uint32_t) > size) {
+        fprintf(stderr, "The binary transaction file is truncated.\n");
+        return false;
+    }
+    if (header.supportsStart % 8 != 0 || header.offsetsStart % 8 != 0 || header.itemsStart % 8 != 0) {
+        fprintf(stderr, "The binary transaction file is corrupted: its sections are not aligned.\n");
+        return false;
+    }
+    uint64_t *offsets = (uint64_t *) (data + header.offsetsStart);
+    if (!checkBinaryTransactions(&header, offsets, (uint32_t *) (data + header.itemsStart),
+                                 (uint32_t *) (data + header.supportsStart))) {
+        return false;
+    }
+
+    database->numTransactions = (size_t) header.numTransactions;
+    database->maxItemNumber = (size_t) header.maxItemNumber;
+    database->maxTransactionLength = (size_t) header.maxTransactionLength;
+    database->itemSupports = (uint32_t *) (data + header.supportsStart);
+    database->items = (uint32_t *) (data + header.itemsStart);
+    if (sizeof(size_t) == sizeof(uint64_t)) {
+        database->offsets = (size_t *) offsets;
+    } else {
+        database->offsets = malloc((database->numTransactions + 1) * sizeof(size_t));
+        if (database->offsets == NULL) {
+            fprintf(stderr, "Not enough memory to load the transactions.\n");
+            return false;
+        }
+        for (size_t t = 0; t <= database->numTransactions; t++) {
+            database->offsets[t] = (size_t) offsets[t];
+        }
+    }
+    database->fileData = data;
+    return true;
+}
+
+/**
+ * Loads the transactions in the given file, either a text file or a binary file written by saveTransactions.
+ * @param fileName - The name of the file containing the transactions.
+ * @param database - The database to fill.
+ * @return true if the file was loaded, false otherwise (an error message has been printed).
+ */
+bool loadTransactions(const char *fileName, struct TransactionDatabase *database) {
+    double startTime = now();
+    database->items = NULL;
+    database->offsets = NULL;
+    database->numTransactions = 0;
+    database->itemSupports = NULL;
+    database->itemNumbers = NULL;
+    database->maxItemNumber = 0;
+    database->maxTransactionLength = 0;
+    database->fileData = NULL;
+    database->fileMapped = false;
+
+    int fd = open(fileName, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "File '%s' was not found.\n", fileName);
+        return false;
+    }
+
+    struct stat status;
+    size_t size = 0;
+    char *data = NULL;
+    bool mapped = false;
+    if (fstat(fd, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0) {
+        size = (size_t) status.st_size;
+        // Map the file privately writable, so a binary file can be used in place and still modified copy-on-write.
+        data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            mapped = true;
+            madvise(data, size, MADV_SEQUENTIAL);
+        }
+    }
+    if (!mapped) {
+        data = readAll(fd, &size);
+    }
+    close(fd);
+    if (data == NULL) {
+        fprintf(stderr, "File '%s' could not be read.\n", fileName);
+        return false;
+    }
+
+    database->numBytes = size;
+    if (isBinary(data, size)) {
+        // The database points into the file, which is only released by freeTransactions.
+        bool opened = openBinaryTransactions(data, size, database);
+        database->fileMapped = mapped;
+        if (!opened) {
+            database->fileData = data;
+            freeTransactions(database);
+        }
+        database->loadSeconds = now() - startTime;
+        return opened;
+    }
+
+    bool parsed = parseTransactions(data, size, database);
+    if (mapped) {
+        munmap(data, size);
+    } else {
+        free(data);
+    }
+    database->loadSeconds = now() - startTime;
+    return parsed;
+}
+
+/**
+ * Copies transactions held in memory into a database, counting the supports of their items as the parser does.
+ * @param items - The items of all the transactions, each transaction in increasing order without repeats.
+ * @param offsets - The start of each transaction in items, followed by the total number of items.
+ * @param numTransactions - The number of transactions.
+ * @param database - The database to fill.
+ * @return true if the transactions were copied, false if the offsets decrease, the items of a transaction do not
+ *         increase, an item number is too large or memory ran out (an error message has been printed).
+ */
+bool copyTransactions(const uint32_t *items, const size_t *offsets, size_t numTransactions,
+                      struct TransactionDatabase *database) {
+    double startTime = now();
+    memset(database, 0, sizeof(struct TransactionDatabase));
+    for (size_t t = 0; t < numTransactions; t++) {
+        if (offsets[t + 1] < offsets[t]) {
+            fprintf(stderr, "The offset of transaction %zu is smaller than the one of transaction %zu.\n", t + 1, t);
+            return false;
+        }
+        for (size_t i = offsets[t]; i < offsets[t + 1]; i++) {
+            if (i > offsets[t] && items[i] <= items[i - 1]) {
+                fprintf(stderr, "The items of transaction %zu are not in increasing order without repeats.\n", t);
+                return false;
+            }
+            if (items[i] == UINT32_MAX) {
+                fprintf(stderr, "Item number too large: %u.\n", items[i]);
+                return false;
+            }
+        }
+    }
+    size_t numItems = numTransactions > 0 ? offsets[numTransactions] - offsets[0] : 0;
+    database->items = malloc((numItems > 0 ? numItems : 1) * sizeof(uint32_t));
+    database->offsets = malloc((numTransactions + 1) * sizeof(size_t));
+    if (database->items == NULL || database->offsets == NULL) {
+        fprintf(stderr, "Not enough memory to copy the transactions.\n");
+        freeTransactions(database);
+        return false;
+    }
+    database->numTransactions = numTransactions;
+    database->offsets[0] = 0;
+    for (size_t t = 0; t < numTransactions; t++) {
+        size_t length = offsets[t + 1] - offsets[t];
+        memcpy(&database->items[offsets[t] - offsets[0]], &items[offsets[t]], length * sizeof(uint32_t));
+        if (length > database->maxTransactionLength) {
+            database->maxTransactionLength = length;
+        }
+        database->offsets[t + 1] = offsets[t + 1] - offsets[0];
+    }
+    if (!countItemSupports(database)) {
+        freeTransactions(database);
+        return false;
+    }
+    database->numBytes = numItems * sizeof(uint32_t) + (numTransactions + 1) * sizeof(size_t);
+    database->loadSeconds = now() - startTime;
+    return true;
+}
+
+/**
+ * Writes a section of a binary transaction file, preceded by the padding that aligns it.
+ * @param file - The file to write to.
+ * @param position - The current position in the file, updated past the section.
+ * @param start - The position of the section.
+ * @param data - The content of the section.
+ * @param size - The number of bytes in the section.
+ * @return true if the section was written, false otherwise.
+ */
+static bool writeSection(FILE *file, uint64_t *position, uint64_t start, const void *data, size_t size) {
+    static const char padding[8] = {0};
+    if (fwrite(padding, 1, (size_t) (start - *position), file) != start - *position) {
+        return false;
+    }
+    *position = start + size;
+    return size == 0 || fwrite(data, 1, size, file) == size;
+}
+
+/**
+ * Saves a database in the binary format, which loadTransactions maps in place without parsing. Its items must be the
+ * item numbers themselves, not numbered densely by the loader.
+ * @param fileName - The name of the file to write.
+ * @param database - The transactions to save.
+ * @return true if the file was written, false otherwise (an error message has been printed).
+ */
+bool saveTransactions(const char *fileName, const struct TransactionDatabase *database) {
+    if (database->itemNumbers != NULL) {
+        fprintf(stderr, "The item numbers are too sparse for the binary format, whose item supports are indexed by "
+                        "item number.\n");
+        return false;
+    }
+    FILE *file = fopen(fileName, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "File '%s' could not be created.\n", fileName);
+        return false;
+    }
+
+    struct BinaryHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    header.version = BINARY_VERSION;
+    header.byteOrder = BINARY_BYTE_ORDER;
+    header.numTransactions = database->numTransactions;
+    header.numItems = database->offsets[database->numTransactions];
+    header.maxItemNumber = database->maxItemNumber;
+    header.maxTransactionLength = database->maxTransactionLength;
+    header.supportsStart = alignSection(sizeof(header));
+    header.offsetsStart = alignSection(header.supportsStart + (header.maxItemNumber + 1) * sizeof(uint32_t));
+    header.itemsStart = alignSection(header.offsetsStart + (header.numTransactions + 1) * sizeof(uint64_t));
+
+    uint64_t *offsets = malloc((database->numTransactions + 1) * sizeof(uint64_t));
+    if (offsets == NULL) {
+        fprintf(stderr, "Not enough memory to write file '%s'.\n", fileName);
+        fclose(file);
+        return false;
+    }
+    for (size_t t = 0; t <= database->numTransactions; t++) {
+        offsets[t] = database->offsets[t];
+    }
+    uint64_t position = 0;
+    bool written = writeSection(file, &position, 0, &header, sizeof(header)) &&
+                   writeSection(file, &position, header.supportsStart, database->itemSupports,
+                                (database->maxItemNumber + 1) * sizeof(uint32_t)) &&
+                   writeSection(file, &position, header.offsetsStart, offsets,
+                                (database->numTransactions + 1) * sizeof(uint64_t)) &&
+                   writeSection(file, &position, header.itemsStart, database->items,
+                                header.numItems * sizeof(uint32_t));
+    free(offsets);
+    if (fclose(file) != 0 || !written) {
+        fprintf(stderr, "File '%s' could not be written.\n", fileName);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Frees the memory held by a database.
+ * @param database - The database to free.
+ */
+void freeTransactions(struct TransactionDatabase *database) {
+    if (database->fileData != NULL) {
+        if (sizeof(size_t) != sizeof(uint64_t)) {
+            free(database->offsets);
+        }
+        if (database->fileMapped) {
+            munmap(database->fileData, database->numBytes);
+        } else {
+            free(database->fileData);
+        }
+    } else {
+        free(database->items);
+        free(database->offsets);
+        free(database->itemSupports);
+        free(database->itemNumbers);
+    }
+    database->fileData = NULL;
+    database->items = NULL;
+    database->offsets = NULL;
+    database->itemSupports = NULL;
+    database->itemNumbers = NULL;
+}
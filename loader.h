@@ -0,0 +1,22 @@
+//
+// Loader for files of transactions.
+//
+
+#ifndef APRIORI_LOADER_H
+#define APRIORI_LOADER_H
+
+#include <stdbool.h>
+#include "apriori.h"
+
+// The largest item number whose support is counted in an array indexed by item number is the number of item
+// occurrences plus this; the loader numbers sparser items densely first.
+#define DENSE_ITEM_SLACK ((size_t) 1 << 16)
+
+size_t normalizeTransaction(uint32_t *items, size_t numItems);
+bool isBinaryTransactionFile(const char *fileName);
+bool loadTransactions(const char *fileName, struct TransactionDatabase *database);
+bool copyTransactions(const uint32_t *items, const size_t *offsets, size_t numTransactions,
+                      struct TransactionDatabase *database);
+bool saveTransactions(const char *fileName, const struct TransactionDatabase *database);
+void freeTransactions(struct TransactionDatabase *database);
+#endif //APRIORI_LOADER_H
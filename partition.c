@@ -0,0 +1,408 @@
+//
+// The Partition algorithm (Savasere, Omiecinski and Navathe, 1995): the locally frequent itemsets of chunks of the
+// transactions are mined by worker processes and handed back through files, and their union is counted in a single
+// pass with the hash tree engine.
+//
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "partition.h"
+#include "bitset.h"
+#include "fpgrowth.h"
+#include "arena.h"
+
+// The smallest local minimum support of a partition: at 1, a worker finds every subset of its transactions frequent.
+#define PARTITION_MIN_SUPPORT 2
+
+/**
+ * Writes the frequent itemsets of size k > 1 of a partition to its handoff file: for every level, the size of its
+ * itemsets and their number as 64 bit integers, followed by their items.
+ * @param fileName - The file to write.
+ * @param frequentItemsets - The locally frequent itemsets.
+ * @return true if the file was written.
+ */
+static bool writePartitionItemsets(const char *fileName, struct FrequentItemset *frequentItemsets) {
+    FILE *file = fopen(fileName, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "File '%s' could not be created.\n", fileName);
+        return false;
+    }
+    bool written = true;
+    for (size_t k = 1; frequentItemsets[k].numberOfItemsets > 0 && written; k++) {
+        uint64_t header[2] = {k + 1, frequentItemsets[k].numberOfItemsets};
+        written = fwrite(header, sizeof(uint64_t), 2, file) == 2;
+        for (size_t i = 0; i < frequentItemsets[k].numberOfItemsets && written; i++) {
+            written = fwrite(frequentItemsets[k].itemsets[i].items, sizeof(uint32_t), k + 1, file) == k + 1;
+        }
+    }
+    if (fclose(file) != 0 || !written) {
+        fprintf(stderr, "File '%s' could not be written.\n", fileName);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Adds the itemsets of a partition's handoff file to the candidates of every level.
+ * @param fileName - The file to read.
+ * @param candidates - The candidates of each level, indexed by their size minus one, grown as needed.
+ * @param capacities - The number of candidates allocated at each level.
+ * @param maxLevel - The number of levels that can hold candidates; larger itemsets are invalid.
+ * @param maxItem - The largest item code; itemsets must increase up to it.
+ * @param arena - The arena to allocate the candidates from.
+ * @return true if the file was read, false otherwise (an error message has been printed).
+ */
+static bool readPartitionItemsets(const char *fileName, struct FrequentItemset *candidates, size_t *capacities,
+                                  size_t maxLevel, size_t maxItem, struct Arena *arena) {
+    FILE *file = fopen(fileName, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "File '%s' was not found.\n", fileName);
+        return false;
+    }
+    uint64_t header[2];
+    bool valid = true;
+    while (valid && fread(header, sizeof(uint64_t), 2, file) == 2) {
+        if (header[0] < 2 || header[0] > maxLevel) {
+            valid = false;
+            break;
+        }
+        size_t size = (size_t) header[0];
+        struct FrequentItemset *level = &candidates[size - 1];
+        level->size = size;
+        for (uint64_t i = 0; i < header[1] && valid; i++) {
+            if (level->numberOfItemsets == capacities[size - 1]) {
+                size_t capacity = capacities[size - 1] == 0 ? 1024 : capacities[size - 1] * 2;
+                struct Itemset *itemsets = realloc(level->itemsets, capacity * sizeof(struct Itemset));
+                if (itemsets == NULL) {
+                    fprintf(stderr, "Not enough memory to read file '%s'.\n", fileName);
+                    fclose(file);
+                    return false;
+                }
+                level->itemsets = itemsets;
+                capacities[size - 1] = capacity;
+            }
+            struct Itemset *itemset = &level->itemsets[level->numberOfItemsets];
+            itemset->items = arenaAlloc(arena, size * sizeof(uint32_t));
+            itemset->size = size;
+            itemset->support = 0;
+            valid = fread(itemset->items, sizeof(uint32_t), size, file) == size;
+            for (size_t j = 0; j < size && valid; j++) {
+                valid = itemset->items[j] <= maxItem && (j == 0 || itemset->items[j] > itemset->items[j - 1]);
+            }
+            if (valid) {
+                level->numberOfItemsets++;
+            }
+        }
+    }
+    fclose(file);
+    if (!valid) {
+        fprintf(stderr, "File '%s' is corrupted.\n", fileName);
+    }
+    return valid;
+}
+
+/**
+ * Mines the locally frequent itemsets of a range of transactions and writes them to a handoff file. Runs in a worker
+ * process, which has a copy of the whole database.
+ * An itemset frequent in the whole database is frequent in at least one partition at the same relative support, so
+ * the local minimum support is the global one scaled to the partition, rounded up.
+ * @param database - The transactions.
+ * @param first - The first transaction of the partition.
+ * @param last - The transaction following the partition.
+ * @param minSupport - The minimum support count of a frequent itemset in the whole database.
+ * @param engine - The engine mining the partition.
+ * @param options - The settings of the hash tree engine.
+ * @param fileName - The handoff file to write.
+ * @return true if the itemsets were written.
+ */
+static bool minePartition(struct TransactionDatabase *database, size_t first, size_t last, uint32_t minSupport,
+                          enum AprioriEngine engine, struct HashTreeOptions *options, const char *fileName) {
+    struct TransactionDatabase partition = *database;
+    partition.offsets = &database->offsets[first];
+    partition.numTransactions = last - first;
+    partition.maxTransactionLength = 0;
+    partition.itemSupports = calloc(database->maxItemNumber + 1, sizeof(uint32_t));
+    for (size_t t = 0; t < partition.numTransactions; t++) {
+        struct Transaction transaction = getTransaction(&partition, t);
+        for (int i = 0; i < transaction.numItems; i++) {
+            partition.itemSupports[transaction.items[i]]++;
+        }
+        if ((size_t) transaction.numItems > partition.maxTransactionLength) {
+            partition.maxTransactionLength = (size_t) transaction.numItems;
+        }
+    }
+    uint64_t scaledSupport = ((uint64_t) minSupport * partition.numTransactions + database->numTransactions - 1) /
+                             database->numTransactions;
+    uint32_t localSupport = scaledSupport > 0 ? (uint32_t) scaledSupport : 1;
+
+    struct FrequentItemset *frequentItemsets = calloc(partition.maxTransactionLength + 2,
+                                                      sizeof(struct FrequentItemset));
+    frequentItemsets[0].size = 1;
+    frequentItemsets[0].itemsets = calloc(database->maxItemNumber + 1, sizeof(struct Itemset));
+    for (uint32_t i = 0; i <= database->maxItemNumber; i++) {
+        if (partition.itemSupports[i] >= localSupport) {
+            struct Itemset *itemset = &frequentItemsets[0].itemsets[frequentItemsets[0].numberOfItemsets++];
+            itemset->size = 1;
+            itemset->items = calloc(1, sizeof(uint32_t));
+            itemset->items[0] = i;
+            itemset->support = partition.itemSupports[i];
+        }
+    }
+
+    if (engine == APRIORI_ENGINE_BITSET) {
+        mineBitsets(&partition, localSupport, frequentItemsets);
+    } else if (engine == APRIORI_ENGINE_FP_GROWTH) {
+        mineFpGrowth(&partition, localSupport, frequentItemsets, APRIORI_ITEMSETS_ALL);
+    } else {
+        // The threads of the parent's pool do not exist in the worker.
+        struct ThreadPool *pool = createThreadPool(1);
+        struct HashTreeOptions localOptions = *options;
+        localOptions.verbose = false;
+        localOptions.stats = NULL;
+        localOptions.levelFound = NULL;
+        bool mined = mineHashTree(&partition, localSupport, frequentItemsets, &localOptions, pool);
+        destroyThreadPool(pool);
+        if (!mined) {
+            return false;
+        }
+    }
+    return writePartitionItemsets(fileName, frequentItemsets);
+}
+
+/**
+ * Chooses the number of partitions of a partitioned run. Every partition has to keep a local minimum support of at
+ * least PARTITION_MIN_SUPPORT, which bounds their number. An automatic count splits the transactions into partitions
+ * that fit in the memory budget, and into at least as many as there are threads.
+ * @param database - The transactions.
+ * @param minSupport - The minimum support count of a frequent itemset in the whole database.
+ * @param numPartitions - The number of partitions asked for, or APRIORI_AUTO_PARTITIONS to choose it.
+ * @param memoryBudget - The number of bytes the transactions of a partition should fit in.
+ * @param numThreads - The number of worker processes run at a time.
+ * @return The number of partitions, or 0 if too many were asked for (an error message has been printed).
+ */
+static size_t choosePartitions(const struct TransactionDatabase *database, uint32_t minSupport, size_t numPartitions,
+                               size_t memoryBudget, int numThreads) {
+    size_t numTransactions = database->numTransactions;
+    // The smallest partition holds numTransactions / p transactions, rounded down, and its local minimum support
+    // reaches PARTITION_MIN_SUPPORT once it holds more than (PARTITION_MIN_SUPPORT - 1) * numTransactions / minSupport
+    // of them.
+    size_t maxPartitions = 1;
+    if (minSupport >= PARTITION_MIN_SUPPORT && numTransactions > 0) {
+        maxPartitions = numTransactions / (numTransactions * (PARTITION_MIN_SUPPORT - 1) / minSupport + 1);
+        if (maxPartitions < 1) {
+            maxPartitions = 1;
+        }
+    }
+    if (numPartitions != APRIORI_AUTO_PARTITIONS) {
+        if (numPartitions > maxPartitions) {
+            fprintf(stderr, "At most %zu partitions can be mined at this minimum support: smaller partitions would "
+                            "have a local minimum support below %d.\n", maxPartitions, PARTITION_MIN_SUPPORT);
+            return 0;
+        }
+        return numPartitions;
+    }
+    size_t numBytes = database->offsets[numTransactions] * sizeof(uint32_t) + (numTransactions + 1) * sizeof(size_t);
+    numPartitions = (numBytes + memoryBudget - 1) / memoryBudget;
+    if (numPartitions < (size_t) numThreads) {
+        numPartitions = (size_t) numThreads;
+    }
+    return numPartitions < maxPartitions ? numPartitions : maxPartitions;
+}
+
+/**
+ * Finds the frequent itemsets of size k > 1 with the Partition algorithm (Savasere, Omiecinski and Navathe, 1995).
+ * The transactions are split into partitions, whose locally frequent itemsets are mined by worker processes, at most
+ * as many at a time as there are threads, and handed back through files. Their union holds every globally frequent
+ * itemset, and is verified by a single pass over the database that counts the candidates of every level at once.
+ * The frequent 1-itemsets must already be in frequentItemsets[0].
+ * @param database - The transactions.
+ * @param minSupport - The minimum support count of a frequent itemset.
+ * @param frequentItemsets - The list of frequent itemsets to fill.
+ * @param engine - The engine mining the partitions.
+ * @param numPartitions - The number of partitions, or APRIORI_AUTO_PARTITIONS to choose it.
+ * @param directory - The directory of the handoff files.
+ * @param options - The settings of the hash trees.
+ * @param pool - The threads of the final pass; its size bounds the number of worker processes.
+ * @return true if every partition was mined, false otherwise (an error message has been printed).
+ */
+bool minePartitions(struct TransactionDatabase *database, uint32_t minSupport, struct FrequentItemset *frequentItemsets,
+                    enum AprioriEngine engine, size_t numPartitions, const char *directory,
+                    struct HashTreeOptions *options, struct ThreadPool *pool) {
+    size_t numTransactions = database->numTransactions;
+    int maxWorkers = threadPoolSize(pool);
+    numPartitions = choosePartitions(database, minSupport, numPartitions, options->memoryBudget, maxWorkers);
+    if (numPartitions == 0) {
+        return false;
+    }
+    if (options->verbose) {
+        fprintf(stderr, "Mining %zu partition%s\n", numPartitions, numPartitions == 1 ? "" : "s");
+    }
+    // The handoff files go to a directory only this run can write to, so that they cannot be replaced or collide
+    // with the files of another run.
+    size_t length = strlen(directory) + 64;
+    char *handoffDirectory = malloc(length);
+    snprintf(handoffDirectory, length, "%s/apriori-XXXXXX", directory);
+    if (mkdtemp(handoffDirectory) == NULL) {
+        fprintf(stderr, "A directory for the partitions could not be created in '%s'.\n", directory);
+        free(handoffDirectory);
+        return false;
+    }
+    char **fileNames = malloc(numPartitions * sizeof(char *));
+    for (size_t p = 0; p < numPartitions; p++) {
+        fileNames[p] = malloc(length);
+        snprintf(fileNames[p], length, "%s/%zu.part", handoffDirectory, p);
+    }
+
+    // Mine the partitions in worker processes, waiting for each of them by its process id so that the other children
+    // of the process are left alone.
+    fflush(stdout);
+    bool mined = true;
+    pid_t *workers = malloc(numPartitions * sizeof(pid_t));
+    size_t firstRunning = 0;
+    size_t numStarted = 0;
+    for (size_t p = 0; p <= numPartitions; p++) {
+        while (firstRunning < numStarted && (numStarted - firstRunning == (size_t) maxWorkers || p == numPartitions)) {
+            int status;
+            pid_t worker = workers[firstRunning++];
+            if (worker < 0) {
+                continue;
+            }
+            mined = mined && waitpid(worker, &status, 0) == worker && WIFEXITED(status) &&
+                    WEXITSTATUS(status) == EXIT_SUCCESS;
+        }
+        if (p == numPartitions) {
+            break;
+        }
+        pid_t worker = fork();
+        if (worker == 0) {
+            bool written = minePartition(database, numTransactions * p / numPartitions,
+                                         numTransactions * (p + 1) / numPartitions, minSupport, engine, options,
+                                         fileNames[p]);
+            fflush(stdout);
+            _exit(written ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+        if (worker < 0) {
+            fprintf(stderr, "The worker process of partition %zu could not be started.\n", p);
+            mined = false;
+        }
+        workers[numStarted++] = worker;
+    }
+    free(workers);
+
+    // Take the union of the locally frequent itemsets as the candidates.
+    size_t maxLevel = database->maxTransactionLength;
+    struct FrequentItemset *candidates = calloc(maxLevel + 1, sizeof(struct FrequentItemset));
+    size_t *capacities = calloc(maxLevel + 1, sizeof(size_t));
+    struct Arena *arena = createArena(ARENA_BLOCK_SIZE);
+    for (size_t p = 0; p < numPartitions; p++) {
+        mined = mined && readPartitionItemsets(fileNames[p], candidates, capacities, maxLevel,
+                                               database->maxItemNumber, arena);
+        remove(fileNames[p]);
+        free(fileNames[p]);
+    }
+    free(fileNames);
+    rmdir(handoffDirectory);
+    free(handoffDirectory);
+    free(capacities);
+    if (!mined) {
+        fprintf(stderr, "A partition could not be mined.\n");
+    }
+
+    // Sort the candidates of every level and drop the duplicates.
+    struct Itemset ***levelCandidates = calloc(maxLevel + 1, sizeof(struct Itemset **));
+    size_t *numCandidates = calloc(maxLevel + 1, sizeof(size_t));
+    struct LevelStats *levelStats = calloc(maxLevel + 1, sizeof(struct LevelStats));
+    size_t numLevels = 0;
+    for (size_t l = 1; mined && l < maxLevel && candidates[l].numberOfItemsets > 0; l++) {
+        struct Stopwatch stopwatch;
+        startStopwatch(&stopwatch);
+        struct Itemset **sorted = malloc(candidates[l].numberOfItemsets * sizeof(struct Itemset *));
+        for (size_t i = 0; i < candidates[l].numberOfItemsets; i++) {
+            sorted[i] = &candidates[l].itemsets[i];
+        }
+        qsort(sorted, candidates[l].numberOfItemsets, sizeof(struct Itemset *), compareItemsets);
+        size_t n = 0;
+        for (size_t i = 0; i < candidates[l].numberOfItemsets; i++) {
+            if (n == 0 || compareItemsets(&sorted[i], &sorted[n - 1]) != 0) {
+                sorted[i]->id = (uint32_t) n;
+                sorted[n++] = sorted[i];
+            }
+        }
+        levelStats[l].candidatesGenerated = n;
+        stopStopwatch(&stopwatch, &levelStats[l].join);
+        levelCandidates[l] = sorted;
+        numCandidates[l] = n;
+        numLevels = l + 1;
+    }
+    if (options->verbose && mined) {
+        for (size_t l = 1; l < numLevels; l++) {
+            fprintf(stderr, "Level %zu: %zu candidates from %zu partitions\n", l + 1,
+                    levelStats[l].candidatesGenerated, numPartitions);
+        }
+    }
+
+    // Count every candidate in a single pass over the transactions holding at least two items.
+    struct ActiveTransactions active = {0};
+    active.transactions = malloc((numTransactions + 1) * sizeof(size_t));
+    active.numMatches = malloc((numTransactions + 1) * sizeof(uint32_t));
+    for (size_t t = 0; t < numTransactions; t++) {
+        if (database->offsets[t + 1] - database->offsets[t] >= 2) {
+            active.transactions[active.numTransactions++] = t;
+        }
+    }
+    countLevels(database, &active, levelCandidates, numCandidates, numLevels, options, pool, arena, levelStats);
+    free(active.transactions);
+    free(active.numMatches);
+
+    // Keep the candidates that are frequent in the whole database, level by level.
+    bool done = false;
+    for (size_t l = 1; l < numLevels; l++) {
+        struct Stopwatch stopwatch;
+        startStopwatch(&stopwatch);
+        size_t numFrequent = 0;
+        for (size_t i = 0; i < numCandidates[l]; i++) {
+            if (levelCandidates[l][i]->support >= minSupport) {
+                numFrequent++;
+            }
+        }
+        // A level without frequent itemsets ends the list; the larger candidates cannot be frequent either.
+        done = done || numFrequent == 0;
+        if (!done) {
+            frequentItemsets[l].size = l + 1;
+            frequentItemsets[l].numberOfItemsets = numFrequent;
+            frequentItemsets[l].itemsets = calloc(numFrequent, sizeof(struct Itemset));
+            size_t itemsetIndex = 0;
+            for (size_t i = 0; i < numCandidates[l]; i++) {
+                struct Itemset *candidate = levelCandidates[l][i];
+                if (candidate->support >= minSupport) {
+                    struct Itemset *itemset = &frequentItemsets[l].itemsets[itemsetIndex];
+                    itemset->size = l + 1;
+                    itemset->items = calloc(l + 1, sizeof(uint32_t));
+                    memcpy(itemset->items, candidate->items, (l + 1) * sizeof(uint32_t));
+                    itemset->support = candidate->support;
+                    itemset->id = (uint32_t) itemsetIndex++;
+                }
+            }
+        }
+        levelStats[l].numFrequent = done ? 0 : numFrequent;
+        stopStopwatch(&stopwatch, &levelStats[l].scan);
+        if (options->stats != NULL) {
+            *getLevelStats(options->stats, l + 1) = levelStats[l];
+        }
+        free(levelCandidates[l]);
+    }
+    for (size_t l = 0; l <= maxLevel; l++) {
+        free(candidates[l].itemsets);
+    }
+    free(candidates);
+    free(levelCandidates);
+    free(numCandidates);
+    free(levelStats);
+    destroyArena(arena);
+    return mined;
+}
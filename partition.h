@@ -0,0 +1,16 @@
+//
+// The partitioned runs, which mine chunks of the transactions in worker processes.
+//
+
+#ifndef APRIORI_PARTITION_H
+#define APRIORI_PARTITION_H
+
+#include <stdbool.h>
+#include "apriori.h"
+#include "hashtree.h"
+#include "threadpool.h"
+
+bool minePartitions(struct TransactionDatabase *database, uint32_t minSupport, struct FrequentItemset *frequentItemsets,
+                    enum AprioriEngine engine, size_t numPartitions, const char *directory,
+                    struct HashTreeOptions *options, struct ThreadPool *pool);
+#endif //APRIORI_PARTITION_H
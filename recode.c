@@ -0,0 +1,164 @@
+//
+// Recodes a database after the first pass: the items that cannot be part of any frequent itemset are removed from
+// every transaction, and the frequent items are renumbered 0 to F - 1, so every table indexed by item number is sized
+// by the number of frequent items instead of the largest item number in the file.
+//
+
+#include <stdlib.h>
+#include "recode.h"
+
+// Represents a frequent item while its code is chosen.
+struct ItemRank {
+    uint32_t item;
+    uint32_t support;
+};
+
+/**
+ * Compares two items by increasing support, breaking ties by item number, for use with qsort.
+ */
+static int compareBySupport(const void *a, const void *b) {
+    const struct ItemRank *x = a;
+    const struct ItemRank *y = b;
+    if (x->support != y->support) {
+        return x->support < y->support ? -1 : 1;
+    }
+    return (x->item > y->item) - (x->item < y->item);
+}
+
+/**
+ * Sorts the few codes of a transaction in increasing order.
+ * @param codes - The codes to sort.
+ * @param numCodes - The number of codes.
+ */
+static void sortCodes(uint32_t *codes, size_t numCodes) {
+    for (size_t i = 1; i < numCodes; i++) {
+        uint32_t code = codes[i];
+        size_t j = i;
+        while (j > 0 && codes[j - 1] > code) {
+            codes[j] = codes[j - 1];
+            j--;
+        }
+        codes[j] = code;
+    }
+}
+
+/**
+ * Chooses the codes of the frequent items of a database, and makes its supports and maximum item number refer to
+ * codes. The transactions themselves are left untouched.
+ * @param database - The database, whose item supports have been counted.
+ * @param minSupport - The minimum support count of a frequent item.
+ * @param order - APRIORI_ITEM_ORDER_ID to keep the order of the item numbers, APRIORI_ITEM_ORDER_FREQUENCY to number
+ *                the items from the least to the most frequent.
+ * @param itemCodes - Set to the code of each item number up to the former maximum item number, or UINT32_MAX for the
+ *                    infrequent items.
+ * @return The item number of each code, to translate the codes back when printing; the item numbers the loader kept
+ *         for items it numbered densely are used.
+ */
+uint32_t *chooseItemCodes(struct TransactionDatabase *database, uint32_t minSupport, enum AprioriItemOrder order,
+                          uint32_t **itemCodes) {
+    struct ItemRank *ranks = malloc((database->maxItemNumber + 1) * sizeof(struct ItemRank));
+    size_t numCodes = 0;
+    for (size_t i = 0; i <= database->maxItemNumber; i++) {
+        if (database->itemSupports[i] >= minSupport) {
+            ranks[numCodes].item = (uint32_t) i;
+            ranks[numCodes].support = database->itemSupports[i];
+            numCodes++;
+        }
+    }
+    if (order == APRIORI_ITEM_ORDER_FREQUENCY) {
+        qsort(ranks, numCodes, sizeof(struct ItemRank), compareBySupport);
+    }
+
+    uint32_t *itemNames = malloc((numCodes > 0 ? numCodes : 1) * sizeof(uint32_t));
+    *itemCodes = malloc((database->maxItemNumber + 1) * sizeof(uint32_t));
+    for (size_t i = 0; i <= database->maxItemNumber; i++) {
+        (*itemCodes)[i] = UINT32_MAX;
+    }
+    for (size_t c = 0; c < numCodes; c++) {
+        itemNames[c] = database->itemNumbers != NULL ? database->itemNumbers[ranks[c].item] : ranks[c].item;
+        (*itemCodes)[ranks[c].item] = (uint32_t) c;
+    }
+    // The names now translate the codes back to item numbers.
+    free(database->itemNumbers);
+    database->itemNumbers = NULL;
+
+    // The supports of the codes fit in the first entries of the support array.
+    for (size_t c = 0; c < numCodes; c++) {
+        database->itemSupports[c] = ranks[c].support;
+    }
+    if (numCodes == 0) {
+        database->itemSupports[0] = 0;
+    }
+    database->maxItemNumber = numCodes > 0 ? numCodes - 1 : 0;
+    free(ranks);
+    return itemNames;
+}
+
+/**
+ * Translates the items of a transaction to their codes, dropping the infrequent ones.
+ * @param items - The item numbers of the transaction.
+ * @param numItems - The number of items.
+ * @param itemCodes - The code of each item number, or UINT32_MAX for the infrequent items.
+ * @param numItemCodes - The number of entries in itemCodes; larger item numbers are dropped.
+ * @param order - The order the codes were chosen in; the codes are sorted if it is not the order of the items.
+ * @param codes - The array to write the codes to, which may be items itself.
+ * @return The number of codes written.
+ */
+size_t encodeTransaction(const uint32_t *items, size_t numItems, const uint32_t *itemCodes, size_t numItemCodes,
+                         enum AprioriItemOrder order, uint32_t *codes) {
+    size_t numCodes = 0;
+    for (size_t i = 0; i < numItems; i++) {
+        uint32_t code = items[i] < numItemCodes ? itemCodes[items[i]] : UINT32_MAX;
+        if (code != UINT32_MAX) {
+            codes[numCodes++] = code;
+        }
+    }
+    if (order == APRIORI_ITEM_ORDER_FREQUENCY) {
+        sortCodes(codes, numCodes);
+    }
+    return numCodes;
+}
+
+/**
+ * Translates every transaction of a database to codes, dropping the infrequent items, in place.
+ * @param database - The database to recode; its supports and maximum item number are left untouched.
+ * @param itemCodes - The code of each item number, or UINT32_MAX for the infrequent items.
+ * @param numItemCodes - The number of entries in itemCodes; larger item numbers are dropped.
+ * @param order - The order the codes were chosen in.
+ */
+void applyItemCodes(struct TransactionDatabase *database, const uint32_t *itemCodes, size_t numItemCodes,
+                    enum AprioriItemOrder order) {
+    // Rewrite the transactions in place; they can only get shorter, so each one is moved towards the start.
+    size_t numItems = 0;
+    size_t maxTransactionLength = 0;
+    for (size_t t = 0; t < database->numTransactions; t++) {
+        size_t start = numItems;
+        numItems += encodeTransaction(&database->items[database->offsets[t]],
+                                      database->offsets[t + 1] - database->offsets[t], itemCodes, numItemCodes, order,
+                                      &database->items[start]);
+        if (numItems - start > maxTransactionLength) {
+            maxTransactionLength = numItems - start;
+        }
+        database->offsets[t] = start;
+    }
+    database->offsets[database->numTransactions] = numItems;
+    database->maxTransactionLength = maxTransactionLength;
+}
+
+/**
+ * Removes the infrequent items from every transaction of a database and renumbers the frequent items densely, in
+ * place. Afterwards the item numbers of the database, its supports and its maximum item number all refer to codes.
+ * @param database - The database to recode.
+ * @param minSupport - The minimum support count of a frequent item.
+ * @param order - APRIORI_ITEM_ORDER_ID to keep the order of the item numbers, APRIORI_ITEM_ORDER_FREQUENCY to number
+ *                the items from the least to the most frequent.
+ * @return The item number of each code, to translate the codes back when printing.
+ */
+uint32_t *recodeTransactions(struct TransactionDatabase *database, uint32_t minSupport, enum AprioriItemOrder order) {
+    size_t numItemCodes = database->maxItemNumber + 1;
+    uint32_t *itemCodes;
+    uint32_t *itemNames = chooseItemCodes(database, minSupport, order, &itemCodes);
+    applyItemCodes(database, itemCodes, numItemCodes, order);
+    free(itemCodes);
+    return itemNames;
+}
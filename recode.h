@@ -0,0 +1,17 @@
+//
+// Removes the infrequent items from a database and renumbers the frequent ones densely.
+//
+
+#ifndef APRIORI_RECODE_H
+#define APRIORI_RECODE_H
+
+#include "apriori.h"
+
+uint32_t *chooseItemCodes(struct TransactionDatabase *database, uint32_t minSupport, enum AprioriItemOrder order,
+                          uint32_t **itemCodes);
+size_t encodeTransaction(const uint32_t *items, size_t numItems, const uint32_t *itemCodes, size_t numItemCodes,
+                         enum AprioriItemOrder order, uint32_t *codes);
+void applyItemCodes(struct TransactionDatabase *database, const uint32_t *itemCodes, size_t numItemCodes,
+                    enum AprioriItemOrder order);
+uint32_t *recodeTransactions(struct TransactionDatabase *database, uint32_t minSupport, enum AprioriItemOrder order);
+#endif //APRIORI_RECODE_H
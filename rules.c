@@ -0,0 +1,325 @@
+//
+// The generation of the strong association rules of the frequent itemsets, and the selection of the best ones in a
+// top-K run.
+//
+
+#include <stdlib.h>
+#include "rules.h"
+#include "hashtable.h"
+
+/**
+ * Adds the frequent itemsets of the next size to an index of the supports.
+ * @param index - The index.
+ * @param level - The frequent itemsets of size index->numLevels + 1.
+ */
+static void indexLevel(struct SupportIndex *index, struct FrequentItemset *level) {
+    index->tables = realloc(index->tables, (index->numLevels + 1) * sizeof(struct Entry *));
+    index->tableSizes = realloc(index->tableSizes, (index->numLevels + 1) * sizeof(size_t));
+    size_t tableSize = hashTableSizeFor(level->numberOfItemsets);
+    struct Entry *table = create(tableSize);
+    for (size_t i = 0; i < level->numberOfItemsets; i++) {
+        struct Itemset *itemset = &level->itemsets[i];
+        getEntry(table, tableSize, itemset->items, itemset->size)->value = itemset->support;
+    }
+    index->tables[index->numLevels] = table;
+    index->tableSizes[index->numLevels] = tableSize;
+    index->numLevels++;
+}
+
+/**
+ * Indexes every frequent itemset by its items, so that supports can be looked up in constant time.
+ * @param frequentItemsets - The list of frequent itemsets.
+ * @param numLevels - The number of levels of the list.
+ * @return The index; the keys point to the items of the frequent itemsets, which must outlive it.
+ */
+struct SupportIndex createSupportIndex(struct FrequentItemset *frequentItemsets, size_t numLevels) {
+    struct SupportIndex index = {NULL, NULL, 0};
+    for (size_t k = 0; k < numLevels; k++) {
+        indexLevel(&index, &frequentItemsets[k]);
+    }
+    return index;
+}
+
+/**
+ * Frees the tables of an index of the supports.
+ * @param index - The index.
+ */
+void freeSupportIndex(struct SupportIndex *index) {
+    for (size_t k = 0; k < index->numLevels; k++) {
+        delete(index->tables[k]);
+    }
+    free(index->tables);
+    free(index->tableSizes);
+}
+
+/**
+ * Gets the support of a frequent itemset.
+ * @param index - The index of the frequent itemsets.
+ * @param items - The items of the itemset.
+ * @param size - The number of items in the itemset.
+ * @return The support count of the itemset, or 0 if it is not frequent.
+ */
+static uint32_t lookupSupport(struct SupportIndex *index, uint32_t *items, size_t size) {
+    if (size > index->numLevels) {
+        return 0;
+    }
+    struct Entry *entry = findEntry(index->tables[size - 1], index->tableSizes[size - 1], items, size);
+    return entry != NULL ? entry->value : 0;
+}
+
+/**
+ * Generates the strong association rules from the given itemset with the given confidence.
+ * @param index - The index of the support counts of the frequent itemsets.
+ * @param itemset - The itemset for which to generate rules.
+ * @param minConfidence - The minimum confidence of the generated rules.
+ * @param rules - The list to add the generated rules to, or NULL if they should only be counted.
+ * @return The number of strong rules generated.
+ */
+uint32_t generateStrongRules(struct SupportIndex *index, const struct Itemset *itemset, double minConfidence,
+                             struct RuleList *rules) {
+    uint32_t numRules = 0;
+    size_t numSubsets = (size_t) ((1 << itemset->size) - 1); // The number of possible subsets of the given itemset.
+    uint32_t *antecedent = calloc(itemset->size, sizeof(uint32_t));
+
+    // For each of the subsets...
+    for (uint32_t i = 1; i < numSubsets; i++) {
+        // Generate the potential antecedent; the consequence holds the other items.
+        size_t antecedentSize = 0;
+        for (uint32_t k = 0; k < itemset->size; k++) {
+            if (i & (1u << k)) {
+                antecedent[antecedentSize++] = itemset->items[k];
+            }
+        }
+
+        // Get the confidence of the generated rule. Closed runs only keep the rules between closed itemsets.
+        uint32_t antecedentSupport = lookupSupport(index, antecedent, antecedentSize);
+        if (antecedentSupport == 0) {
+            continue;
+        }
+        double confidence = (double) itemset->support / (double) antecedentSupport;
+
+        if (confidence >= minConfidence) {
+            numRules++;
+            if (rules != NULL) {
+                if (rules->length == rules->capacity) {
+                    rules->capacity = rules->capacity == 0 ? 256 : rules->capacity * 2;
+                    rules->rules = realloc(rules->rules, rules->capacity * sizeof(struct Rule));
+                }
+                struct Rule *rule = &rules->rules[rules->length++];
+                rule->itemset = itemset;
+                rule->antecedent = i;
+                rule->confidence = confidence;
+            }
+        }
+    }
+    free(antecedent);
+    return numRules;
+}
+
+/**
+ * Checks whether a kept rule ranks below another one.
+ * @param a - The first rule.
+ * @param b - The second rule.
+ * @return true if a ranks below b.
+ */
+static bool ranksBelow(const struct RankedRule *a, const struct RankedRule *b) {
+    if (a->score != b->score) {
+        return a->score < b->score;
+    }
+    if (a->rule.confidence != b->rule.confidence) {
+        return a->rule.confidence < b->rule.confidence;
+    }
+    if (a->rule.itemset->support != b->rule.itemset->support) {
+        return a->rule.itemset->support < b->rule.itemset->support;
+    }
+    return a->order > b->order;
+}
+
+/**
+ * Compares two kept rules, the best first, for use with qsort.
+ */
+static int compareRankedRules(const void *a, const void *b) {
+    if (ranksBelow(b, a)) {
+        return -1;
+    }
+    return ranksBelow(a, b) ? 1 : 0;
+}
+
+/**
+ * Moves a rule of the heap of the best rules down until it ranks below none of its children.
+ * @param top - The best rules.
+ * @param i - The position of the rule.
+ */
+static void siftDown(struct TopRules *top, size_t i) {
+    struct RankedRule rule = top->heap[i];
+    while (2 * i + 1 < top->length) {
+        size_t child = 2 * i + 1;
+        if (child + 1 < top->length && ranksBelow(&top->heap[child + 1], &top->heap[child])) {
+            child++;
+        }
+        if (!ranksBelow(&top->heap[child], &rule)) {
+            break;
+        }
+        top->heap[i] = top->heap[child];
+        i = child;
+    }
+    top->heap[i] = rule;
+}
+
+/**
+ * Keeps a rule if it is among the best ones generated so far, dropping the worst rule kept if there is no room left.
+ * @param top - The best rules.
+ * @param rule - The rule.
+ */
+static void keepRule(struct TopRules *top, const struct RankedRule *rule) {
+    if (top->length < top->capacity) {
+        if (top->length == top->allocated) {
+            top->allocated = top->allocated == 0 ? 256 : top->allocated * 2;
+            if (top->allocated > top->capacity) {
+                top->allocated = top->capacity;
+            }
+            top->heap = realloc(top->heap, top->allocated * sizeof(struct RankedRule));
+        }
+        // Move the rule up from the new leaf until its parent ranks below it.
+        size_t i = top->length++;
+        while (i > 0 && ranksBelow(rule, &top->heap[(i - 1) / 2])) {
+            top->heap[i] = top->heap[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+        top->heap[i] = *rule;
+    } else if (ranksBelow(&top->heap[0], rule)) {
+        top->heap[0] = *rule;
+        siftDown(top, 0);
+    }
+}
+
+/**
+ * Generates the strong rules of an itemset and keeps the ones among the best so far. Once the heap is full, the worst
+ * rule kept bounds the rules worth generating: the itemsets of a lower support are skipped when ranking by support,
+ * and the minimum confidence is raised when ranking by confidence or lift.
+ * @param top - The best rules, whose index holds every size below the itemset's.
+ * @param itemset - The itemset.
+ */
+static void offerItemsetRules(struct TopRules *top, const struct Itemset *itemset) {
+    double minConfidence = top->minConfidence;
+    if (top->length == top->capacity) {
+        const struct RankedRule *worst = &top->heap[0];
+        double bound = 0;
+        if (top->ranking == APRIORI_RANK_SUPPORT && itemset->support < worst->rule.itemset->support) {
+            return;
+        } else if (top->ranking == APRIORI_RANK_CONFIDENCE) {
+            bound = worst->score;
+        } else if (top->ranking == APRIORI_RANK_LIFT) {
+            // The lift is at most the confidence times numTransactions / minSupport; allow for the rounding.
+            bound = worst->score * top->minSupport / (double) top->numTransactions * (1 - 1e-12);
+        }
+        if (bound > minConfidence) {
+            minConfidence = bound;
+        }
+    }
+    top->rules.length = 0;
+    generateStrongRules(&top->index, itemset, minConfidence, &top->rules);
+    uint32_t *consequence = top->ranking == APRIORI_RANK_LIFT ? calloc(itemset->size, sizeof(uint32_t)) : NULL;
+    for (size_t r = 0; r < top->rules.length; r++) {
+        struct RankedRule ranked = {top->rules.rules[r], top->rules.rules[r].confidence, top->numGenerated++};
+        if (top->ranking == APRIORI_RANK_SUPPORT) {
+            ranked.score = itemset->support;
+        } else if (top->ranking == APRIORI_RANK_LIFT) {
+            size_t consequenceSize = 0;
+            for (uint32_t k = 0; k < itemset->size; k++) {
+                if (!(ranked.rule.antecedent & (1u << k))) {
+                    consequence[consequenceSize++] = itemset->items[k];
+                }
+            }
+            ranked.score = ranked.rule.confidence * (double) top->numTransactions /
+                           (double) lookupSupport(&top->index, consequence, consequenceSize);
+        }
+        keepRule(top, &ranked);
+    }
+    free(consequence);
+}
+
+/**
+ * Offers the rules of the itemsets of a level to the best rules, after indexing the levels below it.
+ * @param top - The best rules.
+ * @param frequentItemsets - The list of frequent itemsets, complete up to the level.
+ * @param level - The index of the level, from 1.
+ */
+static void offerLevelRules(struct TopRules *top, struct FrequentItemset *frequentItemsets, size_t level) {
+    while (top->index.numLevels < level) {
+        indexLevel(&top->index, &frequentItemsets[top->index.numLevels]);
+    }
+    for (size_t i = 0; i < frequentItemsets[level].numberOfItemsets; i++) {
+        offerItemsetRules(top, &frequentItemsets[level].itemsets[i]);
+    }
+    top->numLevelsOffered = level + 1;
+}
+
+/**
+ * Offers the rules of a level of the hash tree engine as soon as it is found, and raises the minimum support of the
+ * next levels to the support of the worst rule kept when the rules are ranked by support: the itemsets below it cannot
+ * give a better rule, nor can their supersets.
+ * @param context - The best rules.
+ * @param frequentItemsets - The list of frequent itemsets.
+ * @param level - The index of the level found.
+ * @return The minimum support count of the next levels, or 0 to keep it.
+ */
+uint32_t raiseTopRulesSupport(void *context, struct FrequentItemset *frequentItemsets, size_t level) {
+    struct TopRules *top = context;
+    offerLevelRules(top, frequentItemsets, level);
+    if (top->ranking == APRIORI_RANK_SUPPORT && top->length == top->capacity) {
+        return top->heap[0].rule.itemset->support;
+    }
+    return 0;
+}
+
+/**
+ * Creates an empty set of best rules.
+ * @param capacity - The number of rules to keep.
+ * @param ranking - The measure the rules are ranked by.
+ * @param minConfidence - The minimum confidence of a strong rule.
+ * @param minSupport - The minimum support count of the frequent itemsets.
+ * @param numTransactions - The number of transactions mined.
+ * @return The best rules, to free with freeTopRules.
+ */
+struct TopRules *createTopRules(size_t capacity, enum AprioriRuleRanking ranking, double minConfidence,
+                                uint32_t minSupport, size_t numTransactions) {
+    struct TopRules *top = calloc(1, sizeof(struct TopRules));
+    top->capacity = capacity;
+    top->ranking = ranking;
+    top->minConfidence = minConfidence;
+    top->minSupport = minSupport;
+    top->numTransactions = numTransactions;
+    return top;
+}
+
+/**
+ * Offers the rules of the levels not offered yet, then sorts the rules kept, the best first. Nothing is offered after.
+ * @param top - The best rules.
+ * @param frequentItemsets - The list of frequent itemsets.
+ * @param numLevels - The number of levels of the list.
+ */
+void finishTopRules(struct TopRules *top, struct FrequentItemset *frequentItemsets, size_t numLevels) {
+    if (top->sorted) {
+        return;
+    }
+    for (size_t level = top->numLevelsOffered > 1 ? top->numLevelsOffered : 1; level < numLevels; level++) {
+        offerLevelRules(top, frequentItemsets, level);
+    }
+    qsort(top->heap, top->length, sizeof(struct RankedRule), compareRankedRules);
+    top->sorted = true;
+}
+
+/**
+ * Frees a set of best rules.
+ * @param top - The best rules, or NULL.
+ */
+void freeTopRules(struct TopRules *top) {
+    if (top == NULL) {
+        return;
+    }
+    freeSupportIndex(&top->index);
+    free(top->rules.rules);
+    free(top->heap);
+    free(top);
+}
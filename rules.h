@@ -0,0 +1,69 @@
+//
+// The generation of the strong association rules of the frequent itemsets, and the selection of the best ones in a
+// top-K run.
+//
+
+#ifndef APRIORI_RULES_H
+#define APRIORI_RULES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "apriori.h"
+
+// Represents an index of the support counts of the frequent itemsets, keyed by their items, with a table per size so
+// that the levels can be indexed as they are found.
+struct SupportIndex {
+    struct Entry **tables;
+    size_t *tableSizes; // The base 2 logarithm of the number of entries in each table.
+    size_t numLevels;   // The number of sizes indexed, from 1.
+};
+
+// Represents a strong rule, by the itemset it was generated from and the subset of its items forming the antecedent.
+struct Rule {
+    const struct Itemset *itemset;
+    uint32_t antecedent; // Bit i is set if the item i of the itemset is in the antecedent.
+    double confidence;
+};
+
+// Represents a growable list of rules.
+struct RuleList {
+    struct Rule *rules;
+    size_t length;
+    size_t capacity;
+};
+
+// Represents a rule kept by a top-K run, with the measure it is ranked by.
+struct RankedRule {
+    struct Rule rule;
+    double score;
+    size_t order; // The number of rules generated before it, which breaks the ties.
+};
+
+// Represents the best strong rules generated so far, in a binary min-heap whose root is the worst of them.
+struct TopRules {
+    struct RankedRule *heap;
+    size_t length;
+    size_t allocated;
+    size_t capacity;           // The number of rules to keep.
+    enum AprioriRuleRanking ranking;
+    double minConfidence;
+    uint32_t minSupport;       // The minimum support count of the run, which bounds the supports of the consequences.
+    size_t numTransactions;
+    size_t numGenerated;       // The number of strong rules generated, kept or not.
+    size_t numLevelsOffered;   // The number of levels whose rules were generated, from 1.
+    struct SupportIndex index; // The supports of the levels below the ones offered.
+    struct RuleList rules;     // The rules of the last itemset offered.
+    bool sorted;               // true once every level was offered and the heap sorted, the best rule first.
+};
+
+struct SupportIndex createSupportIndex(struct FrequentItemset *frequentItemsets, size_t numLevels);
+void freeSupportIndex(struct SupportIndex *index);
+uint32_t generateStrongRules(struct SupportIndex *index, const struct Itemset *itemset, double minConfidence,
+                             struct RuleList *rules);
+struct TopRules *createTopRules(size_t capacity, enum AprioriRuleRanking ranking, double minConfidence,
+                                uint32_t minSupport, size_t numTransactions);
+uint32_t raiseTopRulesSupport(void *context, struct FrequentItemset *frequentItemsets, size_t level);
+void finishTopRules(struct TopRules *top, struct FrequentItemset *frequentItemsets, size_t numLevels);
+void freeTopRules(struct TopRules *top);
+#endif //APRIORI_RULES_H
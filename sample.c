@@ -0,0 +1,363 @@
+//
+// Sampled mining (Toivonen, 1996): the itemsets of a random sample of the transactions, mined at a lowered minimum
+// support, are counted with their negative border in the whole database, which tells whether the sample missed any.
+//
+
+#include <stdio.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "sample.h"
+#include "bitset.h"
+#include "fpgrowth.h"
+#include "loader.h"
+#include "arena.h"
+
+// The number of standard deviations the minimum support of a sample is lowered by below the support expected from the
+// minimum support of the whole database, so that the sample misses an itemset at the minimum support with a
+// probability of about 1%.
+#define SAMPLE_LOWERING 2.33
+
+// The smallest fraction of the expected support the minimum support of a small sample is lowered to: below it, the
+// itemsets of the sample and their border outgrow the passes the lowering could save.
+#define SAMPLE_MIN_SHARE 0.5
+
+/**
+ * Draws a uniformly distributed 64 bit number (splitmix64).
+ * @param state - The state of the generator, advanced.
+ * @return The number.
+ */
+static uint64_t nextRandom(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Draws a uniform random sample of transactions without replacement, keeping their order, by selection sampling
+ * (Knuth's Algorithm S): each transaction is drawn with the probability of the rest of the sample among the rest of
+ * the transactions.
+ * @param database - The transactions.
+ * @param sampleSize - The number of transactions to draw.
+ * @param seed - The seed of the random numbers.
+ * @param sample - Set to the sampled transactions, with their own arrays and item supports.
+ */
+void drawSample(struct TransactionDatabase *database, size_t sampleSize, uint64_t seed,
+                struct TransactionDatabase *sample) {
+    memset(sample, 0, sizeof(struct TransactionDatabase));
+    sample->maxItemNumber = database->maxItemNumber;
+    sample->itemSupports = calloc(database->maxItemNumber + 1, sizeof(uint32_t));
+    sample->offsets = malloc((sampleSize + 1) * sizeof(size_t));
+    size_t capacity = 1024;
+    sample->items = malloc(capacity * sizeof(uint32_t));
+    sample->offsets[0] = 0;
+    uint64_t state = seed;
+    for (size_t t = 0; t < database->numTransactions && sample->numTransactions < sampleSize; t++) {
+        double u = (double) (nextRandom(&state) >> 11) / 9007199254740992.0;
+        if ((double) (database->numTransactions - t) * u >= (double) (sampleSize - sample->numTransactions)) {
+            continue;
+        }
+        struct Transaction transaction = getTransaction(database, t);
+        size_t length = sample->offsets[sample->numTransactions];
+        while (length + (size_t) transaction.numItems > capacity) {
+            capacity *= 2;
+            sample->items = realloc(sample->items, capacity * sizeof(uint32_t));
+        }
+        for (int i = 0; i < transaction.numItems; i++) {
+            sample->items[length + (size_t) i] = transaction.items[i];
+            sample->itemSupports[transaction.items[i]]++;
+        }
+        if ((size_t) transaction.numItems > sample->maxTransactionLength) {
+            sample->maxTransactionLength = (size_t) transaction.numItems;
+        }
+        sample->offsets[++sample->numTransactions] = length + (size_t) transaction.numItems;
+    }
+}
+
+/**
+ * Checks whether a level of frequent itemsets, in lexicographic order, holds an itemset; the itemsets looked up must
+ * come in lexicographic order as well.
+ * @param level - The itemsets of the level.
+ * @param position - The position to start looking from, advanced past the itemsets smaller than the one looked up.
+ * @param itemset - The itemset to look up.
+ * @return true if the level holds the itemset.
+ */
+bool levelHolds(struct FrequentItemset *level, size_t *position, struct Itemset *itemset) {
+    while (*position < level->numberOfItemsets) {
+        struct Itemset *other = &level->itemsets[*position];
+        int order = compareItemsets(&other, &itemset);
+        if (order >= 0) {
+            return order == 0;
+        }
+        (*position)++;
+    }
+    return false;
+}
+
+/**
+ * Finds the frequent itemsets of size k > 1 from a random sample of the transactions (Toivonen, 1996). The sample is
+ * mined with the selected engine at a minimum support lowered below the one expected from the whole database, which
+ * gives a set S of itemsets likely to hold every frequent one. S and its negative border, the itemsets not in S all of
+ * whose subsets are, are then counted in the whole database in a single pass. If no itemset of the border is
+ * frequent, the frequent itemsets of S are exactly those of the database; otherwise the levels above the lowest
+ * frequent border itemset are completed level by level, counting only the candidates that were not counted yet.
+ * In approximate mode, the itemsets frequent in the sample at the scaled minimum support are kept as they are, with
+ * their supports in the sample, and the database is not read again.
+ * The frequent 1-itemsets of the whole database must already be in frequentItemsets[0]; in approximate mode they are
+ * replaced by those of the sample.
+ * @param database - The transactions.
+ * @param minSupport - The minimum support count of a frequent itemset in the whole database.
+ * @param frequentItemsets - The list of frequent itemsets to fill.
+ * @param engine - The engine mining the sample.
+ * @param fraction - The fraction of the transactions to sample.
+ * @param seed - The seed of the random sample.
+ * @param approximate - true to keep the itemsets of the sample without verifying them.
+ * @param options - The settings of the hash trees.
+ * @param pool - The threads to count with.
+ * @param report - Set to the size of the sample and to the outcome of the verification.
+ */
+void mineSample(struct TransactionDatabase *database, uint32_t minSupport, struct FrequentItemset *frequentItemsets,
+                enum AprioriEngine engine, double fraction, uint64_t seed, bool approximate,
+                struct HashTreeOptions *options, struct ThreadPool *pool, struct SampleStats *report) {
+    size_t numTransactions = database->numTransactions;
+    size_t sampleSize = (size_t) ceil(fraction * (double) numTransactions);
+    if (sampleSize < 1) {
+        sampleSize = 1;
+    }
+    if (sampleSize > numTransactions) {
+        sampleSize = numTransactions;
+    }
+    struct TransactionDatabase sample;
+    drawSample(database, sampleSize, seed, &sample);
+
+    // Scale the minimum support to the sample, lowered by the deviation of the support of a sample drawn without
+    // replacement, which vanishes when the sample is all there is to mine. An itemset found in a single transaction of
+    // the sample tells nothing of the others.
+    double p = numTransactions > 0 ? (double) minSupport / (double) numTransactions : 1;
+    double expected = p * (double) sample.numTransactions;
+    double lowered = ceil(expected - 1e-9);
+    if (!approximate && numTransactions > 1) {
+        double correction = (double) (numTransactions - sample.numTransactions) / (double) (numTransactions - 1);
+        lowered = floor(expected - SAMPLE_LOWERING * sqrt(expected * (1 - p) * correction) + 1e-9);
+        if (lowered < floor(expected * SAMPLE_MIN_SHARE)) {
+            lowered = floor(expected * SAMPLE_MIN_SHARE);
+        }
+    }
+    uint32_t sampleSupport = lowered >= 2 ? (uint32_t) lowered : 2;
+    if (minSupport < sampleSupport) {
+        sampleSupport = minSupport > 0 ? minSupport : 1;
+    }
+    memset(report, 0, sizeof(struct SampleStats));
+    report->sampleSize = sample.numTransactions;
+    report->sampleMinSupport = sampleSupport;
+
+    // Mine the frequent items of the database in the sample.
+    struct FrequentItemset *sampleLevels = calloc(sample.maxTransactionLength + 2, sizeof(struct FrequentItemset));
+    sampleLevels[0].size = 1;
+    sampleLevels[0].itemsets = calloc(frequentItemsets[0].numberOfItemsets + 1, sizeof(struct Itemset));
+    for (size_t i = 0; i < frequentItemsets[0].numberOfItemsets; i++) {
+        uint32_t item = frequentItemsets[0].itemsets[i].items[0];
+        if (sample.itemSupports[item] >= sampleSupport) {
+            struct Itemset *itemset = &sampleLevels[0].itemsets[sampleLevels[0].numberOfItemsets];
+            itemset->size = 1;
+            itemset->items = calloc(1, sizeof(uint32_t));
+            itemset->items[0] = item;
+            itemset->support = sample.itemSupports[item];
+            itemset->id = (uint32_t) sampleLevels[0].numberOfItemsets++;
+        }
+    }
+    if (engine == APRIORI_ENGINE_BITSET) {
+        mineBitsets(&sample, sampleSupport, sampleLevels);
+    } else if (engine == APRIORI_ENGINE_FP_GROWTH) {
+        mineFpGrowth(&sample, sampleSupport, sampleLevels, APRIORI_ITEMSETS_ALL);
+    } else {
+        struct HashTreeOptions localOptions = *options;
+        localOptions.verbose = false;
+        localOptions.stats = NULL;
+        localOptions.levelFound = NULL;
+        // The sample is held in memory, so no pass over it can fail.
+        mineHashTree(&sample, sampleSupport, sampleLevels, &localOptions, pool);
+    }
+    for (size_t l = 1; sampleLevels[l].numberOfItemsets > 0; l++) {
+        report->numSampleItemsets += sampleLevels[l].numberOfItemsets;
+    }
+
+    size_t numLevels = 0; // The number of levels of the sample handed over or counted.
+    if (approximate) {
+        // Hand the levels of the sample over, the frequent items included.
+        for (size_t i = 0; i < frequentItemsets[0].numberOfItemsets; i++) {
+            free(frequentItemsets[0].itemsets[i].items);
+        }
+        free(frequentItemsets[0].itemsets);
+        for (; numLevels == 0 || sampleLevels[numLevels].numberOfItemsets > 0; numLevels++) {
+            frequentItemsets[numLevels] = sampleLevels[numLevels];
+        }
+        if (options->verbose) {
+            fprintf(stderr, "Sampled %zu of %zu transactions, mined at a support of %u: %zu itemsets of size k > 1, "
+                            "with their supports in the sample\n", sample.numTransactions, numTransactions,
+                    sampleSupport, report->numSampleItemsets);
+        }
+    } else {
+        // The candidates of level l are the itemsets of S of size l + 1 and their negative border, joined from the
+        // itemsets of S of size l; the frequent items of the database stand for those of S.
+        size_t maxLevel = database->maxTransactionLength;
+        struct Itemset ***levelCandidates = calloc(maxLevel + 1, sizeof(struct Itemset **));
+        size_t *numCandidates = calloc(maxLevel + 1, sizeof(size_t));
+        struct LevelStats *levelStats = calloc(maxLevel + 1, sizeof(struct LevelStats));
+        struct Arena *arena = createArena(ARENA_BLOCK_SIZE);
+        for (size_t l = 1; l < maxLevel; l++) {
+            struct FrequentItemset *previous = l == 1 ? &frequentItemsets[0] : &sampleLevels[l - 1];
+            if (previous->numberOfItemsets == 0) {
+                break;
+            }
+            struct Stopwatch stopwatch;
+            startStopwatch(&stopwatch);
+            struct Generators generators;
+            numCandidates[l] = joinCandidates(previous, l - 1, 0, arena, &levelCandidates[l], &generators,
+                                              &levelStats[l]);
+            free(generators.firstCandidate);
+            free(generators.secondGenerator);
+            stopStopwatch(&stopwatch, &levelStats[l].join);
+            report->numBorder += numCandidates[l] - sampleLevels[l].numberOfItemsets;
+            numLevels = l + 1;
+        }
+
+        // Count S and its border in a single pass, and keep the frequent itemsets, noting the border ones.
+        struct ActiveTransactions active;
+        initActiveTransactions(&active, database);
+        if (numLevels > 0) {
+            countLevels(database, &active, levelCandidates, numCandidates, numLevels, options, pool, arena,
+                        levelStats);
+        }
+        size_t firstMissed = 0; // The lowest level with a frequent itemset of the border.
+        for (size_t l = 1; l < numLevels; l++) {
+            size_t numFrequent = 0;
+            for (size_t i = 0; i < numCandidates[l]; i++) {
+                numFrequent += levelCandidates[l][i]->support >= minSupport;
+            }
+            if (numFrequent == 0) {
+                continue;
+            }
+            frequentItemsets[l].size = l + 1;
+            frequentItemsets[l].numberOfItemsets = numFrequent;
+            frequentItemsets[l].itemsets = calloc(numFrequent, sizeof(struct Itemset));
+            size_t itemsetIndex = 0;
+            size_t position = 0;
+            for (size_t i = 0; i < numCandidates[l]; i++) {
+                struct Itemset *candidate = levelCandidates[l][i];
+                if (candidate->support < minSupport) {
+                    continue;
+                }
+                if (!levelHolds(&sampleLevels[l], &position, candidate)) {
+                    report->numBorderFrequent++;
+                    firstMissed = firstMissed == 0 ? l : firstMissed;
+                }
+                struct Itemset *itemset = &frequentItemsets[l].itemsets[itemsetIndex];
+                itemset->size = l + 1;
+                itemset->items = calloc(l + 1, sizeof(uint32_t));
+                memcpy(itemset->items, candidate->items, (l + 1) * sizeof(uint32_t));
+                itemset->support = candidate->support;
+                itemset->id = (uint32_t) itemsetIndex++;
+            }
+        }
+
+        // The supersets of the border itemsets found frequent were not counted: join them level by level from the
+        // frequent itemsets, and count the candidates that were not counted yet, a pass per level.
+        for (size_t l = firstMissed + 1; firstMissed > 0 && l < maxLevel &&
+                                         frequentItemsets[l - 1].numberOfItemsets > 0; l++) {
+            struct Itemset **joined;
+            struct Generators generators;
+            size_t numJoined = joinCandidates(&frequentItemsets[l - 1], l - 1, minSupport, arena, &joined,
+                                              &generators, &levelStats[l]);
+            free(generators.firstCandidate);
+            free(generators.secondGenerator);
+            size_t numNew = 0;
+            size_t numCounted = l < numLevels ? numCandidates[l] : 0;
+            size_t c = 0;
+            for (size_t i = 0; i < numJoined; i++) {
+                while (c < numCounted && compareItemsets(&levelCandidates[l][c], &joined[i]) < 0) {
+                    c++;
+                }
+                if (c == numCounted || compareItemsets(&levelCandidates[l][c], &joined[i]) != 0) {
+                    joined[i]->id = (uint32_t) numNew;
+                    joined[numNew++] = joined[i];
+                }
+            }
+            if (numNew > 0) {
+                countCandidates(database, &active, joined, numNew, l + 1, options, pool, arena, &levelStats[l]);
+                report->numExtraPasses++;
+            }
+
+            // Merge the new frequent itemsets into the level; both are in lexicographic order.
+            struct FrequentItemset *level = &frequentItemsets[l];
+            size_t numFrequent = level->numberOfItemsets;
+            for (size_t i = 0; i < numNew; i++) {
+                numFrequent += joined[i]->support >= minSupport;
+            }
+            struct Itemset *itemsets = calloc(numFrequent + 1, sizeof(struct Itemset));
+            size_t old = 0;
+            size_t added = 0;
+            for (size_t i = 0; i < numFrequent; i++) {
+                while (added < numNew && joined[added]->support < minSupport) {
+                    added++;
+                }
+                struct Itemset *oldItemset = old < level->numberOfItemsets ? &level->itemsets[old] : NULL;
+                if (oldItemset != NULL && (added == numNew || compareItemsets(&oldItemset, &joined[added]) < 0)) {
+                    itemsets[i] = *oldItemset;
+                    old++;
+                } else {
+                    itemsets[i] = *joined[added++];
+                    itemsets[i].items = calloc(l + 1, sizeof(uint32_t));
+                    memcpy(itemsets[i].items, joined[added - 1]->items, (l + 1) * sizeof(uint32_t));
+                }
+                itemsets[i].id = (uint32_t) i;
+            }
+            free(joined);
+            free(level->itemsets);
+            level->itemsets = itemsets;
+            level->numberOfItemsets = numFrequent;
+            level->size = l + 1;
+        }
+
+        for (size_t l = 1; l < maxLevel && (l < numLevels || frequentItemsets[l].numberOfItemsets > 0); l++) {
+            levelStats[l].numFrequent = frequentItemsets[l].numberOfItemsets;
+            if (options->stats != NULL) {
+                *getLevelStats(options->stats, l + 1) = levelStats[l];
+            }
+        }
+        if (options->verbose) {
+            fprintf(stderr, "Sampled %zu of %zu transactions, mined at a support of %u: %zu itemsets of size k > 1 "
+                            "and %zu in their negative border\n", sample.numTransactions, numTransactions,
+                    sampleSupport, report->numSampleItemsets, report->numBorder);
+            if (report->numBorderFrequent > 0) {
+                fprintf(stderr, "%zu itemsets of the negative border are frequent: %zu more pass%s\n",
+                        report->numBorderFrequent, report->numExtraPasses, report->numExtraPasses == 1 ? "" : "es");
+            } else {
+                fprintf(stderr, "No itemset of the negative border is frequent: the sample missed no frequent "
+                                "itemset\n");
+            }
+        }
+        for (size_t l = 1; l < numLevels; l++) {
+            free(levelCandidates[l]);
+        }
+        free(levelCandidates);
+        free(numCandidates);
+        free(levelStats);
+        free(active.transactions);
+        free(active.numMatches);
+        destroyArena(arena);
+    }
+
+    // Free the levels of the sample that were not handed over.
+    for (size_t l = approximate ? numLevels : 0; l <= sample.maxTransactionLength + 1; l++) {
+        for (size_t i = 0; i < sampleLevels[l].numberOfItemsets; i++) {
+            free(sampleLevels[l].itemsets[i].items);
+        }
+        free(sampleLevels[l].itemsets);
+    }
+    free(sampleLevels);
+    freeTransactions(&sample);
+}
@@ -0,0 +1,17 @@
+//
+// The sampled runs, which mine a random sample of the transactions and verify its itemsets in the whole database.
+//
+
+#ifndef APRIORI_SAMPLE_H
+#define APRIORI_SAMPLE_H
+
+#include <stdbool.h>
+#include "apriori.h"
+#include "hashtree.h"
+#include "threadpool.h"
+#include "stats.h"
+
+void mineSample(struct TransactionDatabase *database, uint32_t minSupport, struct FrequentItemset *frequentItemsets,
+                enum AprioriEngine engine, double fraction, uint64_t seed, bool approximate,
+                struct HashTreeOptions *options, struct ThreadPool *pool, struct SampleStats *report);
+#endif //APRIORI_SAMPLE_H
@@ -0,0 +1,131 @@
+//
+// Statistics of a run. The phases are timed with the monotonic clock and the processor time of the whole process,
+// so the CPU time of a parallel phase is the sum over its threads.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "stats.h"
+
+/**
+ * Reads a clock.
+ * @param clock - The clock to read.
+ * @return The time in seconds.
+ */
+static double readClock(clockid_t clock) {
+    struct timespec time;
+    clock_gettime(clock, &time);
+    return (double) time.tv_sec + (double) time.tv_nsec / 1e9;
+}
+
+/**
+ * Starts measuring a phase.
+ * @param stopwatch - The stopwatch to start.
+ */
+void startStopwatch(struct Stopwatch *stopwatch) {
+    stopwatch->wallStart = readClock(CLOCK_MONOTONIC);
+    stopwatch->cpuStart = readClock(CLOCK_PROCESS_CPUTIME_ID);
+}
+
+/**
+ * Adds the time elapsed since a stopwatch was started to a phase.
+ * @param stopwatch - The stopwatch.
+ * @param phase - The phase to add the time to.
+ */
+void stopStopwatch(struct Stopwatch *stopwatch, struct PhaseTime *phase) {
+    phase->wallSeconds += readClock(CLOCK_MONOTONIC) - stopwatch->wallStart;
+    phase->cpuSeconds += readClock(CLOCK_PROCESS_CPUTIME_ID) - stopwatch->cpuStart;
+}
+
+/**
+ * Gets the statistics of the itemsets of a size, adding the levels up to it if needed.
+ * @param stats - The statistics of the run.
+ * @param size - The size of the itemsets, from 1.
+ * @return The statistics of the level.
+ */
+struct LevelStats *getLevelStats(struct Stats *stats, size_t size) {
+    if (size > stats->numLevels) {
+        stats->levels = realloc(stats->levels, size * sizeof(struct LevelStats));
+        memset(&stats->levels[stats->numLevels], 0, (size - stats->numLevels) * sizeof(struct LevelStats));
+        stats->numLevels = size;
+    }
+    return &stats->levels[size - 1];
+}
+
+/**
+ * Writes the time of a phase as a JSON object.
+ * @param file - The file to write to.
+ * @param name - The name of the phase.
+ * @param phase - The time of the phase.
+ * @param last - true if no member follows the phase in the enclosing object.
+ */
+static void writePhase(FILE *file, const char *name, struct PhaseTime *phase, bool last) {
+    fprintf(file, "\"%s\": {\"wallSeconds\": %.6f, \"cpuSeconds\": %.6f}%s", name, phase->wallSeconds,
+            phase->cpuSeconds, last ? "" : ", ");
+}
+
+/**
+ * Writes the statistics of a run as a JSON document.
+ * @param stats - The statistics.
+ * @param fileName - The file to write to, or NULL for the standard error.
+ * @return true if the document was written.
+ */
+bool writeStats(struct Stats *stats, const char *fileName) {
+    FILE *file = fileName != NULL ? fopen(fileName, "w") : stderr;
+    if (file == NULL) {
+        fprintf(stderr, "File '%s' could not be created.\n", fileName);
+        return false;
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    fprintf(file, "{\n  \"engine\": \"%s\",\n  \"threads\": %d,\n  \"transactions\": %zu,\n  \"minSupport\": %u,\n",
+            stats->engine, stats->numThreads, stats->numTransactions, stats->minSupport);
+    if (stats->sample.sampleSize > 0) {
+        const struct SampleStats *sample = &stats->sample;
+        fprintf(file, "  \"sample\": {\"transactions\": %zu, \"minSupport\": %u, \"itemsets\": %zu, \"border\": %zu, "
+                      "\"borderFrequent\": %zu, \"extraPasses\": %zu},\n", sample->sampleSize, sample->sampleMinSupport,
+                sample->numSampleItemsets, sample->numBorder, sample->numBorderFrequent, sample->numExtraPasses);
+    }
+    fprintf(file, "  \"maxRssKb\": %ld,\n  \"phases\": {", usage.ru_maxrss);
+    writePhase(file, "load", &stats->load, false);
+    writePhase(file, "recode", &stats->recode, false);
+    writePhase(file, "mine", &stats->mine, false);
+    writePhase(file, "output", &stats->output, true);
+    fprintf(file, "},\n  \"levels\": [");
+    for (size_t k = 0; k < stats->numLevels; k++) {
+        struct LevelStats *level = &stats->levels[k];
+        fprintf(file, "%s\n    {\"k\": %zu, \"candidatesGenerated\": %zu, \"candidatesPruned\": %zu, "
+                      "\"treeNodes\": %zu, \"treeLeaves\": %zu, \"nodeVisits\": %llu, \"itemComparisons\": %llu, "
+                      "\"frequent\": %zu, \"liveTransactions\": %zu, \"bytesAllocated\": %zu,\n     \"phases\": {",
+                k > 0 ? "," : "", k + 1, level->candidatesGenerated, level->candidatesPruned, level->treeNodes,
+                level->treeLeaves, (unsigned long long) level->nodeVisits,
+                (unsigned long long) level->itemComparisons, level->numFrequent, level->liveTransactions,
+                level->bytesAllocated);
+        writePhase(file, "join", &level->join, false);
+        writePhase(file, "insert", &level->insert, false);
+        writePhase(file, "count", &level->count, false);
+        writePhase(file, "scan", &level->scan, true);
+        fprintf(file, "}}");
+    }
+    fprintf(file, "\n  ]\n}\n");
+
+    if (fileName != NULL && fclose(file) != 0) {
+        fprintf(stderr, "File '%s' could not be written.\n", fileName);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Frees the levels of the statistics of a run.
+ * @param stats - The statistics.
+ */
+void freeStats(struct Stats *stats) {
+    free(stats->levels);
+    stats->levels = NULL;
+    stats->numLevels = 0;
+}
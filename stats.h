@@ -0,0 +1,71 @@
+//
+// Statistics of a run, gathered per phase and per level and written out as a JSON document.
+//
+
+#ifndef APRIORI_STATS_H
+#define APRIORI_STATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Represents the time spent in a phase.
+struct PhaseTime {
+    double wallSeconds;
+    double cpuSeconds; // The processor time of all the threads of the process.
+};
+
+// Represents the start of a measured phase.
+struct Stopwatch {
+    double wallStart;
+    double cpuStart;
+};
+
+// Represents the statistics of the itemsets of one size.
+struct LevelStats {
+    size_t candidatesGenerated; // The candidates joined from the frequent itemsets of the previous level.
+    size_t candidatesPruned;    // The joined candidates dropped because one of their subsets is infrequent.
+    size_t treeNodes;           // The nodes of the hash tree, leaves included.
+    size_t treeLeaves;
+    uint64_t nodeVisits;        // The nodes of the hash tree or trie reached by the transactions, leaves included.
+    uint64_t itemComparisons;   // The number of items compared to match candidates to transactions.
+    size_t numFrequent;
+    size_t liveTransactions;    // The transactions counted in the pass.
+    size_t bytesAllocated;      // The memory taken by the candidates, the hash tree and the counters.
+    struct PhaseTime join;      // The generation and pruning of the candidates.
+    struct PhaseTime insert;    // The construction of the hash tree.
+    struct PhaseTime count;     // The pass over the transactions.
+    struct PhaseTime scan;      // The selection of the frequent itemsets and the reduction of the transactions.
+};
+
+// Represents the statistics of a run mining a sample of the transactions.
+struct SampleStats {
+    size_t sampleSize;         // The number of transactions sampled, or 0 if the run mined them all.
+    uint32_t sampleMinSupport; // The minimum support count the sample was mined with.
+    size_t numSampleItemsets;  // The itemsets of size k > 1 frequent in the sample.
+    size_t numBorder;          // The itemsets of size k > 1 of their negative border.
+    size_t numBorderFrequent;  // The itemsets of the negative border found frequent in all the transactions.
+    size_t numExtraPasses;     // The passes needed after the verification pass to find the itemsets missed.
+};
+
+// Represents the statistics of a run.
+struct Stats {
+    const char *engine;
+    int numThreads;
+    size_t numTransactions;
+    uint32_t minSupport;
+    struct PhaseTime load;
+    struct PhaseTime recode;
+    struct PhaseTime mine;
+    struct PhaseTime output; // The generation and printing of the itemsets and rules.
+    struct SampleStats sample;
+    struct LevelStats *levels;
+    size_t numLevels;
+};
+
+void startStopwatch(struct Stopwatch *stopwatch);
+void stopStopwatch(struct Stopwatch *stopwatch, struct PhaseTime *phase);
+struct LevelStats *getLevelStats(struct Stats *stats, size_t size);
+bool writeStats(struct Stats *stats, const char *fileName);
+void freeStats(struct Stats *stats);
+#endif //APRIORI_STATS_H
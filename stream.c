@@ -0,0 +1,472 @@
+//
+// Streams the transactions of a file in batches. A reader thread reads the file sequentially and decodes it into a
+// small ring of batches while the miner counts the previous ones, so reading, parsing and counting overlap and only
+// the ring is ever held in memory. Text files are read in large chunks and parsed like loadTransactions does; binary
+// files are mapped and copied out in order, the pages behind the reader being released as it goes.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "stream.h"
+#include "loader.h"
+#include "recode.h"
+
+// The number of bytes of a text file read at once.
+#define STREAM_CHUNK_SIZE ((size_t) 4 << 20)
+
+// The number of items after which a batch is handed to the miner.
+#define STREAM_BATCH_ITEMS ((size_t) 1 << 20)
+
+// The number of batches in the ring, including the one being counted and the one being decoded.
+#define STREAM_QUEUE_LENGTH 3
+
+// Represents a batch of decoded transactions along with the room allocated for it.
+struct StreamBatch {
+    struct TransactionDatabase database;
+    size_t itemCapacity;
+    size_t offsetCapacity;
+};
+
+// Represents a pass over a file of transactions.
+struct TransactionStream {
+    struct StreamSource source;
+    bool binary;
+    int fd;                           // The text file, or -1.
+    struct TransactionDatabase file;  // The mapping of a binary file.
+    pthread_t reader;
+    pthread_mutex_t mutex;
+    pthread_cond_t batchReady;
+    pthread_cond_t batchFree;
+    struct StreamBatch batches[STREAM_QUEUE_LENGTH];
+    size_t firstBatch;                // The oldest decoded batch.
+    size_t numUsed;                   // The number of decoded batches from firstBatch, the held one included.
+    bool held;                        // true if the miner is counting the batch at firstBatch.
+    bool finished;                    // true once the reader has decoded the whole file or failed.
+    bool stopped;                     // true once the stream is closed.
+    bool failed;
+};
+
+/**
+ * Gets the current value of the monotonic clock.
+ * @return The time in seconds.
+ */
+static double now() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double) time.tv_sec + (double) time.tv_nsec / 1e9;
+}
+
+/**
+ * Waits for a free batch in the ring, for the reader to decode transactions into.
+ * @param stream - The stream.
+ * @return The empty batch, or NULL if the stream was closed.
+ */
+static struct StreamBatch *acquireBatch(struct TransactionStream *stream) {
+    pthread_mutex_lock(&stream->mutex);
+    while (stream->numUsed == STREAM_QUEUE_LENGTH && !stream->stopped) {
+        pthread_cond_wait(&stream->batchFree, &stream->mutex);
+    }
+    struct StreamBatch *batch = NULL;
+    if (!stream->stopped) {
+        batch = &stream->batches[(stream->firstBatch + stream->numUsed) % STREAM_QUEUE_LENGTH];
+    }
+    pthread_mutex_unlock(&stream->mutex);
+    if (batch != NULL) {
+        batch->database.numTransactions = 0;
+        batch->database.maxTransactionLength = 0;
+        batch->database.offsets[0] = 0;
+    }
+    return batch;
+}
+
+/**
+ * Hands the batch the reader decoded to the miner.
+ * @param stream - The stream.
+ */
+static void publishBatch(struct TransactionStream *stream) {
+    pthread_mutex_lock(&stream->mutex);
+    stream->numUsed++;
+    pthread_cond_signal(&stream->batchReady);
+    pthread_mutex_unlock(&stream->mutex);
+}
+
+/**
+ * Marks the end of the reading of the file.
+ * @param stream - The stream.
+ * @param failed - true if the file could not be read entirely.
+ */
+static void finishReading(struct TransactionStream *stream, bool failed) {
+    pthread_mutex_lock(&stream->mutex);
+    stream->finished = true;
+    stream->failed = failed;
+    pthread_cond_signal(&stream->batchReady);
+    pthread_mutex_unlock(&stream->mutex);
+}
+
+/**
+ * Makes room for an item at the end of a batch.
+ * @param batch - The batch.
+ * @param numItems - The number of items the batch has to hold.
+ */
+static void reserveItems(struct StreamBatch *batch, size_t numItems) {
+    if (numItems > batch->itemCapacity) {
+        while (numItems > batch->itemCapacity) {
+            batch->itemCapacity *= 2;
+        }
+        batch->database.items = realloc(batch->database.items, batch->itemCapacity * sizeof(uint32_t));
+    }
+}
+
+/**
+ * Ends the transaction whose items were the last ones added to a batch, recoding its items.
+ * @param stream - The stream.
+ * @param batch - The batch.
+ * @param numItems - The number of items in the batch, including the ones of the ended transaction.
+ * @return true if the batch is full and should be handed to the miner.
+ */
+static bool endBatchTransaction(struct TransactionStream *stream, struct StreamBatch *batch, size_t numItems) {
+    struct TransactionDatabase *database = &batch->database;
+    size_t start = database->offsets[database->numTransactions];
+    if (stream->source.itemCodes != NULL) {
+        numItems = start + encodeTransaction(&database->items[start], numItems - start, stream->source.itemCodes,
+                                             stream->source.numItemCodes, stream->source.order,
+                                             &database->items[start]);
+    }
+    if (numItems - start > database->maxTransactionLength) {
+        database->maxTransactionLength = numItems - start;
+    }
+    if (database->numTransactions + 1 == batch->offsetCapacity) {
+        batch->offsetCapacity *= 2;
+        database->offsets = realloc(database->offsets, batch->offsetCapacity * sizeof(size_t));
+    }
+    database->offsets[++database->numTransactions] = numItems;
+    return numItems >= STREAM_BATCH_ITEMS;
+}
+
+/**
+ * Sorts the items of the line of a text file that was last added to a batch and removes the repeated ones, as
+ * loadTransactions does.
+ * @param batch - The batch.
+ * @param numItems - The number of items in the batch, including the ones of the line.
+ * @return The number of items in the batch once the repeated ones are removed.
+ */
+static size_t endTextLine(struct StreamBatch *batch, size_t numItems) {
+    size_t start = batch->database.offsets[batch->database.numTransactions];
+    return start + normalizeTransaction(&batch->database.items[start], numItems - start);
+}
+
+/**
+ * Reads and parses a text file. Every line is a transaction, including empty lines, whose item numbers are separated
+ * by spaces or tabs (or end with a carriage return); any other character is an error, as in loadTransactions. The
+ * items of a line are sorted and counted once.
+ * @param stream - The stream.
+ */
+static void readText(struct TransactionStream *stream) {
+    char *chunk = malloc(STREAM_CHUNK_SIZE);
+    struct StreamBatch *batch = acquireBatch(stream);
+    size_t numItems = 0;
+    uint64_t number = 0;
+    bool inNumber = false;
+    char last = '\n';
+    size_t line = 1;
+    bool failed = false;
+    ssize_t numRead = 0;
+    while (batch != NULL && !failed && (numRead = read(stream->fd, chunk, STREAM_CHUNK_SIZE)) > 0) {
+        for (ssize_t i = 0; i < numRead && batch != NULL; i++) {
+            char c = chunk[i];
+            if (c >= '0' && c <= '9') {
+                number = number * 10 + (uint64_t) (c - '0');
+                inNumber = true;
+                if (number > UINT32_MAX - 1) {
+                    fprintf(stderr, "Item number too large on line %zu.\n", line);
+                    failed = true;
+                    break;
+                }
+                continue;
+            }
+            if (inNumber) {
+                reserveItems(batch, numItems + 1);
+                batch->database.items[numItems++] = (uint32_t) number;
+                number = 0;
+                inNumber = false;
+            }
+            if (c == '\n') {
+                line++;
+                numItems = endTextLine(batch, numItems);
+                if (endBatchTransaction(stream, batch, numItems)) {
+                    publishBatch(stream);
+                    batch = acquireBatch(stream);
+                    numItems = 0;
+                } else {
+                    numItems = batch->database.offsets[batch->database.numTransactions];
+                }
+            } else if (c != ' ' && c != '\t' && c != '\r') {
+                fprintf(stderr, "Unexpected character '%c' on line %zu: items must be numbers separated by spaces or "
+                                "tabs.\n", c, line);
+                failed = true;
+                break;
+            }
+        }
+        last = chunk[numRead - 1];
+    }
+    if (numRead < 0) {
+        fprintf(stderr, "File '%s' could not be read.\n", stream->source.fileName);
+        failed = true;
+    }
+    if (batch != NULL && !failed) {
+        if (inNumber) {
+            reserveItems(batch, numItems + 1);
+            batch->database.items[numItems++] = (uint32_t) number;
+        }
+        // The last line may not end with a new line.
+        if (last != '\n') {
+            endBatchTransaction(stream, batch, endTextLine(batch, numItems));
+        }
+        if (batch->database.numTransactions > 0) {
+            publishBatch(stream);
+        }
+    }
+    free(chunk);
+    finishReading(stream, failed);
+}
+
+/**
+ * Copies the transactions of a mapped binary file into batches, recoding their items, and releases the pages of the
+ * items that have been copied.
+ * @param stream - The stream.
+ */
+static void readBinary(struct TransactionStream *stream) {
+    struct TransactionDatabase *file = &stream->file;
+    uintptr_t pageSize = (uintptr_t) sysconf(_SC_PAGESIZE);
+    uintptr_t released = ((uintptr_t) file->items + pageSize - 1) & ~(pageSize - 1);
+    struct StreamBatch *batch = acquireBatch(stream);
+    size_t numItems = 0;
+    for (size_t t = 0; t < file->numTransactions && batch != NULL; t++) {
+        struct Transaction transaction = getTransaction(file, t);
+        reserveItems(batch, numItems + (size_t) transaction.numItems);
+        memcpy(&batch->database.items[numItems], transaction.items, (size_t) transaction.numItems * sizeof(uint32_t));
+        numItems += (size_t) transaction.numItems;
+        if (endBatchTransaction(stream, batch, numItems)) {
+            publishBatch(stream);
+            batch = acquireBatch(stream);
+            numItems = 0;
+            uintptr_t consumed = (uintptr_t) &file->items[file->offsets[t + 1]] & ~(pageSize - 1);
+            if (file->fileMapped && consumed > released) {
+                madvise((void *) released, consumed - released, MADV_DONTNEED);
+                released = consumed;
+            }
+        } else {
+            numItems = batch->database.offsets[batch->database.numTransactions];
+        }
+    }
+    if (batch != NULL && batch->database.numTransactions > 0) {
+        publishBatch(stream);
+    }
+    finishReading(stream, false);
+}
+
+/**
+ * Runs the reader thread of a stream.
+ * @param argument - The stream.
+ * @return NULL.
+ */
+static void *runReader(void *argument) {
+    struct TransactionStream *stream = argument;
+    if (stream->binary) {
+        readBinary(stream);
+    } else {
+        readText(stream);
+    }
+    return NULL;
+}
+
+/**
+ * Starts a pass over a file of transactions.
+ * @param source - The file and the recoding of its items, which must outlive the stream.
+ * @return The stream, or NULL if the file could not be opened (an error message has been printed).
+ */
+struct TransactionStream *openTransactionStream(const struct StreamSource *source) {
+    struct TransactionStream *stream = calloc(1, sizeof(struct TransactionStream));
+    stream->source = *source;
+    stream->fd = -1;
+    stream->binary = isBinaryTransactionFile(source->fileName);
+    if (stream->binary) {
+        if (!loadTransactions(source->fileName, &stream->file)) {
+            free(stream);
+            return NULL;
+        }
+    } else {
+        stream->fd = open(source->fileName, O_RDONLY);
+        if (stream->fd < 0) {
+            fprintf(stderr, "File '%s' was not found.\n", source->fileName);
+            free(stream);
+            return NULL;
+        }
+        posix_fadvise(stream->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+    for (size_t b = 0; b < STREAM_QUEUE_LENGTH; b++) {
+        stream->batches[b].itemCapacity = STREAM_BATCH_ITEMS + 1024;
+        stream->batches[b].database.items = malloc(stream->batches[b].itemCapacity * sizeof(uint32_t));
+        stream->batches[b].offsetCapacity = 1024;
+        stream->batches[b].database.offsets = malloc(stream->batches[b].offsetCapacity * sizeof(size_t));
+    }
+    pthread_mutex_init(&stream->mutex, NULL);
+    pthread_cond_init(&stream->batchReady, NULL);
+    pthread_cond_init(&stream->batchFree, NULL);
+    pthread_create(&stream->reader, NULL, runReader, stream);
+    return stream;
+}
+
+/**
+ * Gets the next batch of transactions of a stream, releasing the previous one.
+ * Only the items, offsets, number of transactions and maximum transaction length of the batch are set; its items are
+ * codes if the source has item codes.
+ * @param stream - The stream.
+ * @return The batch, valid until the next call, or NULL at the end of the file or if it could not be read.
+ */
+struct TransactionDatabase *nextTransactionBatch(struct TransactionStream *stream) {
+    pthread_mutex_lock(&stream->mutex);
+    if (stream->held) {
+        stream->firstBatch = (stream->firstBatch + 1) % STREAM_QUEUE_LENGTH;
+        stream->numUsed--;
+        stream->held = false;
+        pthread_cond_signal(&stream->batchFree);
+    }
+    while (stream->numUsed == 0 && !stream->finished) {
+        pthread_cond_wait(&stream->batchReady, &stream->mutex);
+    }
+    struct TransactionDatabase *batch = NULL;
+    if (stream->numUsed > 0 && !stream->failed) {
+        stream->held = true;
+        batch = &stream->batches[stream->firstBatch].database;
+    }
+    pthread_mutex_unlock(&stream->mutex);
+    return batch;
+}
+
+/**
+ * Ends a pass over a file of transactions, whether or not every batch was read.
+ * @param stream - The stream to close.
+ * @return true if the whole file could be read, false otherwise (an error message has been printed).
+ */
+bool closeTransactionStream(struct TransactionStream *stream) {
+    pthread_mutex_lock(&stream->mutex);
+    stream->stopped = true;
+    pthread_cond_signal(&stream->batchFree);
+    pthread_mutex_unlock(&stream->mutex);
+    pthread_join(stream->reader, NULL);
+
+    bool failed = stream->failed;
+    for (size_t b = 0; b < STREAM_QUEUE_LENGTH; b++) {
+        free(stream->batches[b].database.items);
+        free(stream->batches[b].database.offsets);
+    }
+    pthread_mutex_destroy(&stream->mutex);
+    pthread_cond_destroy(&stream->batchReady);
+    pthread_cond_destroy(&stream->batchFree);
+    if (stream->binary) {
+        freeTransactions(&stream->file);
+    } else {
+        close(stream->fd);
+    }
+    free(stream);
+    return !failed;
+}
+
+/**
+ * Counts the supports of the items of a file, and its number of transactions and their largest length, without
+ * keeping the transactions in memory. The header of a binary file already holds them.
+ * @param fileName - The name of the file containing the transactions.
+ * @param database - The database to fill; its items and offsets are left NULL.
+ * @return true if the file was read, false otherwise (an error message has been printed).
+ */
+bool summarizeTransactions(const char *fileName, struct TransactionDatabase *database) {
+    double startTime = now();
+    memset(database, 0, sizeof(struct TransactionDatabase));
+    struct stat status;
+    if (stat(fileName, &status) == 0) {
+        database->numBytes = (size_t) status.st_size;
+    }
+
+    if (isBinaryTransactionFile(fileName)) {
+        struct TransactionDatabase file;
+        if (!loadTransactions(fileName, &file)) {
+            return false;
+        }
+        database->numTransactions = file.numTransactions;
+        database->maxItemNumber = file.maxItemNumber;
+        database->maxTransactionLength = file.maxTransactionLength;
+        database->itemSupports = malloc((file.maxItemNumber + 1) * sizeof(uint32_t));
+        if (database->itemSupports == NULL) {
+            fprintf(stderr, "Not enough memory to count the items of file '%s'.\n", fileName);
+            freeTransactions(&file);
+            return false;
+        }
+        memcpy(database->itemSupports, file.itemSupports, (file.maxItemNumber + 1) * sizeof(uint32_t));
+        freeTransactions(&file);
+        database->loadSeconds = now() - startTime;
+        return true;
+    }
+
+    struct StreamSource source = {fileName, NULL, 0, APRIORI_ITEM_ORDER_ID};
+    struct TransactionStream *stream = openTransactionStream(&source);
+    if (stream == NULL) {
+        return false;
+    }
+    size_t supportCapacity = 1024;
+    database->itemSupports = calloc(supportCapacity, sizeof(uint32_t));
+    bool counted = database->itemSupports != NULL;
+    struct TransactionDatabase *batch;
+    while (counted && (batch = nextTransactionBatch(stream)) != NULL) {
+        database->numTransactions += batch->numTransactions;
+        if (batch->maxTransactionLength > database->maxTransactionLength) {
+            database->maxTransactionLength = batch->maxTransactionLength;
+        }
+        for (size_t i = 0; i < batch->offsets[batch->numTransactions] && counted; i++) {
+            uint32_t item = batch->items[i];
+            if (item >= supportCapacity) {
+                // The supports are indexed by item number, and must not outgrow a file that may not fit in memory.
+                if (item >= database->numBytes + DENSE_ITEM_SLACK) {
+                    fprintf(stderr, "Item number %u is too large to stream file '%s'; load it without streaming.\n",
+                            item, fileName);
+                    counted = false;
+                    break;
+                }
+                size_t newCapacity = supportCapacity;
+                while (item >= newCapacity) {
+                    newCapacity *= 2;
+                }
+                uint32_t *supports = realloc(database->itemSupports, newCapacity * sizeof(uint32_t));
+                if (supports == NULL) {
+                    fprintf(stderr, "Not enough memory to count the items of file '%s'.\n", fileName);
+                    counted = false;
+                    break;
+                }
+                database->itemSupports = supports;
+                memset(&database->itemSupports[supportCapacity], 0, (newCapacity - supportCapacity) * sizeof(uint32_t));
+                supportCapacity = newCapacity;
+            }
+            database->itemSupports[item] += 1;
+            if (item > database->maxItemNumber) {
+                database->maxItemNumber = item;
+            }
+        }
+    }
+    if (database->itemSupports == NULL) {
+        fprintf(stderr, "Not enough memory to count the items of file '%s'.\n", fileName);
+    }
+    bool complete = closeTransactionStream(stream) && counted;
+    database->loadSeconds = now() - startTime;
+    if (!complete) {
+        free(database->itemSupports);
+        database->itemSupports = NULL;
+    }
+    return complete;
+}
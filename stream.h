@@ -0,0 +1,26 @@
+//
+// Streams the transactions of a file in batches, so that a database larger than memory can be mined by reading the
+// file again in every pass.
+//
+
+#ifndef APRIORI_STREAM_H
+#define APRIORI_STREAM_H
+
+#include <stdbool.h>
+#include "apriori.h"
+
+// Represents a file of transactions read in every pass, and how its items are recoded while it is decoded.
+struct StreamSource {
+    const char *fileName;
+    const uint32_t *itemCodes;   // The code of each item number, or UINT32_MAX if it is infrequent; NULL to keep them.
+    size_t numItemCodes;         // The number of entries in itemCodes.
+    enum AprioriItemOrder order; // The order of the codes; the codes of a transaction are sorted if it is not by item.
+};
+
+struct TransactionStream;
+
+bool summarizeTransactions(const char *fileName, struct TransactionDatabase *database);
+struct TransactionStream *openTransactionStream(const struct StreamSource *source);
+struct TransactionDatabase *nextTransactionBatch(struct TransactionStream *stream);
+bool closeTransactionStream(struct TransactionStream *stream);
+#endif //APRIORI_STREAM_H
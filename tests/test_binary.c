@@ -0,0 +1,167 @@
+//
+// Checks that apriori_convert's binary format holds the transactions of the text file, sorted, and that corrupted
+// binary files are refused.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "testing.h"
+#include "loader.h"
+
+/**
+ * Reads a field of the header of a binary transaction file.
+ * @param data - The content of the file.
+ * @param field - The index of the field among the 64-bit fields following the magic number, version and byte order.
+ * @return The value of the field.
+ */
+static uint64_t headerField(const char *data, size_t field) {
+    uint64_t value;
+    memcpy(&value, data + 16 + 8 * field, sizeof(value));
+    return value;
+}
+
+/**
+ * Sets a field of the header of a binary transaction file.
+ * @param data - The content of the file.
+ * @param field - The index of the field among the 64-bit fields following the magic number, version and byte order.
+ * @param value - The value of the field.
+ */
+static void setHeaderField(char *data, size_t field, uint64_t value) {
+    memcpy(data + 16 + 8 * field, &value, sizeof(value));
+}
+
+/**
+ * Checks whether two databases hold the same transactions and item supports.
+ * @param a - The first database.
+ * @param b - The second database.
+ * @return true if they are the same.
+ */
+static bool sameTransactions(const struct TransactionDatabase *a, const struct TransactionDatabase *b) {
+    return a->numTransactions == b->numTransactions && a->maxItemNumber == b->maxItemNumber &&
+           a->maxTransactionLength == b->maxTransactionLength &&
+           memcmp(a->offsets, b->offsets, (a->numTransactions + 1) * sizeof(size_t)) == 0 &&
+           memcmp(a->items, b->items, a->offsets[a->numTransactions] * sizeof(uint32_t)) == 0 &&
+           memcmp(a->itemSupports, b->itemSupports, (a->maxItemNumber + 1) * sizeof(uint32_t)) == 0;
+}
+
+/**
+ * Converts a text file to a binary file and checks that the binary file holds the transactions of the dataset.
+ * @param name - The name of the case.
+ * @param textFile - The text file.
+ * @param binaryFile - The binary file to write.
+ * @param expected - The transactions of the dataset, loaded from its text file.
+ */
+static void checkConversion(const char *name, const char *textFile, const char *binaryFile,
+                            const struct TransactionDatabase *expected) {
+    struct TransactionDatabase text;
+    struct TransactionDatabase binary;
+    if (!loadTransactions(textFile, &text)) {
+        check(false, name, "the text file could not be loaded");
+        return;
+    }
+    bool converted = saveTransactions(binaryFile, &text) && loadTransactions(binaryFile, &binary);
+    check(converted, name, "the binary file could not be saved or loaded");
+    if (converted) {
+        check(sameTransactions(&binary, expected), name, "the binary file holds other transactions");
+        freeTransactions(&binary);
+    }
+    freeTransactions(&text);
+}
+
+int main(int argc, char *argv[]) {
+    struct TestData data;
+    if (!setUpTestData(argc, argv, "binary", &data)) {
+        return EXIT_FAILURE;
+    }
+    char scrambledFile[TEST_PATH_LENGTH];
+    char binaryFile[TEST_PATH_LENGTH];
+    char badFile[TEST_PATH_LENGTH];
+    testFileName(&data, "scrambled.txt", scrambledFile);
+    testFileName(&data, "data.bin", binaryFile);
+    testFileName(&data, "bad.bin", badFile);
+    writeScrambledTransactions(scrambledFile, data.masks, 0);
+
+    // A line whose items are unsorted or repeated is converted to its sorted items, which the binary loader accepts.
+    struct TransactionDatabase expected;
+    if (!loadTransactions(data.fileName, &expected)) {
+        check(false, "binary round trip", "the text file could not be loaded");
+        tearDownTestData(&data);
+        return finishTests();
+    }
+    checkConversion("binary round trip of unsorted and repeated items", scrambledFile, binaryFile, &expected);
+    checkConversion("binary round trip", data.fileName, binaryFile, &expected);
+    freeTransactions(&expected);
+
+    static const enum AprioriEngine engines[] = {APRIORI_ENGINE_HASH_TREE, APRIORI_ENGINE_TRIE, APRIORI_ENGINE_BITSET,
+                                                 APRIORI_ENGINE_FP_GROWTH};
+    static const char *engineNames[] = {"hashtree", "trie", "bitset", "fpgrowth"};
+    char name[128];
+    for (size_t e = 0; e < sizeof(engines) / sizeof(engines[0]); e++) {
+        struct AprioriOptions options;
+        initTestOptions(&options, engines[e]);
+        snprintf(name, sizeof(name), "%s binary", engineNames[e]);
+        checkRun(name, binaryFile, NULL, &options, &data.reference.all);
+    }
+
+    // Corrupted binary files must be refused.
+    struct AprioriOptions options;
+    initTestOptions(&options, APRIORI_ENGINE_HASH_TREE);
+    size_t size;
+    char *content = readFile(binaryFile, &size);
+    uint64_t numTransactions = headerField(content, 0);
+    uint64_t numItems = headerField(content, 1);
+    uint64_t maxTransactionLength = headerField(content, 3);
+    size_t supportsStart = (size_t) headerField(content, 4);
+    size_t offsetsStart = (size_t) headerField(content, 5);
+    size_t itemsStart = (size_t) headerField(content, 6);
+    const uint64_t *offsets = (const uint64_t *) (content + offsetsStart);
+    size_t pair = 0; // A transaction with at least two items.
+    while (pair < numTransactions && offsets[pair + 1] - offsets[pair] < 2) {
+        pair++;
+    }
+    char *corrupted = malloc(size);
+    for (int c = 0; c < 7; c++) {
+        memcpy(corrupted, content, size);
+        size_t corruptedSize = size;
+        uint32_t *corruptedSupports = (uint32_t *) (corrupted + supportsStart);
+        uint64_t *corruptedOffsets = (uint64_t *) (corrupted + offsetsStart);
+        uint32_t *corruptedItems = (uint32_t *) (corrupted + itemsStart);
+        const char *what;
+        if (c == 0) {
+            what = "truncated header";
+            corruptedSize = 40;
+        } else if (c == 1) {
+            what = "offset past the items";
+            corruptedOffsets[numTransactions / 2] = numItems + 100;
+        } else if (c == 2) {
+            what = "decreasing offset";
+            corruptedOffsets[pair + 1] = corruptedOffsets[pair] - 1;
+        } else if (c == 3) {
+            what = "item above the largest item number";
+            corruptedItems[offsets[pair]] = RARE_ITEM + 1;
+        } else if (c == 4) {
+            what = "items not increasing";
+            uint32_t swap = corruptedItems[offsets[pair]];
+            corruptedItems[offsets[pair]] = corruptedItems[offsets[pair] + 1];
+            corruptedItems[offsets[pair] + 1] = swap;
+        } else if (c == 5) {
+            what = "wrong longest transaction";
+            setHeaderField(corrupted, 3, maxTransactionLength + 1);
+        } else {
+            what = "wrong item support";
+            corruptedSupports[itemNumber(0)]++;
+        }
+        writeFile(badFile, corrupted, corruptedSize);
+        snprintf(name, sizeof(name), "corrupted binary file, %s", what);
+        checkRefused(name, badFile, NULL, &options, &data);
+    }
+    free(corrupted);
+    free(content);
+
+    remove(scrambledFile);
+    remove(binaryFile);
+    remove(badFile);
+    tearDownTestData(&data);
+    return finishTests();
+}
@@ -0,0 +1,45 @@
+//
+// Checks the closed and maximal itemsets the FP-Growth engine finds directly, and the rules between the closed ones,
+// and that the runs it cannot filter are refused.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "testing.h"
+
+int main(int argc, char *argv[]) {
+    struct TestData data;
+    if (!setUpTestData(argc, argv, "closed", &data)) {
+        return EXIT_FAILURE;
+    }
+    static const int threads[] = {1, 2, 4};
+    char name[64];
+    for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+        struct AprioriOptions options;
+        initTestOptions(&options, APRIORI_ENGINE_FP_GROWTH);
+        options.numThreads = threads[t];
+        options.filter = APRIORI_ITEMSETS_CLOSED;
+        snprintf(name, sizeof(name), "fpgrowth closed -j %d", threads[t]);
+        checkRun(name, data.fileName, NULL, &options, &data.reference.closed);
+        options.filter = APRIORI_ITEMSETS_MAXIMAL;
+        snprintf(name, sizeof(name), "fpgrowth maximal -j %d", threads[t]);
+        checkRun(name, data.fileName, NULL, &options, &data.reference.maximal);
+    }
+
+    static const enum AprioriEngine engines[] = {APRIORI_ENGINE_HASH_TREE, APRIORI_ENGINE_TRIE, APRIORI_ENGINE_BITSET};
+    static const char *engineNames[] = {"hashtree", "trie", "bitset"};
+    for (size_t e = 0; e < sizeof(engines) / sizeof(engines[0]); e++) {
+        struct AprioriOptions options;
+        initTestOptions(&options, engines[e]);
+        options.filter = APRIORI_ITEMSETS_CLOSED;
+        snprintf(name, sizeof(name), "%s closed", engineNames[e]);
+        checkRefused(name, data.fileName, NULL, &options, &data);
+    }
+    struct AprioriOptions options;
+    initTestOptions(&options, APRIORI_ENGINE_FP_GROWTH);
+    options.filter = APRIORI_ITEMSETS_MAXIMAL;
+    options.numPartitions = 2;
+    checkRefused("fpgrowth maximal partitions", data.fileName, NULL, &options, &data);
+    tearDownTestData(&data);
+    return finishTests();
+}
@@ -0,0 +1,25 @@
+//
+// Checks the frequent itemsets and strong rules of the FP-Growth engine.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "testing.h"
+
+int main(int argc, char *argv[]) {
+    struct TestData data;
+    if (!setUpTestData(argc, argv, "fpgrowth", &data)) {
+        return EXIT_FAILURE;
+    }
+    static const int threads[] = {1, 3};
+    char name[64];
+    for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+        struct AprioriOptions options;
+        initTestOptions(&options, APRIORI_ENGINE_FP_GROWTH);
+        options.numThreads = threads[t];
+        snprintf(name, sizeof(name), "fpgrowth -j %d", threads[t]);
+        checkRun(name, data.fileName, NULL, &options, &data.reference.all);
+    }
+    tearDownTestData(&data);
+    return finishTests();
+}
@@ -0,0 +1,31 @@
+//
+// Checks the AprioriHybrid runs, which count the last levels in the AprioriTid lists of candidates instead of the
+// transactions.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "testing.h"
+
+int main(int argc, char *argv[]) {
+    struct TestData data;
+    if (!setUpTestData(argc, argv, "hybrid", &data)) {
+        return EXIT_FAILURE;
+    }
+    static const enum AprioriEngine engines[] = {APRIORI_ENGINE_HASH_TREE, APRIORI_ENGINE_TRIE};
+    static const char *engineNames[] = {"hashtree", "trie"};
+    static const int threads[] = {1, 2, 5};
+    char name[64];
+    for (size_t e = 0; e < sizeof(engines) / sizeof(engines[0]); e++) {
+        for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+            struct AprioriOptions options;
+            initTestOptions(&options, engines[e]);
+            options.hybrid = true;
+            options.numThreads = threads[t];
+            snprintf(name, sizeof(name), "%s hybrid -j %d", engineNames[e], threads[t]);
+            checkRun(name, data.fileName, NULL, &options, &data.reference.all);
+        }
+    }
+    tearDownTestData(&data);
+    return finishTests();
+}
@@ -0,0 +1,69 @@
+//
+// Checks the incremental runs: mining the old transactions while saving the state of the run, then updating it with
+// the appended ones, must find the itemsets and rules of the whole.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "testing.h"
+
+// The number of transactions mined before the others are appended.
+#define NUM_OLD_TRANSACTIONS (NUM_TRANSACTIONS * 3 / 4)
+
+int main(int argc, char *argv[]) {
+    struct TestData data;
+    if (!setUpTestData(argc, argv, "incremental", &data)) {
+        return EXIT_FAILURE;
+    }
+    char oldFile[TEST_PATH_LENGTH];
+    char newFile[TEST_PATH_LENGTH];
+    char stateFile[TEST_PATH_LENGTH];
+    char sparseFile[TEST_PATH_LENGTH];
+    testFileName(&data, "old.txt", oldFile);
+    testFileName(&data, "new.txt", newFile);
+    testFileName(&data, "state", stateFile);
+    testFileName(&data, "sparse.txt", sparseFile);
+    writeTransactions(oldFile, data.masks, 0, NUM_OLD_TRANSACTIONS);
+    writeTransactions(newFile, data.masks, NUM_OLD_TRANSACTIONS, NUM_TRANSACTIONS);
+    writeScrambledTransactions(sparseFile, data.masks, SPARSE_ITEM_OFFSET);
+
+    static const enum AprioriEngine engines[] = {APRIORI_ENGINE_HASH_TREE, APRIORI_ENGINE_TRIE};
+    static const char *engineNames[] = {"hashtree", "trie"};
+    char name[128];
+    for (size_t e = 0; e < sizeof(engines) / sizeof(engines[0]); e++) {
+        for (int numThreads = 1; numThreads <= 3; numThreads += 2) {
+            struct AprioriOptions options;
+            initTestOptions(&options, engines[e]);
+            options.numThreads = numThreads;
+            options.saveStateFileName = stateFile;
+            snprintf(name, sizeof(name), "%s -j %d save state", engineNames[e], numThreads);
+            struct EntryList unused = {0};
+            check(mine(oldFile, NULL, &options, NULL, &unused), name, "the run failed");
+            free(unused.entries);
+
+            options.saveStateFileName = NULL;
+            options.updateFileName = stateFile;
+            options.historyFileName = oldFile;
+            snprintf(name, sizeof(name), "%s -j %d incremental update", engineNames[e], numThreads);
+            checkRun(name, newFile, NULL, &options, &data.reference.all);
+
+            // The state was saved after other transactions.
+            options.historyFileName = newFile;
+            snprintf(name, sizeof(name), "%s -j %d update with the wrong history", engineNames[e], numThreads);
+            checkRefused(name, newFile, NULL, &options, &data);
+        }
+    }
+
+    // The state is indexed by item number.
+    struct AprioriOptions options;
+    initTestOptions(&options, APRIORI_ENGINE_HASH_TREE);
+    options.saveStateFileName = stateFile;
+    checkRefused("save the state of sparse item numbers", sparseFile, NULL, &options, &data);
+
+    remove(oldFile);
+    remove(newFile);
+    remove(stateFile);
+    remove(sparseFile);
+    tearDownTestData(&data);
+    return finishTests();
+}
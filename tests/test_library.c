@@ -0,0 +1,64 @@
+//
+// Checks the library on transactions held in memory, and that it refuses transactions whose items do not increase.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "testing.h"
+
+int main(int argc, char *argv[]) {
+    struct TestData data;
+    if (!setUpTestData(argc, argv, "library", &data)) {
+        return EXIT_FAILURE;
+    }
+    // The transactions of the dataset, in compressed sparse row form.
+    uint32_t *items = malloc(NUM_TRANSACTIONS * (NUM_ITEMS + 1) * sizeof(uint32_t));
+    size_t offsets[NUM_TRANSACTIONS + 1];
+    offsets[0] = 0;
+    for (size_t t = 0; t < NUM_TRANSACTIONS; t++) {
+        offsets[t + 1] = offsets[t];
+        for (int b = 0; b <= NUM_ITEMS; b++) {
+            if (data.masks[t] & (1u << b)) {
+                items[offsets[t + 1]++] = itemNumber(b);
+            }
+        }
+    }
+    struct AprioriTransactions transactions = {items, offsets, NUM_TRANSACTIONS};
+
+    static const enum AprioriEngine engines[] = {APRIORI_ENGINE_HASH_TREE, APRIORI_ENGINE_TRIE, APRIORI_ENGINE_BITSET,
+                                                 APRIORI_ENGINE_FP_GROWTH};
+    static const char *engineNames[] = {"hashtree", "trie", "bitset", "fpgrowth"};
+    char name[128];
+    for (size_t e = 0; e < sizeof(engines) / sizeof(engines[0]); e++) {
+        struct AprioriOptions options;
+        initTestOptions(&options, engines[e]);
+        snprintf(name, sizeof(name), "%s in memory", engineNames[e]);
+        checkRun(name, NULL, &transactions, &options, &data.reference.all);
+    }
+
+    struct AprioriOptions options;
+    initTestOptions(&options, APRIORI_ENGINE_HASH_TREE);
+    size_t pair = 0; // A transaction with at least two items.
+    while (offsets[pair + 1] - offsets[pair] < 2) {
+        pair++;
+    }
+    uint32_t first = items[offsets[pair]];
+    uint32_t second = items[offsets[pair] + 1];
+    items[offsets[pair]] = second;
+    items[offsets[pair] + 1] = first;
+    checkRefused("items in memory not increasing", NULL, &transactions, &options, &data);
+    items[offsets[pair] + 1] = second;
+    checkRefused("items in memory repeated", NULL, &transactions, &options, &data);
+    items[offsets[pair]] = first;
+    // The transaction after the pair ends before it starts.
+    size_t end = offsets[pair + 2];
+    offsets[pair + 2] = offsets[pair + 1] - 1;
+    checkRefused("offsets in memory decreasing", NULL, &transactions, &options, &data);
+    offsets[pair + 2] = end;
+    options.stream = true;
+    checkRefused("streaming in memory", NULL, &transactions, &options, &data);
+
+    free(items);
+    tearDownTestData(&data);
+    return finishTests();
+}
@@ -0,0 +1,55 @@
+//
+// Checks that the text loader refuses malformed files, and reads lines whose items are unsorted, repeated or sparse
+// the same for every engine.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "testing.h"
+
+int main(int argc, char *argv[]) {
+    struct TestData data;
+    if (!setUpTestData(argc, argv, "loader", &data)) {
+        return EXIT_FAILURE;
+    }
+    char scrambledFile[TEST_PATH_LENGTH];
+    char sparseFile[TEST_PATH_LENGTH];
+    char badFile[TEST_PATH_LENGTH];
+    testFileName(&data, "scrambled.txt", scrambledFile);
+    testFileName(&data, "sparse.txt", sparseFile);
+    testFileName(&data, "bad.txt", badFile);
+    writeScrambledTransactions(scrambledFile, data.masks, 0);
+    writeScrambledTransactions(sparseFile, data.masks, SPARSE_ITEM_OFFSET);
+
+    static const enum AprioriEngine engines[] = {APRIORI_ENGINE_HASH_TREE, APRIORI_ENGINE_TRIE, APRIORI_ENGINE_BITSET,
+                                                 APRIORI_ENGINE_FP_GROWTH};
+    static const char *engineNames[] = {"hashtree", "trie", "bitset", "fpgrowth"};
+    char name[64];
+    for (size_t e = 0; e < sizeof(engines) / sizeof(engines[0]); e++) {
+        struct AprioriOptions options;
+        initTestOptions(&options, engines[e]);
+        snprintf(name, sizeof(name), "%s unsorted and repeated items", engineNames[e]);
+        checkRun(name, scrambledFile, NULL, &options, &data.reference.all);
+        snprintf(name, sizeof(name), "%s sparse item numbers", engineNames[e]);
+        checkRun(name, sparseFile, NULL, &options, &data.reference.all);
+        options.itemOrder = APRIORI_ITEM_ORDER_FREQUENCY;
+        snprintf(name, sizeof(name), "%s sparse item numbers in frequency order", engineNames[e]);
+        checkRun(name, sparseFile, NULL, &options, &data.reference.all);
+    }
+
+    struct AprioriOptions options;
+    initTestOptions(&options, APRIORI_ENGINE_HASH_TREE);
+    static const char *malformed[] = {"1 2\n-2 4\n", "1 2\n3 x\n", "1 2\n1.5 4\n", "1,2\n", "99999999999\n"};
+    for (size_t m = 0; m < sizeof(malformed) / sizeof(malformed[0]); m++) {
+        writeFile(badFile, malformed[m], strlen(malformed[m]));
+        snprintf(name, sizeof(name), "malformed text %zu", m + 1);
+        checkRefused(name, badFile, NULL, &options, &data);
+    }
+
+    remove(scrambledFile);
+    remove(sparseFile);
+    remove(badFile);
+    tearDownTestData(&data);
+    return finishTests();
+}
@@ -0,0 +1,73 @@
+//
+// Checks that the items are renumbered from the least to the most frequent without changing the results, and that the
+// itemsets and rules are still handed over in increasing item numbers.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "testing.h"
+
+/**
+ * Checks whether item numbers increase.
+ * @param items - The item numbers.
+ * @param numItems - The number of item numbers.
+ * @return true if every item number is larger than the previous one.
+ */
+static bool increasing(const uint32_t *items, size_t numItems) {
+    for (size_t i = 1; i < numItems; i++) {
+        if (items[i] <= items[i - 1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Counts the itemsets whose items do not increase.
+ */
+static void countUnsortedItemset(const uint32_t *items, size_t size, uint32_t support, void *context) {
+    (void) support;
+    *(size_t *) context += !increasing(items, size);
+}
+
+/**
+ * Counts the rules whose antecedent or consequence does not increase.
+ */
+static void countUnsortedRule(const uint32_t *antecedent, size_t antecedentSize, const uint32_t *consequent,
+                              size_t consequentSize, uint32_t support, double confidence, void *context) {
+    (void) support;
+    (void) confidence;
+    *(size_t *) context += !increasing(antecedent, antecedentSize) || !increasing(consequent, consequentSize);
+}
+
+int main(int argc, char *argv[]) {
+    struct TestData data;
+    if (!setUpTestData(argc, argv, "order", &data)) {
+        return EXIT_FAILURE;
+    }
+    static const enum AprioriEngine engines[] = {APRIORI_ENGINE_HASH_TREE, APRIORI_ENGINE_TRIE, APRIORI_ENGINE_BITSET,
+                                                 APRIORI_ENGINE_FP_GROWTH};
+    static const char *engineNames[] = {"hashtree", "trie", "bitset", "fpgrowth"};
+    char name[64];
+    for (size_t e = 0; e < sizeof(engines) / sizeof(engines[0]); e++) {
+        struct AprioriOptions options;
+        initTestOptions(&options, engines[e]);
+        options.itemOrder = APRIORI_ITEM_ORDER_FREQUENCY;
+        options.numThreads = 3;
+        snprintf(name, sizeof(name), "%s -j 3 frequency order", engineNames[e]);
+        checkRun(name, data.fileName, NULL, &options, &data.reference.all);
+
+        struct AprioriResult *result = aprioriMineFile(data.fileName, &options);
+        if (result == NULL) {
+            check(false, name, "the run failed");
+            continue;
+        }
+        size_t numUnsorted = 0;
+        aprioriForEachItemset(result, countUnsortedItemset, &numUnsorted);
+        aprioriForEachRule(result, countUnsortedRule, &numUnsorted);
+        check(numUnsorted == 0, name, "the items of an itemset or rule are not in increasing order");
+        aprioriFreeResult(result);
+    }
+    tearDownTestData(&data);
+    return finishTests();
+}
@@ -0,0 +1,34 @@
+//
+// Checks that the pairs counted in the triangular matrix are those counted in a tree when the matrix does not fit the
+// memory budget.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "testing.h"
+
+int main(int argc, char *argv[]) {
+    struct TestData data;
+    if (!setUpTestData(argc, argv, "pairs", &data)) {
+        return EXIT_FAILURE;
+    }
+    static const enum AprioriEngine engines[] = {APRIORI_ENGINE_HASH_TREE, APRIORI_ENGINE_TRIE};
+    static const char *engineNames[] = {"hashtree", "trie"};
+    static const int threads[] = {1, 4};
+    char name[128];
+    for (size_t e = 0; e < sizeof(engines) / sizeof(engines[0]); e++) {
+        for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+            struct AprioriOptions options;
+            initTestOptions(&options, engines[e]);
+            options.numThreads = threads[t];
+            snprintf(name, sizeof(name), "%s -j %d pairs in the matrix", engineNames[e], threads[t]);
+            checkRun(name, data.fileName, NULL, &options, &data.reference.all);
+            // Too small for the matrix of the frequent items.
+            options.memoryBudget = 64;
+            snprintf(name, sizeof(name), "%s -j %d pairs in a tree", engineNames[e], threads[t]);
+            checkRun(name, data.fileName, NULL, &options, &data.reference.all);
+        }
+    }
+    tearDownTestData(&data);
+    return finishTests();
+}
@@ -0,0 +1,89 @@
+//
+// Checks the partitioned runs, mined by worker processes, and that they leave no handoff files behind.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include "testing.h"
+
+/**
+ * Counts the handoff directories of the partitioned runs left in a directory.
+ * @param directory - The directory.
+ * @return The number of entries whose name starts like those of the handoff directories.
+ */
+static size_t countHandoffDirectories(const char *directory) {
+    DIR *entries = opendir(directory);
+    if (entries == NULL) {
+        return 0;
+    }
+    size_t count = 0;
+    struct dirent *entry;
+    while ((entry = readdir(entries)) != NULL) {
+        count += strncmp(entry->d_name, "apriori-", strlen("apriori-")) == 0;
+    }
+    closedir(entries);
+    return count;
+}
+
+int main(int argc, char *argv[]) {
+    struct TestData data;
+    if (!setUpTestData(argc, argv, "partition", &data)) {
+        return EXIT_FAILURE;
+    }
+    size_t numLeftBefore = countHandoffDirectories(data.directory);
+    static const enum AprioriEngine engines[] = {APRIORI_ENGINE_HASH_TREE, APRIORI_ENGINE_TRIE, APRIORI_ENGINE_BITSET,
+                                                 APRIORI_ENGINE_FP_GROWTH};
+    static const char *engineNames[] = {"hashtree", "trie", "bitset", "fpgrowth"};
+    char name[128];
+    for (size_t e = 0; e < sizeof(engines) / sizeof(engines[0]); e++) {
+        struct AprioriOptions options;
+        initTestOptions(&options, engines[e]);
+        options.partitionDirectory = data.directory;
+        options.numPartitions = 2;
+        snprintf(name, sizeof(name), "%s 2 partitions", engineNames[e]);
+        checkRun(name, data.fileName, NULL, &options, &data.reference.all);
+        options.numPartitions = 3;
+        options.numThreads = 2;
+        snprintf(name, sizeof(name), "%s 3 partitions -j 2", engineNames[e]);
+        checkRun(name, data.fileName, NULL, &options, &data.reference.all);
+        options.numPartitions = APRIORI_AUTO_PARTITIONS;
+        snprintf(name, sizeof(name), "%s automatic partitions -j 2", engineNames[e]);
+        checkRun(name, data.fileName, NULL, &options, &data.reference.all);
+    }
+    // A child of the embedding process that exits during a run must be left for it to wait for.
+    pid_t child = fork();
+    if (child == 0) {
+        _exit(EXIT_SUCCESS);
+    }
+    struct AprioriOptions embedded;
+    initTestOptions(&embedded, APRIORI_ENGINE_HASH_TREE);
+    embedded.partitionDirectory = data.directory;
+    embedded.numPartitions = 2;
+    siginfo_t exited;
+    waitid(P_PID, (id_t) child, &exited, WEXITED | WNOWAIT);
+    checkRun("partitions with another child", data.fileName, NULL, &embedded, &data.reference.all);
+    int status;
+    check(waitpid(child, &status, 0) == child, "partitions with another child",
+          "the run waited for a child process that is not one of its workers");
+
+    check(countHandoffDirectories(data.directory) == numLeftBefore, "partition handoff files",
+          "a partitioned run left its handoff directory behind");
+
+    // Partitions of a single transaction would have a local minimum support of 1.
+    struct AprioriOptions options;
+    initTestOptions(&options, APRIORI_ENGINE_HASH_TREE);
+    options.partitionDirectory = data.directory;
+    options.numPartitions = NUM_TRANSACTIONS;
+    checkRefused("too many partitions", data.fileName, NULL, &options, &data);
+    options.numPartitions = 2;
+    options.partitionDirectory = "/nonexistent-directory";
+    checkRefused("partition directory missing", data.fileName, NULL, &options, &data);
+
+    tearDownTestData(&data);
+    return finishTests();
+}
@@ -0,0 +1,36 @@
+//
+// Checks that the strong rules generated by several threads are those of a single one, and of the reference.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "testing.h"
+
+int main(int argc, char *argv[]) {
+    struct TestData data;
+    if (!setUpTestData(argc, argv, "rules", &data)) {
+        return EXIT_FAILURE;
+    }
+    static const int threads[] = {1, 2, 4};
+    char name[64];
+    for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+        struct AprioriOptions options;
+        initTestOptions(&options, APRIORI_ENGINE_FP_GROWTH);
+        options.numThreads = threads[t];
+        snprintf(name, sizeof(name), "rules -j %d", threads[t]);
+        struct EntryList rules = {0};
+        check(mine(data.fileName, NULL, &options, NULL, &rules), name, "the run failed");
+        check(rules.length == data.reference.rules.length, name, "the number of rules differs from the reference");
+        qsort(rules.entries, rules.length, sizeof(struct Entry), compareEntries);
+        for (size_t r = 0; r < rules.length && rules.length == data.reference.rules.length; r++) {
+            if (compareEntries(&rules.entries[r], &data.reference.rules.entries[r]) != 0 ||
+                rules.entries[r].support != data.reference.rules.entries[r].support) {
+                check(false, name, "the rules differ from the reference");
+                break;
+            }
+        }
+        free(rules.entries);
+    }
+    tearDownTestData(&data);
+    return finishTests();
+}
@@ -0,0 +1,58 @@
+//
+// Checks the sampled runs of every engine: verified against all the transactions, whatever the sample missed, they
+// must find the itemsets and rules of the reference.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "testing.h"
+
+int main(int argc, char *argv[]) {
+    struct TestData data;
+    if (!setUpTestData(argc, argv, "sample", &data)) {
+        return EXIT_FAILURE;
+    }
+    static const enum AprioriEngine engines[] = {APRIORI_ENGINE_HASH_TREE, APRIORI_ENGINE_TRIE, APRIORI_ENGINE_BITSET,
+                                                 APRIORI_ENGINE_FP_GROWTH};
+    static const char *engineNames[] = {"hashtree", "trie", "bitset", "fpgrowth"};
+    // The smallest sample misses some frequent itemsets, which the further passes must complete.
+    static const double fractions[] = {0.02, 0.25};
+    char name[64];
+    for (size_t e = 0; e < sizeof(engines) / sizeof(engines[0]); e++) {
+        for (size_t f = 0; f < sizeof(fractions) / sizeof(fractions[0]); f++) {
+            for (uint64_t seed = 1; seed <= 3; seed++) {
+                struct AprioriOptions options;
+                initTestOptions(&options, engines[e]);
+                options.sampleFraction = fractions[f];
+                options.seed = seed;
+                snprintf(name, sizeof(name), "%s sample %g seed %llu", engineNames[e], fractions[f],
+                         (unsigned long long) seed);
+                checkRun(name, data.fileName, NULL, &options, &data.reference.all);
+            }
+        }
+        // A sample of every transaction is the whole dataset, so even unverified it is exact.
+        struct AprioriOptions options;
+        initTestOptions(&options, engines[e]);
+        options.sampleFraction = 1;
+        options.approximate = true;
+        snprintf(name, sizeof(name), "%s approximate sample 1", engineNames[e]);
+        checkRun(name, data.fileName, NULL, &options, &data.reference.all);
+    }
+
+    struct AprioriOptions options;
+    initTestOptions(&options, APRIORI_ENGINE_HASH_TREE);
+    options.sampleFraction = 1.5;
+    checkRefused("sample 1.5", data.fileName, NULL, &options, &data);
+    options.sampleFraction = 0.25;
+    options.stream = true;
+    checkRefused("sample stream", data.fileName, NULL, &options, &data);
+    initTestOptions(&options, APRIORI_ENGINE_FP_GROWTH);
+    options.sampleFraction = 0.25;
+    options.filter = APRIORI_ITEMSETS_CLOSED;
+    checkRefused("sample closed", data.fileName, NULL, &options, &data);
+    initTestOptions(&options, APRIORI_ENGINE_HASH_TREE);
+    options.approximate = true;
+    checkRefused("approximate without sample", data.fileName, NULL, &options, &data);
+    tearDownTestData(&data);
+    return finishTests();
+}
@@ -0,0 +1,36 @@
+//
+// Checks that the shape of the hash trees, set or chosen to fit the memory budget, does not change the results.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "testing.h"
+
+int main(int argc, char *argv[]) {
+    struct TestData data;
+    if (!setUpTestData(argc, argv, "shape", &data)) {
+        return EXIT_FAILURE;
+    }
+    static const size_t fanouts[] = {2, 3, 0};
+    static const size_t leafSizes[] = {1, 2, 0};
+    // The default budget, then one too small for any tree, which the leaf size and the fanout are traded for.
+    static const size_t memoryBudgets[] = {0, 4096};
+    char name[128];
+    for (size_t f = 0; f < sizeof(fanouts) / sizeof(fanouts[0]); f++) {
+        for (size_t m = 0; m < sizeof(memoryBudgets) / sizeof(memoryBudgets[0]); m++) {
+            struct AprioriOptions options;
+            initTestOptions(&options, APRIORI_ENGINE_HASH_TREE);
+            options.fanout = fanouts[f];
+            options.leafSize = leafSizes[f];
+            if (memoryBudgets[m] > 0) {
+                options.memoryBudget = memoryBudgets[m];
+            }
+            options.numThreads = 2;
+            snprintf(name, sizeof(name), "hashtree fanout %zu leaf size %zu memory budget %zu", fanouts[f],
+                     leafSizes[f], options.memoryBudget);
+            checkRun(name, data.fileName, NULL, &options, &data.reference.all);
+        }
+    }
+    tearDownTestData(&data);
+    return finishTests();
+}
@@ -0,0 +1,65 @@
+//
+// Checks the statistics of a run: the number of frequent itemsets of every level, the transactions counted and the
+// nodes visited, and the JSON document they are written to.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "testing.h"
+#include "stats.h"
+
+int main(int argc, char *argv[]) {
+    struct TestData data;
+    if (!setUpTestData(argc, argv, "stats", &data)) {
+        return EXIT_FAILURE;
+    }
+    // The number of frequent itemsets of each size, by the reference.
+    size_t numFrequent[NUM_ITEMS + 2] = {0};
+    for (size_t i = 0; i < data.reference.all.length; i++) {
+        if (data.reference.all.entries[i].consequence == 0) {
+            numFrequent[__builtin_popcount(data.reference.all.entries[i].items)]++;
+        }
+    }
+    char statsFile[TEST_PATH_LENGTH];
+    testFileName(&data, "stats.json", statsFile);
+
+    static const enum AprioriEngine engines[] = {APRIORI_ENGINE_HASH_TREE, APRIORI_ENGINE_TRIE};
+    static const char *engineNames[] = {"hashtree", "trie"};
+    for (size_t e = 0; e < sizeof(engines) / sizeof(engines[0]); e++) {
+        const char *name = engineNames[e];
+        struct Stats stats = {0};
+        struct AprioriOptions options;
+        initTestOptions(&options, engines[e]);
+        options.numThreads = 2;
+        options.stats = &stats;
+        struct AprioriResult *result = aprioriMineFile(data.fileName, &options);
+        if (result == NULL) {
+            check(false, name, "the run failed");
+            freeStats(&stats);
+            continue;
+        }
+        check(strcmp(stats.engine, name) == 0, name, "the statistics name another engine");
+        check(stats.numTransactions == NUM_TRANSACTIONS && stats.minSupport == data.reference.minSupport, name,
+              "the statistics hold another number of transactions or minimum support");
+        bool levelsMatch = stats.numLevels + 1 < sizeof(numFrequent) / sizeof(numFrequent[0]);
+        for (size_t k = 1; levelsMatch && k <= stats.numLevels; k++) {
+            levelsMatch = stats.levels[k - 1].numFrequent == numFrequent[k];
+        }
+        check(levelsMatch && numFrequent[stats.numLevels + 1] == 0, name,
+              "the frequent itemsets of a level differ from the reference");
+        check(stats.numLevels >= 3 && stats.levels[2].nodeVisits > 0 && stats.levels[2].liveTransactions > 0, name,
+              "the nodes visited or the transactions counted in the third pass are missing");
+        check(writeStats(&stats, statsFile), name, "the statistics could not be written");
+        size_t size;
+        char *document = readFile(statsFile, &size);
+        check(size > 2 && document[0] == '{' && strstr(document, "\"levels\"") != NULL, name,
+              "the statistics are not a JSON document with levels");
+        free(document);
+        aprioriFreeResult(result);
+        freeStats(&stats);
+    }
+    remove(statsFile);
+    tearDownTestData(&data);
+    return finishTests();
+}
@@ -0,0 +1,71 @@
+//
+// Checks the streaming runs, which read the file again in every pass, on text and binary files, and that they refuse
+// malformed files.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "testing.h"
+#include "loader.h"
+
+int main(int argc, char *argv[]) {
+    struct TestData data;
+    if (!setUpTestData(argc, argv, "stream", &data)) {
+        return EXIT_FAILURE;
+    }
+    char scrambledFile[TEST_PATH_LENGTH];
+    char sparseFile[TEST_PATH_LENGTH];
+    char binaryFile[TEST_PATH_LENGTH];
+    char badFile[TEST_PATH_LENGTH];
+    testFileName(&data, "scrambled.txt", scrambledFile);
+    testFileName(&data, "sparse.txt", sparseFile);
+    testFileName(&data, "data.bin", binaryFile);
+    testFileName(&data, "bad.txt", badFile);
+    writeScrambledTransactions(scrambledFile, data.masks, 0);
+    writeScrambledTransactions(sparseFile, data.masks, SPARSE_ITEM_OFFSET);
+    struct TransactionDatabase database;
+    bool loaded = loadTransactions(data.fileName, &database);
+    check(loaded && saveTransactions(binaryFile, &database), "stream binary", "the binary file could not be written");
+    if (loaded) {
+        freeTransactions(&database);
+    }
+
+    static const enum AprioriEngine engines[] = {APRIORI_ENGINE_HASH_TREE, APRIORI_ENGINE_TRIE};
+    static const char *engineNames[] = {"hashtree", "trie"};
+    char name[128];
+    for (size_t e = 0; e < sizeof(engines) / sizeof(engines[0]); e++) {
+        struct AprioriOptions options;
+        initTestOptions(&options, engines[e]);
+        options.stream = true;
+        snprintf(name, sizeof(name), "%s stream", engineNames[e]);
+        checkRun(name, data.fileName, NULL, &options, &data.reference.all);
+        snprintf(name, sizeof(name), "%s stream unsorted and repeated items", engineNames[e]);
+        checkRun(name, scrambledFile, NULL, &options, &data.reference.all);
+        snprintf(name, sizeof(name), "%s stream binary", engineNames[e]);
+        checkRun(name, binaryFile, NULL, &options, &data.reference.all);
+        options.itemOrder = APRIORI_ITEM_ORDER_FREQUENCY;
+        options.numThreads = 3;
+        snprintf(name, sizeof(name), "%s stream -j 3 frequency order", engineNames[e]);
+        checkRun(name, scrambledFile, NULL, &options, &data.reference.all);
+    }
+
+    struct AprioriOptions options;
+    initTestOptions(&options, APRIORI_ENGINE_HASH_TREE);
+    options.stream = true;
+    static const char *malformed[] = {"1 2\n-2 4\n", "1 2\n3 x\n", "1 2\n1.5 4\n", "1,2\n", "99999999999\n"};
+    for (size_t m = 0; m < sizeof(malformed) / sizeof(malformed[0]); m++) {
+        writeFile(badFile, malformed[m], strlen(malformed[m]));
+        snprintf(name, sizeof(name), "malformed text %zu streamed", m + 1);
+        checkRefused(name, badFile, NULL, &options, &data);
+    }
+    // The supports of a stream are indexed by item number.
+    checkRefused("sparse item numbers streamed", sparseFile, NULL, &options, &data);
+
+    remove(scrambledFile);
+    remove(sparseFile);
+    remove(binaryFile);
+    remove(badFile);
+    tearDownTestData(&data);
+    return finishTests();
+}
@@ -0,0 +1,25 @@
+//
+// Checks that the hash tree engine counts the candidates the same with any number of threads.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "testing.h"
+
+int main(int argc, char *argv[]) {
+    struct TestData data;
+    if (!setUpTestData(argc, argv, "threads", &data)) {
+        return EXIT_FAILURE;
+    }
+    static const int threads[] = {1, 2, 3, 8};
+    char name[64];
+    for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+        struct AprioriOptions options;
+        initTestOptions(&options, APRIORI_ENGINE_HASH_TREE);
+        options.numThreads = threads[t];
+        snprintf(name, sizeof(name), "hashtree -j %d", threads[t]);
+        checkRun(name, data.fileName, NULL, &options, &data.reference.all);
+    }
+    tearDownTestData(&data);
+    return finishTests();
+}
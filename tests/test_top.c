@@ -0,0 +1,96 @@
+//
+// Checks the top-K runs of every engine: they must keep the K best strong rules of the reference, best first.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "testing.h"
+
+/**
+ * Gets the value a rule is ranked by in a top-K run.
+ * @param reference - The reference.
+ * @param rule - The rule.
+ * @param ranking - The measure.
+ * @return The value of the measure.
+ */
+static double rankRule(const struct Reference *reference, const struct Entry *rule, enum AprioriRuleRanking ranking) {
+    if (ranking == APRIORI_RANK_SUPPORT) {
+        return rule->support;
+    } else if (ranking == APRIORI_RANK_LIFT) {
+        return rule->confidence * NUM_TRANSACTIONS / reference->supports[rule->consequence];
+    }
+    return rule->confidence;
+}
+
+/**
+ * Runs a top-K case and checks that it keeps K strong rules, best first, none of which ranks below a rule left out.
+ * @param name - The name of the case.
+ * @param fileName - The file to mine.
+ * @param options - The options of the run.
+ * @param reference - The reference.
+ */
+static void checkTopRules(const char *name, const char *fileName, const struct AprioriOptions *options,
+                          const struct Reference *reference) {
+    struct EntryList found = {0};
+    if (!mine(fileName, NULL, options, NULL, &found)) {
+        check(false, name, "the run failed");
+        return;
+    }
+    size_t expected = options->topRules < reference->rules.length ? options->topRules : reference->rules.length;
+    check(found.length == expected, name, "the number of rules kept is wrong");
+    double worstKept = INFINITY;
+    bool ordered = true;
+    bool strong = true;
+    for (size_t r = 0; r < found.length; r++) {
+        double score = rankRule(reference, &found.entries[r], options->ranking);
+        ordered = ordered && score <= worstKept * (1 + 1e-12);
+        worstKept = score < worstKept ? score : worstKept;
+        struct Entry *match = bsearch(&found.entries[r], reference->rules.entries, reference->rules.length,
+                                      sizeof(struct Entry), compareEntries);
+        strong = strong && match != NULL && match->support == found.entries[r].support &&
+                 fabs(match->confidence - found.entries[r].confidence) <= 1e-12;
+    }
+    check(ordered, name, "the rules are not ranked best first");
+    check(strong, name, "a rule kept is not a strong rule of the reference");
+    qsort(found.entries, found.length, sizeof(struct Entry), compareEntries);
+    bool best = true;
+    for (size_t r = 0; r < reference->rules.length; r++) {
+        const struct Entry *rule = &reference->rules.entries[r];
+        if (bsearch(rule, found.entries, found.length, sizeof(struct Entry), compareEntries) == NULL) {
+            best = best && rankRule(reference, rule, options->ranking) <= worstKept * (1 + 1e-12);
+        }
+    }
+    check(best, name, "a rule left out ranks above a rule kept");
+    free(found.entries);
+}
+
+int main(int argc, char *argv[]) {
+    struct TestData data;
+    if (!setUpTestData(argc, argv, "top", &data)) {
+        return EXIT_FAILURE;
+    }
+    static const enum AprioriEngine engines[] = {APRIORI_ENGINE_HASH_TREE, APRIORI_ENGINE_TRIE, APRIORI_ENGINE_BITSET,
+                                                 APRIORI_ENGINE_FP_GROWTH};
+    static const char *engineNames[] = {"hashtree", "trie", "bitset", "fpgrowth"};
+    static const enum AprioriRuleRanking rankings[] = {APRIORI_RANK_CONFIDENCE, APRIORI_RANK_LIFT,
+                                                       APRIORI_RANK_SUPPORT};
+    static const char *rankingNames[] = {"confidence", "lift", "support"};
+    static const size_t topRules[] = {1, 25, 100000};
+    char name[64];
+    for (size_t e = 0; e < sizeof(engines) / sizeof(engines[0]); e++) {
+        for (size_t r = 0; r < sizeof(rankings) / sizeof(rankings[0]); r++) {
+            for (size_t k = 0; k < sizeof(topRules) / sizeof(topRules[0]); k++) {
+                struct AprioriOptions options;
+                initTestOptions(&options, engines[e]);
+                options.numThreads = 2;
+                options.topRules = topRules[k];
+                options.ranking = rankings[r];
+                snprintf(name, sizeof(name), "%s top %zu by %s", engineNames[e], topRules[k], rankingNames[r]);
+                checkTopRules(name, data.fileName, &options, &data.reference);
+            }
+        }
+    }
+    tearDownTestData(&data);
+    return finishTests();
+}
@@ -0,0 +1,31 @@
+//
+// Checks that the prefix trie engine counts the candidates like the hash tree, with any number of threads and in
+// either order of the item codes, which changes the prefixes the candidates share.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "testing.h"
+
+int main(int argc, char *argv[]) {
+    struct TestData data;
+    if (!setUpTestData(argc, argv, "trie", &data)) {
+        return EXIT_FAILURE;
+    }
+    static const enum AprioriItemOrder orders[] = {APRIORI_ITEM_ORDER_ID, APRIORI_ITEM_ORDER_FREQUENCY};
+    static const char *orderNames[] = {"id", "frequency"};
+    static const int threads[] = {1, 2, 3, 8};
+    char name[64];
+    for (size_t o = 0; o < sizeof(orders) / sizeof(orders[0]); o++) {
+        for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+            struct AprioriOptions options;
+            initTestOptions(&options, APRIORI_ENGINE_TRIE);
+            options.itemOrder = orders[o];
+            options.numThreads = threads[t];
+            snprintf(name, sizeof(name), "trie %s order -j %d", orderNames[o], threads[t]);
+            checkRun(name, data.fileName, NULL, &options, &data.reference.all);
+        }
+    }
+    tearDownTestData(&data);
+    return finishTests();
+}
@@ -0,0 +1,489 @@
+//
+// The helpers of the tests: generates the dataset, finds its frequent, closed and maximal itemsets and its strong
+// rules by counting every subset of every transaction, and compares the results of the library with them.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "testing.h"
+
+// The number of checks that failed.
+static int numFailures = 0;
+
+/**
+ * Records the outcome of a check, and prints it if it failed.
+ * @param passed - true if the check passed.
+ * @param name - The name of the case.
+ * @param what - What was checked.
+ */
+void check(bool passed, const char *name, const char *what) {
+    if (!passed) {
+        printf("FAILED %s: %s\n", name, what);
+        numFailures++;
+    }
+}
+
+/**
+ * Prints the outcome of the checks of a test.
+ * @return The exit status of the test.
+ */
+int finishTests(void) {
+    if (numFailures > 0) {
+        printf("%d checks failed\n", numFailures);
+        return EXIT_FAILURE;
+    }
+    printf("All checks passed\n");
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Draws the next number of a linear congruential generator, so that the dataset is the same on every platform.
+ * @param state - The state of the generator.
+ * @return A number between 0 and 2^31 - 1.
+ */
+static uint32_t nextRandom(uint64_t *state) {
+    *state = *state * 6364136223846793005ull + 1442695040888963407ull;
+    return (uint32_t) (*state >> 33);
+}
+
+/**
+ * Gets the item number of a bit.
+ * @param bit - The bit.
+ * @return The item number written in the files.
+ */
+uint32_t itemNumber(int bit) {
+    return bit == NUM_ITEMS ? RARE_ITEM : (uint32_t) (3 * bit + 1);
+}
+
+/**
+ * Gets the bit of an item number.
+ * @param item - The item number, possibly offset by SPARSE_ITEM_OFFSET.
+ * @return The bit standing for it.
+ */
+uint32_t itemBit(uint32_t item) {
+    if (item >= SPARSE_ITEM_OFFSET) {
+        item -= SPARSE_ITEM_OFFSET;
+    }
+    return item == RARE_ITEM ? 1u << NUM_ITEMS : 1u << ((item - 1) / 3);
+}
+
+/**
+ * Generates the transactions of the dataset: a few patterns, whose items mostly occur together, and noise. One
+ * transaction is empty and one holds the rare item.
+ * @param masks - Set to the items of every transaction.
+ */
+static void generateTransactions(uint32_t *masks) {
+    static const uint32_t patterns[] = {0x1f, 0x1e0, 0xe04, 0x7000, 0xf8000};
+    size_t numPatterns = sizeof(patterns) / sizeof(patterns[0]);
+    uint64_t state = 42;
+    for (size_t t = 0; t < NUM_TRANSACTIONS; t++) {
+        uint32_t mask = 0;
+        for (size_t p = 0; p < numPatterns; p++) {
+            if (nextRandom(&state) % 100 < 30) {
+                for (int b = 0; b < NUM_ITEMS; b++) {
+                    if ((patterns[p] & (1u << b)) && nextRandom(&state) % 100 < 85) {
+                        mask |= 1u << b;
+                    }
+                }
+            }
+        }
+        size_t numNoise = nextRandom(&state) % 3;
+        for (size_t n = 0; n < numNoise; n++) {
+            mask |= 1u << (nextRandom(&state) % NUM_ITEMS);
+        }
+        while (__builtin_popcount(mask) > MAX_TRANSACTION_LENGTH - 1) {
+            mask &= ~(1u << (31 - __builtin_clz(mask)));
+        }
+        masks[t] = mask;
+    }
+    masks[NUM_TRANSACTIONS / 2] |= 1u << NUM_ITEMS;
+    masks[NUM_TRANSACTIONS / 3] = 0;
+}
+
+/**
+ * Writes transactions to a text file, separating the items of some lines by tabs and ending some with CRLF.
+ * @param fileName - The file to write.
+ * @param masks - The items of the transactions.
+ * @param first - The first transaction to write.
+ * @param last - The transaction following the last one to write.
+ */
+void writeTransactions(const char *fileName, const uint32_t *masks, size_t first, size_t last) {
+    FILE *file = fopen(fileName, "w");
+    if (file == NULL) {
+        printf("File '%s' could not be created.\n", fileName);
+        exit(EXIT_FAILURE);
+    }
+    for (size_t t = first; t < last; t++) {
+        const char *separator = "";
+        for (int b = 0; b <= NUM_ITEMS; b++) {
+            if (masks[t] & (1u << b)) {
+                fprintf(file, "%s%u", separator, itemNumber(b));
+                separator = t % 7 == 0 ? "\t" : " ";
+            }
+        }
+        fputs(t % 11 == 0 ? "\r\n" : "\n", file);
+    }
+    fclose(file);
+}
+
+/**
+ * Writes the transactions of the dataset with the items of every line in decreasing order, some of them repeated.
+ * @param fileName - The file to write.
+ * @param masks - The items of the transactions.
+ * @param offset - The number added to every item number.
+ */
+void writeScrambledTransactions(const char *fileName, const uint32_t *masks, uint32_t offset) {
+    FILE *file = fopen(fileName, "w");
+    if (file == NULL) {
+        printf("File '%s' could not be created.\n", fileName);
+        exit(EXIT_FAILURE);
+    }
+    for (size_t t = 0; t < NUM_TRANSACTIONS; t++) {
+        for (int b = NUM_ITEMS; b >= 0; b--) {
+            if (masks[t] & (1u << b)) {
+                fprintf(file, t % 3 == 0 ? "%u %u " : "%u ", itemNumber(b) + offset, itemNumber(b) + offset);
+            }
+        }
+        fputs("\n", file);
+    }
+    fclose(file);
+}
+
+/**
+ * Writes a file.
+ * @param fileName - The file.
+ * @param content - Its content.
+ * @param size - The size of the content.
+ */
+void writeFile(const char *fileName, const void *content, size_t size) {
+    FILE *file = fopen(fileName, "wb");
+    if (file == NULL || fwrite(content, 1, size, file) != size) {
+        printf("File '%s' could not be written.\n", fileName);
+        exit(EXIT_FAILURE);
+    }
+    fclose(file);
+}
+
+/**
+ * Reads a whole file.
+ * @param fileName - The file.
+ * @param size - Set to its size.
+ * @return Its content, followed by a null character.
+ */
+char *readFile(const char *fileName, size_t *size) {
+    FILE *file = fopen(fileName, "rb");
+    if (file == NULL) {
+        printf("File '%s' could not be read.\n", fileName);
+        exit(EXIT_FAILURE);
+    }
+    fseek(file, 0, SEEK_END);
+    *size = (size_t) ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *data = malloc(*size + 1);
+    if (fread(data, 1, *size, file) != *size) {
+        printf("File '%s' could not be read.\n", fileName);
+        exit(EXIT_FAILURE);
+    }
+    data[*size] = '\0';
+    fclose(file);
+    return data;
+}
+
+/**
+ * Adds an itemset or a rule to a list.
+ * @param list - The list.
+ * @param items - The itemset, or the antecedent of the rule.
+ * @param consequence - The consequence of the rule, or 0.
+ * @param support - The support of the itemset the entry comes from.
+ * @param confidence - The confidence of the rule, or 0.
+ */
+void addEntry(struct EntryList *list, uint32_t items, uint32_t consequence, uint32_t support, double confidence) {
+    if (list->length == list->capacity) {
+        list->capacity = list->capacity == 0 ? 256 : list->capacity * 2;
+        list->entries = realloc(list->entries, list->capacity * sizeof(struct Entry));
+    }
+    struct Entry entry = {items, consequence, support, confidence};
+    list->entries[list->length++] = entry;
+}
+
+/**
+ * Compares two entries by their itemsets, for use with qsort.
+ */
+int compareEntries(const void *a, const void *b) {
+    const struct Entry *x = a;
+    const struct Entry *y = b;
+    if (x->items != y->items) {
+        return x->items < y->items ? -1 : 1;
+    }
+    if (x->consequence != y->consequence) {
+        return x->consequence < y->consequence ? -1 : 1;
+    }
+    return 0;
+}
+
+/**
+ * Adds the strong rules between the itemsets of a list whose antecedent is also in it, as the library generates them.
+ * @param reference - The reference, whose supports are counted.
+ * @param list - The itemsets, to which their rules are added.
+ * @param member - Marks the itemsets of the list, indexed by their bits.
+ */
+static void addReferenceRules(struct Reference *reference, struct EntryList *list, const bool *member) {
+    size_t numItemsets = list->length;
+    for (size_t i = 0; i < numItemsets; i++) {
+        uint32_t itemset = list->entries[i].items;
+        // Every non-empty proper subset of the itemset is an antecedent.
+        for (uint32_t antecedent = (itemset - 1) & itemset; antecedent > 0; antecedent = (antecedent - 1) & itemset) {
+            if (!member[antecedent]) {
+                continue;
+            }
+            double confidence = (double) reference->supports[itemset] / (double) reference->supports[antecedent];
+            if (confidence >= TEST_MIN_CONFIDENCE) {
+                addEntry(list, antecedent, itemset ^ antecedent, reference->supports[itemset], confidence);
+                if (list == &reference->all) {
+                    addEntry(&reference->rules, antecedent, itemset ^ antecedent, reference->supports[itemset],
+                             confidence);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Finds the frequent, closed and maximal itemsets and the strong rules of transactions by counting every subset of
+ * every transaction.
+ * @param masks - The items of the transactions.
+ * @param reference - The reference to fill.
+ */
+static void buildReference(const uint32_t *masks, struct Reference *reference) {
+    size_t numSets = (size_t) 1 << (NUM_ITEMS + 1);
+    memset(reference, 0, sizeof(struct Reference));
+    reference->supports = calloc(numSets, sizeof(uint32_t));
+    for (size_t t = 0; t < NUM_TRANSACTIONS; t++) {
+        for (uint32_t subset = masks[t]; subset > 0; subset = (subset - 1) & masks[t]) {
+            reference->supports[subset]++;
+        }
+    }
+    // The minimum support count of the library.
+    reference->minSupport = (uint32_t) (TEST_MIN_SUPPORT * NUM_TRANSACTIONS + 0.5);
+
+    bool *frequent = calloc(numSets, sizeof(bool));
+    bool *closed = calloc(numSets, sizeof(bool));
+    bool *maximal = calloc(numSets, sizeof(bool));
+    for (uint32_t set = 1; set < numSets; set++) {
+        frequent[set] = reference->supports[set] >= reference->minSupport;
+    }
+    for (uint32_t set = 1; set < numSets; set++) {
+        if (!frequent[set]) {
+            continue;
+        }
+        closed[set] = true;
+        maximal[set] = true;
+        for (int b = 0; b <= NUM_ITEMS; b++) {
+            uint32_t superset = set | (1u << b);
+            if (superset != set && frequent[superset]) {
+                maximal[set] = false;
+                closed[set] = closed[set] && reference->supports[superset] != reference->supports[set];
+            }
+        }
+        addEntry(&reference->all, set, 0, reference->supports[set], 0);
+        if (closed[set]) {
+            addEntry(&reference->closed, set, 0, reference->supports[set], 0);
+        }
+        if (maximal[set]) {
+            addEntry(&reference->maximal, set, 0, reference->supports[set], 0);
+        }
+    }
+    addReferenceRules(reference, &reference->all, frequent);
+    addReferenceRules(reference, &reference->closed, closed);
+    qsort(reference->rules.entries, reference->rules.length, sizeof(struct Entry), compareEntries);
+    free(frequent);
+    free(closed);
+    free(maximal);
+}
+
+/**
+ * Builds the name of a temporary file of a test.
+ * @param data - The dataset of the test.
+ * @param suffix - The end of the name.
+ * @param fileName - Set to the name, TEST_PATH_LENGTH characters at most.
+ */
+void testFileName(const struct TestData *data, const char *suffix, char *fileName) {
+    snprintf(fileName, TEST_PATH_LENGTH, "%s/%s-%s", data->directory, data->prefix, suffix);
+}
+
+/**
+ * Generates the dataset of a test, writes it to a text file and finds its reference.
+ * @param argc - The number of arguments of the test.
+ * @param argv - The arguments of the test: the directory of the temporary files.
+ * @param prefix - The prefix of the temporary files of the test, which keeps the tests run at once apart.
+ * @param data - The dataset to fill.
+ * @return true if the arguments were valid.
+ */
+bool setUpTestData(int argc, char *argv[], const char *prefix, struct TestData *data) {
+    if (argc != 2) {
+        printf("Usage: %s <directory for the temporary files>\n", argv[0]);
+        return false;
+    }
+    data->directory = argv[1];
+    data->prefix = prefix;
+    testFileName(data, "data.txt", data->fileName);
+    generateTransactions(data->masks);
+    writeTransactions(data->fileName, data->masks, 0, NUM_TRANSACTIONS);
+    buildReference(data->masks, &data->reference);
+    return true;
+}
+
+/**
+ * Removes the file of the dataset of a test and frees its reference.
+ * @param data - The dataset.
+ */
+void tearDownTestData(struct TestData *data) {
+    remove(data->fileName);
+    free(data->reference.supports);
+    free(data->reference.all.entries);
+    free(data->reference.closed.entries);
+    free(data->reference.maximal.entries);
+    free(data->reference.rules.entries);
+}
+
+/**
+ * Sets the options of a run over the dataset with an engine, at the minimum support and confidence of the reference.
+ * @param options - The options to set.
+ * @param engine - The engine.
+ */
+void initTestOptions(struct AprioriOptions *options, enum AprioriEngine engine) {
+    aprioriInitOptions(options);
+    options->engine = engine;
+    options->minSupport = TEST_MIN_SUPPORT;
+    options->minConfidence = TEST_MIN_CONFIDENCE;
+}
+
+/**
+ * Receives a frequent itemset of a run into a list.
+ */
+static void collectItemset(const uint32_t *items, size_t size, uint32_t support, void *context) {
+    uint32_t set = 0;
+    for (size_t i = 0; i < size; i++) {
+        set |= itemBit(items[i]);
+    }
+    addEntry(context, set, 0, support, 0);
+}
+
+/**
+ * Receives a strong rule of a run into a list.
+ */
+static void collectRule(const uint32_t *antecedent, size_t antecedentSize, const uint32_t *consequent,
+                        size_t consequentSize, uint32_t support, double confidence, void *context) {
+    uint32_t items = 0;
+    uint32_t consequence = 0;
+    for (size_t i = 0; i < antecedentSize; i++) {
+        items |= itemBit(antecedent[i]);
+    }
+    for (size_t i = 0; i < consequentSize; i++) {
+        consequence |= itemBit(consequent[i]);
+    }
+    addEntry(context, items, consequence, support, confidence);
+}
+
+/**
+ * Mines a file or transactions held in memory.
+ * @param fileName - The file, or NULL to mine the transactions.
+ * @param transactions - The transactions held in memory, if fileName is NULL.
+ * @param options - The options of the run.
+ * @param itemsets - The list to add the itemsets to, or NULL.
+ * @param rules - The list to add the rules to.
+ * @return true if the run succeeded.
+ */
+bool mine(const char *fileName, const struct AprioriTransactions *transactions, const struct AprioriOptions *options,
+          struct EntryList *itemsets, struct EntryList *rules) {
+    struct AprioriResult *result = fileName != NULL ? aprioriMineFile(fileName, options)
+                                                    : aprioriMineTransactions(transactions, options);
+    if (result == NULL) {
+        return false;
+    }
+    if (itemsets != NULL) {
+        aprioriForEachItemset(result, collectItemset, itemsets);
+    }
+    aprioriForEachRule(result, collectRule, rules);
+    aprioriFreeResult(result);
+    return true;
+}
+
+/**
+ * Checks whether two lists hold the same itemsets and rules, with the same supports and confidences.
+ * @param a - The first list, sorted here.
+ * @param b - The second list, sorted here.
+ * @return true if the lists are equal.
+ */
+static bool sameEntries(struct EntryList *a, struct EntryList *b) {
+    if (a->length != b->length) {
+        return false;
+    }
+    qsort(a->entries, a->length, sizeof(struct Entry), compareEntries);
+    qsort(b->entries, b->length, sizeof(struct Entry), compareEntries);
+    for (size_t i = 0; i < a->length; i++) {
+        if (compareEntries(&a->entries[i], &b->entries[i]) != 0 || a->entries[i].support != b->entries[i].support ||
+            fabs(a->entries[i].confidence - b->entries[i].confidence) > 1e-12) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Runs a case and checks that it finds the expected itemsets and rules.
+ * @param name - The name of the case.
+ * @param fileName - The file to mine, or NULL to mine the transactions.
+ * @param transactions - The transactions held in memory, if fileName is NULL.
+ * @param options - The options of the run.
+ * @param expected - The itemsets and rules expected.
+ */
+void checkRun(const char *name, const char *fileName, const struct AprioriTransactions *transactions,
+              const struct AprioriOptions *options, const struct EntryList *expected) {
+    struct EntryList found = {0};
+    if (!mine(fileName, transactions, options, &found, &found)) {
+        check(false, name, "the run failed");
+        return;
+    }
+    struct EntryList copy = {malloc((expected->length + 1) * sizeof(struct Entry)), expected->length, 0};
+    memcpy(copy.entries, expected->entries, expected->length * sizeof(struct Entry));
+    check(sameEntries(&found, &copy), name, "the itemsets and rules differ from the reference");
+    free(found.entries);
+    free(copy.entries);
+}
+
+/**
+ * Runs a case that must be refused, and checks that it fails without writing to the standard output.
+ * @param name - The name of the case.
+ * @param fileName - The file to mine, or NULL to mine the transactions.
+ * @param transactions - The transactions held in memory, if fileName is NULL.
+ * @param options - The options of the run.
+ * @param data - The dataset of the test, whose directory receives the standard output of the run.
+ */
+void checkRefused(const char *name, const char *fileName, const struct AprioriTransactions *transactions,
+                  const struct AprioriOptions *options, const struct TestData *data) {
+    char capture[TEST_PATH_LENGTH];
+    testFileName(data, "stdout.txt", capture);
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int fd = open(capture, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    dup2(fd, STDOUT_FILENO);
+    close(fd);
+    struct AprioriResult *result = fileName != NULL ? aprioriMineFile(fileName, options)
+                                                    : aprioriMineTransactions(transactions, options);
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    check(result == NULL, name, "the run was not refused");
+    aprioriFreeResult(result);
+    FILE *file = fopen(capture, "r");
+    check(file != NULL && fgetc(file) == EOF, name, "the library wrote to the standard output");
+    if (file != NULL) {
+        fclose(file);
+    }
+    remove(capture);
+}
@@ -0,0 +1,90 @@
+//
+// The helpers of the tests: a small generated dataset, the frequent itemsets and strong rules a brute-force search
+// finds in it, and the comparison of the results of the library with them. Every test program takes the directory of
+// its temporary files as its only argument, and exits with EXIT_FAILURE if a check failed.
+//
+
+#ifndef APRIORI_TESTING_H
+#define APRIORI_TESTING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "libapriori.h"
+
+// The number of transactions of the dataset.
+#define NUM_TRANSACTIONS 400
+
+// The number of common items; item i is numbered 3 * i + 1 in the files, so the numbers are sparse.
+#define NUM_ITEMS 20
+
+// The item number of an item that occurs once, so that it is dropped after the first pass.
+#define RARE_ITEM 1000
+
+// The most items a transaction holds, which bounds the subsets the reference enumerates.
+#define MAX_TRANSACTION_LENGTH 10
+
+// Added to the item numbers of a file to make them sparse; itemBit reads both.
+#define SPARSE_ITEM_OFFSET 4000000000u
+
+#define TEST_MIN_SUPPORT 0.05
+#define TEST_MIN_CONFIDENCE 0.6
+
+// The length of the names of the temporary files.
+#define TEST_PATH_LENGTH 4096
+
+// Represents a frequent itemset or a rule as sets of bits, bit i standing for item i and bit NUM_ITEMS for RARE_ITEM.
+struct Entry {
+    uint32_t items;       // The itemset, or the antecedent of a rule.
+    uint32_t consequence; // The consequence of a rule, 0 for an itemset.
+    uint32_t support;
+    double confidence;    // The confidence of a rule, 0 for an itemset.
+};
+
+// Represents a list of itemsets and rules.
+struct EntryList {
+    struct Entry *entries;
+    size_t length;
+    size_t capacity;
+};
+
+// Represents the frequent itemsets and strong rules a run over the dataset is expected to find.
+struct Reference {
+    uint32_t *supports;       // The support of every set of items.
+    uint32_t minSupport;
+    struct EntryList all;     // Every frequent itemset and strong rule.
+    struct EntryList closed;  // The closed itemsets and the rules between them.
+    struct EntryList maximal; // The maximal itemsets.
+    struct EntryList rules;   // The strong rules, sorted.
+};
+
+// Represents the dataset of a test: its transactions, written to a text file, and the reference of their results.
+struct TestData {
+    const char *directory;               // The directory of the temporary files.
+    const char *prefix;                  // The prefix of the temporary files of the test.
+    char fileName[TEST_PATH_LENGTH];     // The text file of the transactions.
+    uint32_t masks[NUM_TRANSACTIONS];    // The items of each transaction.
+    struct Reference reference;
+};
+
+void check(bool passed, const char *name, const char *what);
+int finishTests(void);
+uint32_t itemNumber(int bit);
+uint32_t itemBit(uint32_t item);
+void testFileName(const struct TestData *data, const char *suffix, char *fileName);
+bool setUpTestData(int argc, char *argv[], const char *prefix, struct TestData *data);
+void tearDownTestData(struct TestData *data);
+void writeTransactions(const char *fileName, const uint32_t *masks, size_t first, size_t last);
+void writeScrambledTransactions(const char *fileName, const uint32_t *masks, uint32_t offset);
+void writeFile(const char *fileName, const void *content, size_t size);
+char *readFile(const char *fileName, size_t *size);
+void initTestOptions(struct AprioriOptions *options, enum AprioriEngine engine);
+void addEntry(struct EntryList *list, uint32_t items, uint32_t consequence, uint32_t support, double confidence);
+int compareEntries(const void *a, const void *b);
+bool mine(const char *fileName, const struct AprioriTransactions *transactions, const struct AprioriOptions *options,
+          struct EntryList *itemsets, struct EntryList *rules);
+void checkRun(const char *name, const char *fileName, const struct AprioriTransactions *transactions,
+              const struct AprioriOptions *options, const struct EntryList *expected);
+void checkRefused(const char *name, const char *fileName, const struct AprioriTransactions *transactions,
+                  const struct AprioriOptions *options, const struct TestData *data);
+#endif //APRIORI_TESTING_H
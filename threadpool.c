@@ -0,0 +1,164 @@
+//
+// A thread pool for parallel loops. The calling thread takes part in every loop as thread 0, and the tasks are handed
+// out one at a time, so uneven tasks are balanced between the threads.
+//
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "threadpool.h"
+
+// Represents a pool of threads along with the loop they are currently running.
+struct ThreadPool {
+    int numThreads;           // The number of threads, including the calling thread.
+    pthread_t *threads;
+    pthread_mutex_t mutex;
+    pthread_cond_t workReady;
+    pthread_cond_t workDone;
+    unsigned long generation; // Incremented every time a new loop is started.
+    bool shutdown;
+    int numBusy;              // The number of workers that have not finished the current loop.
+
+    ParallelTask task;
+    void *context;
+    size_t numTasks;
+    atomic_size_t nextTask;
+};
+
+// The arguments of a worker thread.
+struct PoolWorker {
+    struct ThreadPool *pool;
+    int thread;
+};
+
+/**
+ * Runs tasks of the current loop until there are none left.
+ * @param pool - The pool running the loop.
+ * @param thread - The index of the thread running the tasks.
+ */
+static void runTasks(struct ThreadPool *pool, int thread) {
+    size_t taskIndex;
+    while ((taskIndex = atomic_fetch_add(&pool->nextTask, 1)) < pool->numTasks) {
+        pool->task(pool->context, taskIndex, thread);
+    }
+}
+
+/**
+ * The main function of the worker threads: waits for a loop to start, takes part in it, and waits for the next one.
+ * @param arg - The PoolWorker describing the thread.
+ * @return NULL
+ */
+static void *poolWorker(void *arg) {
+    struct PoolWorker *worker = arg;
+    struct ThreadPool *pool = worker->pool;
+    unsigned long seen = 0;
+    while (true) {
+        pthread_mutex_lock(&pool->mutex);
+        while (pool->generation == seen && !pool->shutdown) {
+            pthread_cond_wait(&pool->workReady, &pool->mutex);
+        }
+        if (pool->shutdown) {
+            pthread_mutex_unlock(&pool->mutex);
+            break;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->mutex);
+
+        runTasks(pool, worker->thread);
+
+        pthread_mutex_lock(&pool->mutex);
+        pool->numBusy--;
+        if (pool->numBusy == 0) {
+            pthread_cond_signal(&pool->workDone);
+        }
+        pthread_mutex_unlock(&pool->mutex);
+    }
+    free(worker);
+    return NULL;
+}
+
+/**
+ * Creates a thread pool.
+ * @param numThreads - The number of threads to run loops with, including the calling thread.
+ * @return The new pool. It may have fewer threads than requested if the system refused to create them.
+ */
+struct ThreadPool *createThreadPool(int numThreads) {
+    struct ThreadPool *pool = calloc(1, sizeof(struct ThreadPool));
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->workReady, NULL);
+    pthread_cond_init(&pool->workDone, NULL);
+    pool->threads = calloc((size_t) (numThreads > 1 ? numThreads - 1 : 1), sizeof(pthread_t));
+    pool->numThreads = 1;
+    for (int t = 1; t < numThreads; t++) {
+        struct PoolWorker *worker = malloc(sizeof(struct PoolWorker));
+        worker->pool = pool;
+        worker->thread = t;
+        if (pthread_create(&pool->threads[t - 1], NULL, poolWorker, worker) != 0) {
+            free(worker);
+            break;
+        }
+        pool->numThreads++;
+    }
+    return pool;
+}
+
+/**
+ * Gets the number of threads of a pool.
+ * @param pool - The pool.
+ * @return The number of threads, including the calling thread.
+ */
+int threadPoolSize(struct ThreadPool *pool) {
+    return pool->numThreads;
+}
+
+/**
+ * Runs a parallel loop, returning once every task has been run.
+ * @param pool - The pool to run the loop with.
+ * @param numTasks - The number of tasks in the loop.
+ * @param task - The function running a task.
+ * @param context - The argument passed to every task.
+ */
+void runParallel(struct ThreadPool *pool, size_t numTasks, ParallelTask task, void *context) {
+    pool->task = task;
+    pool->context = context;
+    pool->numTasks = numTasks;
+    atomic_store(&pool->nextTask, 0);
+    if (pool->numThreads == 1 || numTasks <= 1) {
+        runTasks(pool, 0);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->numBusy = pool->numThreads - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->workReady);
+    pthread_mutex_unlock(&pool->mutex);
+
+    runTasks(pool, 0);
+
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->numBusy > 0) {
+        pthread_cond_wait(&pool->workDone, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+/**
+ * Stops the threads of a pool and frees it.
+ * @param pool - The pool to destroy.
+ */
+void destroyThreadPool(struct ThreadPool *pool) {
+    pthread_mutex_lock(&pool->mutex);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->workReady);
+    pthread_mutex_unlock(&pool->mutex);
+    for (int t = 1; t < pool->numThreads; t++) {
+        pthread_join(pool->threads[t - 1], NULL);
+    }
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_cond_destroy(&pool->workReady);
+    pthread_cond_destroy(&pool->workDone);
+    free(pool->threads);
+    free(pool);
+}
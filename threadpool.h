@@ -0,0 +1,19 @@
+//
+// A fixed pool of worker threads that run the tasks of a parallel loop.
+//
+
+#ifndef APRIORI_THREADPOOL_H
+#define APRIORI_THREADPOOL_H
+
+#include <stddef.h>
+
+struct ThreadPool;
+
+// A task of a parallel loop. thread is the index of the thread running it, between 0 and the number of threads - 1.
+typedef void (*ParallelTask)(void *context, size_t taskIndex, int thread);
+
+struct ThreadPool *createThreadPool(int numThreads);
+int threadPoolSize(struct ThreadPool *pool);
+void runParallel(struct ThreadPool *pool, size_t numTasks, ParallelTask task, void *context);
+void destroyThreadPool(struct ThreadPool *pool);
+#endif //APRIORI_THREADPOOL_H
@@ -0,0 +1,248 @@
+//
+// A prefix trie of candidate itemsets, after Bodon (2003). Every prefix shared by candidates is a single node, whose
+// children are kept sorted by item in one contiguous array, so a transaction is matched against a prefix once for all
+// the candidates that extend it, by merging the children with the rest of the transaction. The trie is built at once
+// from the candidates, and counted with an explicit stack instead of recursion.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "trie.h"
+
+// The number of children above which the next child matching an item is found by binary search rather than by
+// stepping through them.
+#define TRIE_SEARCH_THRESHOLD 8
+
+/**
+ * Compares two candidates of the same size lexicographically, for use with qsort.
+ */
+static int compareCandidates(const void *a, const void *b) {
+    const struct Itemset *x = *(struct Itemset *const *) a;
+    const struct Itemset *y = *(struct Itemset *const *) b;
+    for (size_t i = 0; i < x->size; i++) {
+        if (x->items[i] != y->items[i]) {
+            return x->items[i] < y->items[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Gets the length of the prefix two candidates share.
+ * @param a - The first candidate.
+ * @param b - The second candidate.
+ * @param k - The size of the candidates.
+ * @return The number of leading items they have in common.
+ */
+static size_t sharedPrefix(const struct Itemset *a, const struct Itemset *b, size_t k) {
+    size_t p = 0;
+    while (p < k && a->items[p] == b->items[p]) {
+        p++;
+    }
+    return p;
+}
+
+/**
+ * Finds the first of a range of children whose item is not below an item.
+ * @param items - The items of the nodes.
+ * @param first - The first child of the range.
+ * @param end - The end of the range.
+ * @param item - The item to find.
+ * @return The child, or end if every child is below the item.
+ */
+static inline uint32_t lowerBound(const uint32_t *items, uint32_t first, uint32_t end, uint32_t item) {
+    while (first < end) {
+        uint32_t middle = first + (end - first) / 2;
+        if (items[middle] < item) {
+            first = middle + 1;
+        } else {
+            end = middle;
+        }
+    }
+    return first;
+}
+
+/**
+ * Creates a trie holding candidate itemsets.
+ * @param candidates - The candidates, distinct and all of size k; sorted here unless they are in lexicographic order.
+ * @param numCandidates - The number of candidates.
+ * @param k - The size of the candidates.
+ * @param arena - The arena to allocate the trie from; the trie is freed when the arena is destroyed.
+ * @return The trie.
+ */
+struct CandidateTrie *createCandidateTrie(struct Itemset **candidates, size_t numCandidates, size_t k,
+                                          struct Arena *arena) {
+    struct CandidateTrie *trie = arenaAlloc(arena, sizeof(struct CandidateTrie));
+    trie->k = k;
+    struct Itemset **sorted = arenaAlloc(arena, (numCandidates + 1) * sizeof(struct Itemset *));
+    memcpy(sorted, candidates, numCandidates * sizeof(struct Itemset *));
+    for (size_t i = 1; i < numCandidates; i++) {
+        if (compareCandidates(&sorted[i - 1], &sorted[i]) > 0) {
+            qsort(sorted, numCandidates, sizeof(struct Itemset *), compareCandidates);
+            break;
+        }
+    }
+
+    // A candidate adds a node at every depth past the prefix it shares with the previous one.
+    size_t *depthStart = calloc(k + 2, sizeof(size_t));
+    size_t *current = calloc(k + 1, sizeof(size_t));
+    depthStart[1] = 1;
+    for (size_t i = 0; i < numCandidates; i++) {
+        size_t p = i == 0 ? 0 : sharedPrefix(sorted[i - 1], sorted[i], k);
+        for (size_t d = p + 1; d <= k; d++) {
+            depthStart[d + 1]++;
+        }
+    }
+    for (size_t d = 1; d <= k; d++) {
+        depthStart[d + 1] += depthStart[d];
+    }
+    trie->numNodes = depthStart[k + 1];
+    trie->firstLeaf = depthStart[k];
+    trie->numLeaves = trie->numNodes - trie->firstLeaf;
+    trie->items = arenaCalloc(arena, trie->numNodes, sizeof(uint32_t));
+    trie->firstChild = arenaAlloc(arena, (trie->numNodes + 1) * sizeof(uint32_t));
+    trie->leaves = arenaAlloc(arena, (trie->numLeaves + 1) * sizeof(struct Itemset *));
+    trie->leafIds = arenaAlloc(arena, (trie->numLeaves + 1) * sizeof(uint32_t));
+
+    // Number the nodes of every depth in the order of their prefixes, which keeps the children of a node together.
+    for (size_t d = 1; d <= k; d++) {
+        current[d] = depthStart[d] - 1;
+    }
+    trie->firstChild[0] = 1;
+    for (size_t i = 0; i < numCandidates; i++) {
+        size_t p = i == 0 ? 0 : sharedPrefix(sorted[i - 1], sorted[i], k);
+        for (size_t d = p + 1; d <= k; d++) {
+            size_t node = ++current[d];
+            trie->items[node] = sorted[i]->items[d - 1];
+            if (d - 1 > p) {
+                // The parent was created for this candidate, so this is its first child.
+                trie->firstChild[current[d - 1]] = (uint32_t) node;
+            }
+            if (d == k) {
+                trie->leaves[node - trie->firstLeaf] = sorted[i];
+                trie->leafIds[node - trie->firstLeaf] = sorted[i]->id;
+            }
+        }
+    }
+    for (size_t node = trie->firstLeaf; node <= trie->numNodes; node++) {
+        trie->firstChild[node] = (uint32_t) trie->numNodes;
+    }
+
+    // Index the children of the root by their item, which are in increasing order.
+    trie->numRootItems = depthStart[2] > 1 ? trie->items[depthStart[2] - 1] + 1 : 0;
+    trie->rootChild = arenaAlloc(arena, (trie->numRootItems + 1) * sizeof(uint32_t));
+    memset(trie->rootChild, 0xff, (trie->numRootItems + 1) * sizeof(uint32_t));
+    for (size_t node = 1; node < depthStart[2]; node++) {
+        trie->rootChild[trie->items[node]] = (uint32_t) node;
+    }
+    free(depthStart);
+    free(current);
+    return trie;
+}
+
+/**
+ * Counts the candidates of a trie contained in a transaction. The child of the root is looked up for every item that
+ * can start a candidate, and its subtrie walked depth first: the children of a node are merged with the items of the
+ * transaction after the ones matched by its prefix, and every match is either a leaf, whose candidate is counted, or a
+ * node whose children are matched next.
+ * @param trie - The trie.
+ * @param transaction - The transaction, whose items are in increasing order.
+ * @param stack - The room for the walk, k frames.
+ * @param supports - The counters of the candidates, indexed by their id.
+ * @param nodeVisits - Incremented by the number of nodes reached, leaves included.
+ * @param itemComparisons - Incremented by the number of items compared.
+ * @param found - Called with the id of every candidate contained in the transaction, or NULL.
+ * @param context - Passed to found.
+ * @return The number of candidates contained in the transaction.
+ */
+uint32_t countTrie(const struct CandidateTrie *trie, const struct Transaction *transaction, struct TrieFrame *stack,
+                   uint32_t *supports, uint64_t *nodeVisits, uint64_t *itemComparisons, TrieMatchCallback found,
+                   void *context) {
+    const uint32_t *items = transaction->items;
+    size_t k = trie->k;
+    uint32_t numMatches = 0;
+    uint64_t numVisits = 0;
+    uint64_t numComparisons = 0;
+    for (int start = 0; start <= transaction->numItems - (int) k; start++) {
+        numComparisons++;
+        uint32_t node = items[start] < trie->numRootItems ? trie->rootChild[items[start]] : UINT32_MAX;
+        if (node == UINT32_MAX) {
+            continue;
+        }
+        numVisits++;
+        if (k == 1) {
+            uint32_t id = trie->leafIds[node - trie->firstLeaf];
+            supports[id]++;
+            numMatches++;
+            if (found != NULL) {
+                found(context, id);
+            }
+            continue;
+        }
+        size_t d = 1;
+        stack[1].child = trie->firstChild[node];
+        stack[1].end = trie->firstChild[node + 1];
+        stack[1].position = start + 1;
+        while (d > 0) {
+            struct TrieFrame *frame = &stack[d];
+            // The item matched at depth d has to leave room for the k - d - 1 items of the candidate after it.
+            int last = transaction->numItems - (int) (k - d);
+            uint32_t child = frame->child;
+            int position = frame->position;
+            while (child < frame->end && position <= last && trie->items[child] != items[position]) {
+                numComparisons++;
+                if (trie->items[child] > items[position]) {
+                    position++;
+                } else if (frame->end - child > TRIE_SEARCH_THRESHOLD) {
+                    child = lowerBound(trie->items, child + 1, frame->end, items[position]);
+                } else {
+                    child++;
+                }
+            }
+            if (child >= frame->end || position > last) {
+                d--;
+                continue;
+            }
+            numComparisons++;
+            numVisits++;
+            frame->child = child + 1;
+            frame->position = position + 1;
+            if (d + 1 == k) {
+                uint32_t id = trie->leafIds[child - trie->firstLeaf];
+                supports[id]++;
+                numMatches++;
+                if (found != NULL) {
+                    found(context, id);
+                }
+            } else {
+                d++;
+                stack[d].child = trie->firstChild[child];
+                stack[d].end = trie->firstChild[child + 1];
+                stack[d].position = position + 1;
+            }
+        }
+    }
+    *nodeVisits += numVisits;
+    *itemComparisons += numComparisons;
+    return numMatches;
+}
+
+/**
+ * Gets the support of a candidate of a trie, following its items down from the root.
+ * @param trie - The trie.
+ * @param items - The k items of the itemset, in increasing order.
+ * @return The support of the candidate, or 0 if the trie does not hold the itemset.
+ */
+uint32_t getTrieSupport(const struct CandidateTrie *trie, const uint32_t *items) {
+    uint32_t node = 0;
+    for (size_t d = 0; d < trie->k; d++) {
+        uint32_t end = trie->firstChild[node + 1];
+        uint32_t child = lowerBound(trie->items, trie->firstChild[node], end, items[d]);
+        if (child == end || trie->items[child] != items[d]) {
+            return 0;
+        }
+        node = child;
+    }
+    return trie->leaves[node - trie->firstLeaf]->support;
+}
@@ -0,0 +1,46 @@
+//
+// A prefix trie of candidate itemsets (Bodon, 2003), stored as sorted contiguous arrays of children and walked
+// without recursion; an alternative to the hash tree.
+//
+
+#ifndef APRIORI_TRIE_H
+#define APRIORI_TRIE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "apriori.h"
+#include "arena.h"
+
+// Represents the candidate itemsets of one size in a prefix trie. The nodes are numbered breadth first, so the
+// children of every node, sorted by their item, are contiguous, and the leaves, at depth k, come last in the
+// lexicographic order of their candidates. The children of the root, which has the most, are also indexed by item.
+struct CandidateTrie {
+    size_t k;                // The size of the candidates.
+    size_t numNodes;         // The number of nodes, the root and the leaves included.
+    size_t numLeaves;
+    size_t firstLeaf;        // The number of the first leaf.
+    uint32_t *items;         // The last item of the prefix of each node.
+    uint32_t *firstChild;    // The children of node n are firstChild[n] to firstChild[n + 1] - 1.
+    uint32_t *rootChild;     // The child of the root for each item up to numRootItems, or UINT32_MAX if it has none.
+    size_t numRootItems;     // The largest first item of the candidates plus one.
+    struct Itemset **leaves; // The candidate of each leaf.
+    uint32_t *leafIds;       // The id of the candidate of each leaf.
+};
+
+// Represents a node of the walk of a trie whose children are still being matched against a transaction.
+struct TrieFrame {
+    uint32_t child;    // The next child to match.
+    uint32_t end;      // The end of the children.
+    int position;      // The next item of the transaction to match.
+};
+
+// Receives the id of a candidate contained in the transaction being counted.
+typedef void (*TrieMatchCallback)(void *context, uint32_t id);
+
+struct CandidateTrie *createCandidateTrie(struct Itemset **candidates, size_t numCandidates, size_t k,
+                                          struct Arena *arena);
+uint32_t countTrie(const struct CandidateTrie *trie, const struct Transaction *transaction, struct TrieFrame *stack,
+                   uint32_t *supports, uint64_t *nodeVisits, uint64_t *itemComparisons, TrieMatchCallback found,
+                   void *context);
+uint32_t getTrieSupport(const struct CandidateTrie *trie, const uint32_t *items);
+#endif //APRIORI_TRIE_H
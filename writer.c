@@ -0,0 +1,412 @@
+//
+// Writes the results of a run through a large buffer flushed with write(), formatting the integers and the fixed point
+// numbers by hand instead of with printf. The text format is the one printf wrote before, byte for byte.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "libapriori.h"
+#include "writer.h"
+
+// The number of bytes buffered before they are written out.
+#define WRITER_BUFFER_SIZE ((size_t) 1 << 20)
+
+// The number of decimals of the supports and confidences in the CSV and TSV formats.
+#define TABLE_DECIMALS 6
+
+// The number of decimals of the margins of error of the supports of approximate runs in the text format.
+#define MARGIN_DECIMALS 4
+
+// The first bytes of a binary result file.
+static const char RESULT_MAGIC[8] = {'A', 'P', 'R', 'I', 'O', 'R', 'I', 'R'};
+
+// The version of the binary result format.
+#define RESULT_VERSION 1
+
+// Written in the header to detect files saved on a machine of the other byte order.
+#define RESULT_BYTE_ORDER 0x01020304u
+
+// The header of a binary result file.
+struct ResultHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t numTransactions;
+};
+
+// A record of a binary result file, followed by the items of the antecedent and then of the consequence. An itemset
+// is written as a rule without consequence and a confidence of 0.
+struct ResultRecord {
+    uint32_t antecedentSize;
+    uint32_t consequenceSize;
+    uint32_t support;
+    float confidence;
+};
+
+// Represents the file the results are written to.
+struct ResultWriter {
+    const char *fileName; // The name of the file, or NULL for the standard output.
+    int fd;
+    enum OutputFormat format;
+    const struct AprioriResult *result;
+    size_t numTransactions;
+    bool approximate;     // true to follow the supports with their margins of error.
+    char *buffer;
+    size_t length;
+    size_t capacity;
+    bool failed;          // true once a write has failed; the rest of the results are dropped.
+};
+
+// The largest number of bytes a number of the results takes, separators included.
+#define MAX_NUMBER_LENGTH 32
+
+// The powers of ten the fixed point numbers are scaled by.
+static const double POWERS_OF_TEN[] = {1, 10, 100, 1e3, 1e4, 1e5, 1e6};
+
+/**
+ * Writes out the buffered bytes.
+ * @param writer - The writer.
+ */
+static void flushWriter(struct ResultWriter *writer) {
+    size_t written = 0;
+    while (written < writer->length && !writer->failed) {
+        ssize_t n = write(writer->fd, writer->buffer + written, writer->length - written);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            writer->failed = true;
+        } else {
+            written += (size_t) n;
+        }
+    }
+    writer->length = 0;
+}
+
+/**
+ * Makes room in the buffer, writing it out if needed.
+ * @param writer - The writer.
+ * @param size - The number of bytes about to be appended.
+ * @return The position to append them at.
+ */
+static char *reserve(struct ResultWriter *writer, size_t size) {
+    if (writer->length + size > writer->capacity) {
+        flushWriter(writer);
+        if (size > writer->capacity) {
+            writer->capacity = size;
+            writer->buffer = realloc(writer->buffer, writer->capacity);
+        }
+    }
+    return writer->buffer + writer->length;
+}
+
+/**
+ * Appends bytes to the buffer.
+ * @param writer - The writer.
+ * @param data - The bytes.
+ * @param size - The number of bytes.
+ */
+static void appendBytes(struct ResultWriter *writer, const void *data, size_t size) {
+    memcpy(reserve(writer, size), data, size);
+    writer->length += size;
+}
+
+/**
+ * Formats the decimal digits of a number.
+ * @param out - The position to write the digits at.
+ * @param value - The number.
+ * @param minDigits - The number of digits to write at least, padding with zeros on the left.
+ * @return The position after the digits.
+ */
+static char *formatUnsigned(char *out, uint64_t value, int minDigits) {
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = (char) ('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (n < minDigits) {
+        digits[n++] = '0';
+    }
+    for (int i = 0; i < n; i++) {
+        out[i] = digits[n - 1 - i];
+    }
+    return out + n;
+}
+
+/**
+ * Formats a number with a fixed number of decimals, as printf("%.*f") would.
+ * @param out - The position to write the number at, with room for MAX_NUMBER_LENGTH bytes.
+ * @param value - The number.
+ * @param decimals - The number of decimals, at most 6.
+ * @return The position after the number.
+ */
+static char *formatFixed(char *out, double value, int decimals) {
+    double scaled = value * POWERS_OF_TEN[decimals];
+    uint64_t whole = 0;
+    double fraction = 0.5;
+    if (value >= 0 && scaled < 1e15) {
+        whole = (uint64_t) scaled;
+        fraction = scaled - (double) whole;
+    }
+    // printf rounds the exact value of the number, which the scaled value is only close to: leave it the cases that
+    // are too close to a tie to tell, along with the numbers out of range.
+    if (fraction > 0.5 - 1e-6 && fraction < 0.5 + 1e-6) {
+        int length = snprintf(out, MAX_NUMBER_LENGTH, "%.*f", decimals, value);
+        return out + (length > 0 && length < MAX_NUMBER_LENGTH ? length : 0);
+    }
+    if (fraction > 0.5) {
+        whole++;
+    }
+    uint64_t unit = (uint64_t) POWERS_OF_TEN[decimals];
+    out = formatUnsigned(out, whole / unit, 1);
+    if (decimals > 0) {
+        *out++ = '.';
+        out = formatUnsigned(out, whole % unit, decimals);
+    }
+    return out;
+}
+
+/**
+ * Formats items.
+ * @param out - The position to write the items at, with room for MAX_NUMBER_LENGTH bytes per item.
+ * @param items - The item numbers.
+ * @param size - The number of items.
+ * @param separator - The text written between two items, of one or two characters.
+ * @return The position after the items.
+ */
+static char *formatItems(char *out, const uint32_t *items, size_t size, const char *separator) {
+    for (size_t i = 0; i < size; i++) {
+        if (i > 0) {
+            *out++ = separator[0];
+            if (separator[1] != '\0') {
+                *out++ = separator[1];
+            }
+        }
+        out = formatUnsigned(out, items[i], 1);
+    }
+    return out;
+}
+
+/**
+ * Formats the margin of error of a support, if the run is approximate.
+ * @param writer - The writer.
+ * @param out - The position to write the margin at, with room for MAX_NUMBER_LENGTH bytes.
+ * @param support - The support count.
+ * @param prefix - The text written before the margin.
+ * @param decimals - The number of decimals of the margin.
+ * @return The position after the margin.
+ */
+static char *formatMargin(const struct ResultWriter *writer, char *out, uint32_t support, const char *prefix,
+                          int decimals) {
+    if (!writer->approximate) {
+        return out;
+    }
+    size_t length = strlen(prefix);
+    memcpy(out, prefix, length);
+    return formatFixed(out + length, aprioriSupportMargin(writer->result, support), decimals);
+}
+
+/**
+ * Opens the file to write the results of a run to, and writes the header of the format, if any.
+ * @param fileName - The file to create, or NULL to write to the standard output.
+ * @param format - The format of the results.
+ * @param result - The result of the run, to turn the support counts into fractions. The supports of an approximate
+ *                 run are followed by their margins of error, except in the binary format.
+ * @return The writer, or NULL if the file could not be created (an error message has been printed).
+ */
+struct ResultWriter *openResultWriter(const char *fileName, enum OutputFormat format,
+                                      const struct AprioriResult *result) {
+    int fd = STDOUT_FILENO;
+    if (fileName != NULL) {
+        fd = open(fileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            printf("File '%s' could not be created.", fileName);
+            return NULL;
+        }
+    } else {
+        // Keep what was printed before in order.
+        fflush(stdout);
+    }
+    struct ResultWriter *writer = calloc(1, sizeof(struct ResultWriter));
+    writer->fileName = fileName;
+    writer->fd = fd;
+    writer->format = format;
+    writer->result = result;
+    writer->numTransactions = aprioriNumTransactions(result);
+    writer->approximate = aprioriSampledFrom(result) > 0;
+    writer->capacity = WRITER_BUFFER_SIZE;
+    writer->buffer = malloc(writer->capacity);
+
+    if (format == OUTPUT_CSV) {
+        static const char header[] = "kind,items,consequence,count,support,confidence\n";
+        static const char approximateHeader[] = "kind,items,consequence,count,support,confidence,margin\n";
+        if (writer->approximate) {
+            appendBytes(writer, approximateHeader, sizeof(approximateHeader) - 1);
+        } else {
+            appendBytes(writer, header, sizeof(header) - 1);
+        }
+    } else if (format == OUTPUT_TSV) {
+        static const char header[] = "kind\titems\tconsequence\tcount\tsupport\tconfidence\n";
+        static const char approximateHeader[] = "kind\titems\tconsequence\tcount\tsupport\tconfidence\tmargin\n";
+        if (writer->approximate) {
+            appendBytes(writer, approximateHeader, sizeof(approximateHeader) - 1);
+        } else {
+            appendBytes(writer, header, sizeof(header) - 1);
+        }
+    } else if (format == OUTPUT_BINARY) {
+        struct ResultHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, RESULT_MAGIC, sizeof(RESULT_MAGIC));
+        header.version = RESULT_VERSION;
+        header.byteOrder = RESULT_BYTE_ORDER;
+        header.numTransactions = writer->numTransactions;
+        appendBytes(writer, &header, sizeof(header));
+    }
+    return writer;
+}
+
+/**
+ * Appends a record of the CSV or TSV format to the buffer.
+ * @param writer - The writer.
+ * @param items - The items of the itemset, or of the antecedent of the rule.
+ * @param size - The number of items.
+ * @param consequence - The items of the consequence of the rule, or NULL for an itemset.
+ * @param consequenceSize - The number of items in the consequence.
+ * @param support - The support count of the itemset or rule.
+ * @param confidence - The confidence of the rule.
+ */
+static void appendTableRecord(struct ResultWriter *writer, const uint32_t *items, size_t size,
+                              const uint32_t *consequence, size_t consequenceSize, uint32_t support,
+                              double confidence) {
+    char separator = writer->format == OUTPUT_CSV ? ',' : '\t';
+    char *start = reserve(writer, (size + consequenceSize + 9) * MAX_NUMBER_LENGTH);
+    char *out = start;
+    if (consequence == NULL) {
+        memcpy(out, "itemset", 7);
+        out += 7;
+    } else {
+        memcpy(out, "rule", 4);
+        out += 4;
+    }
+    *out++ = separator;
+    out = formatItems(out, items, size, " ");
+    *out++ = separator;
+    out = formatItems(out, consequence, consequenceSize, " ");
+    *out++ = separator;
+    out = formatUnsigned(out, support, 1);
+    *out++ = separator;
+    out = formatFixed(out, (double) support / (double) writer->numTransactions, TABLE_DECIMALS);
+    *out++ = separator;
+    if (consequence != NULL) {
+        out = formatFixed(out, confidence, TABLE_DECIMALS);
+    }
+    char marginSeparator[2] = {separator, '\0'};
+    out = formatMargin(writer, out, support, marginSeparator, TABLE_DECIMALS);
+    *out++ = '\n';
+    writer->length += (size_t) (out - start);
+}
+
+/**
+ * Appends a record of the binary format to the buffer.
+ * @param writer - The writer.
+ * @param items - The items of the itemset, or of the antecedent of the rule.
+ * @param size - The number of items.
+ * @param consequence - The items of the consequence of the rule.
+ * @param consequenceSize - The number of items in the consequence, 0 for an itemset.
+ * @param support - The support count of the itemset or rule.
+ * @param confidence - The confidence of the rule, 0 for an itemset.
+ */
+static void appendBinaryRecord(struct ResultWriter *writer, const uint32_t *items, size_t size,
+                               const uint32_t *consequence, size_t consequenceSize, uint32_t support,
+                               double confidence) {
+    struct ResultRecord record = {(uint32_t) size, (uint32_t) consequenceSize, support, (float) confidence};
+    appendBytes(writer, &record, sizeof(record));
+    appendBytes(writer, items, size * sizeof(uint32_t));
+    if (consequenceSize > 0) {
+        appendBytes(writer, consequence, consequenceSize * sizeof(uint32_t));
+    }
+}
+
+/**
+ * Writes a frequent itemset; an AprioriItemsetCallback.
+ * @param items - The item numbers of the itemset.
+ * @param size - The number of items.
+ * @param support - The support count of the itemset.
+ * @param context - The ResultWriter.
+ */
+void writeItemset(const uint32_t *items, size_t size, uint32_t support, void *context) {
+    struct ResultWriter *writer = context;
+    if (writer->format == OUTPUT_TEXT) {
+        char *start = reserve(writer, (size + 3) * MAX_NUMBER_LENGTH);
+        char *out = formatItems(start, items, size, " ");
+        memcpy(out, " (", 2);
+        out = formatFixed(out + 2, (double) support / (double) writer->numTransactions, 2);
+        out = formatMargin(writer, out, support, " +-", MARGIN_DECIMALS);
+        memcpy(out, ")\n", 2);
+        writer->length += (size_t) (out + 2 - start);
+    } else if (writer->format == OUTPUT_BINARY) {
+        appendBinaryRecord(writer, items, size, NULL, 0, support, 0);
+    } else {
+        appendTableRecord(writer, items, size, NULL, 0, support, 0);
+    }
+}
+
+/**
+ * Writes a strong association rule; an AprioriRuleCallback.
+ * @param antecedent - The item numbers of the antecedent.
+ * @param antecedentSize - The number of items in the antecedent.
+ * @param consequence - The item numbers of the consequence.
+ * @param consequenceSize - The number of items in the consequence.
+ * @param support - The support count of the itemset the rule was generated from.
+ * @param confidence - The confidence of the rule.
+ * @param context - The ResultWriter.
+ */
+void writeRule(const uint32_t *antecedent, size_t antecedentSize, const uint32_t *consequence, size_t consequenceSize,
+               uint32_t support, double confidence, void *context) {
+    struct ResultWriter *writer = context;
+    if (writer->format == OUTPUT_TEXT) {
+        char *start = reserve(writer, (antecedentSize + consequenceSize + 5) * MAX_NUMBER_LENGTH);
+        char *out = formatItems(start, antecedent, antecedentSize, ", ");
+        memcpy(out, " -> ", 4);
+        out = formatItems(out + 4, consequence, consequenceSize, ", ");
+        memcpy(out, " (", 2);
+        out = formatFixed(out + 2, (double) support / (double) writer->numTransactions, 2);
+        out = formatMargin(writer, out, support, " +-", MARGIN_DECIMALS);
+        *out++ = ',';
+        out = formatFixed(out, confidence, 2);
+        memcpy(out, ")\n", 2);
+        writer->length += (size_t) (out + 2 - start);
+    } else if (writer->format == OUTPUT_BINARY) {
+        appendBinaryRecord(writer, antecedent, antecedentSize, consequence, consequenceSize, support, confidence);
+    } else {
+        appendTableRecord(writer, antecedent, antecedentSize, consequence, consequenceSize, support, confidence);
+    }
+}
+
+/**
+ * Writes out the rest of the results and closes the file.
+ * @param writer - The writer, which is freed.
+ * @return true if all the results were written, false otherwise (an error message has been printed).
+ */
+bool closeResultWriter(struct ResultWriter *writer) {
+    flushWriter(writer);
+    bool written = !writer->failed;
+    if (writer->fileName != NULL && close(writer->fd) != 0) {
+        written = false;
+    }
+    if (!written) {
+        if (writer->fileName != NULL) {
+            printf("File '%s' could not be written.", writer->fileName);
+        } else {
+            printf("The results could not be written.");
+        }
+    }
+    free(writer->buffer);
+    free(writer);
+    return written;
+}
@@ -0,0 +1,29 @@
+//
+// Writes the frequent itemsets and the strong rules of a run through a large buffer, in text, CSV, TSV or binary.
+//
+
+#ifndef APRIORI_WRITER_H
+#define APRIORI_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// The formats the results can be written in.
+enum OutputFormat {
+    OUTPUT_TEXT,  // One itemset or rule per line, with its support and confidence to two decimals.
+    OUTPUT_CSV,   // One record per line under a header, the items of a side separated by spaces.
+    OUTPUT_TSV,   // As OUTPUT_CSV, with tabs between the fields.
+    OUTPUT_BINARY // A header followed by fixed records, each followed by its items.
+};
+
+struct ResultWriter;
+struct AprioriResult;
+
+struct ResultWriter *openResultWriter(const char *fileName, enum OutputFormat format,
+                                      const struct AprioriResult *result);
+void writeItemset(const uint32_t *items, size_t size, uint32_t support, void *context);
+void writeRule(const uint32_t *antecedent, size_t antecedentSize, const uint32_t *consequence, size_t consequenceSize,
+               uint32_t support, double confidence, void *context);
+bool closeResultWriter(struct ResultWriter *writer);
+#endif //APRIORI_WRITER_H